@@ -229,7 +229,7 @@ rct_window *window_loadsave_open(sint32 type, const char *defaultName)
         w->widgets[WIDX_TITLE].text = isSave ? STR_FILE_DIALOG_TITLE_SAVE_GAME : STR_FILE_DIALOG_TITLE_LOAD_GAME;
         if (window_loadsave_get_dir(gConfigGeneral.last_save_game_directory, path, "save", sizeof(path)))
         {
-            window_loadsave_populate_list(w, isSave, path, isSave ? ".sv6" : ".sv6;.sc6;.sv4;.sc4");
+            window_loadsave_populate_list(w, isSave, path, isSave ? ".sv6" : ".park;.sv6;.sc6;.sv4;.sc4");
             success = true;
         }
         break;
@@ -325,7 +325,7 @@ static bool browse(bool isSave, char *path, size_t pathSize)
     case LOADSAVETYPE_GAME:
         title = isSave ? STR_FILE_DIALOG_TITLE_SAVE_GAME : STR_FILE_DIALOG_TITLE_LOAD_GAME;
         desc.filters[0].name = language_get_string(STR_OPENRCT2_SAVED_GAME);
-        desc.filters[0].pattern = isSave ? "*.sv6" : "*.sv6;*.sc6;*.sv4;*.sc4";
+        desc.filters[0].pattern = isSave ? "*.sv6" : "*.park;*.sv6;*.sc6;*.sv4;*.sc4";
         break;
 
     case LOADSAVETYPE_LANDSCAPE:
@@ -1132,7 +1132,7 @@ static bool save_filename_exists(const utf8 * filename)
 static void window_title_editor_add_park_callback(sint32 result, const utf8 * path)
 {
     uint32 extension = get_file_extension_type(path);
-    if (extension != FILE_EXTENSION_SV4 && extension != FILE_EXTENSION_SV6)
+    if (extension != FILE_EXTENSION_SV4 && extension != FILE_EXTENSION_SV6 && extension != FILE_EXTENSION_PARK)
         return;
 
     const utf8 * filename = path_get_filename(path);
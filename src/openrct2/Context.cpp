@@ -617,7 +617,18 @@ namespace OpenRCT2
                 {
                     gNetworkStartPort = gConfigNetwork.default_port;
                 }
-                network_begin_client(gNetworkStartHost, gNetworkStartPort);
+                if (gNetworkStartRelay)
+                {
+                    if (String::IsNullOrEmpty(gNetworkStartAddress))
+                    {
+                        gNetworkStartAddress = gConfigNetwork.listen_address;
+                    }
+                    network_begin_relay(gNetworkStartHost, gNetworkStartPort, gNetworkStartRelayPort, gNetworkStartAddress);
+                }
+                else
+                {
+                    network_begin_client(gNetworkStartHost, gNetworkStartPort);
+                }
             }
 #endif // DISABLE_NETWORK
 
@@ -701,8 +712,22 @@ namespace OpenRCT2
 
             _accumulator -= GAME_UPDATE_TIME_MS;
 
+            // Clients are paced against the server, so their ticks do not fall on every frame
+            bool draw = !_isWindowMinimised && !gOpenRCT2Headless;
+            bool tween = draw && network_get_mode() == NETWORK_MODE_CLIENT;
+            SetTweenSprites(tween);
+
             Update();
-            if (!_isWindowMinimised && !gOpenRCT2Headless)
+            if (tween)
+            {
+                const float alpha = game_get_tween_alpha((float)_accumulator / GAME_UPDATE_TIME_MS);
+                sprite_position_tween_all(alpha);
+
+                drawing_engine_draw();
+
+                sprite_position_tween_restore();
+            }
+            else if (draw)
             {
                 drawing_engine_draw();
             }
@@ -716,7 +741,6 @@ namespace OpenRCT2
 
             if (_lastTick == 0)
             {
-                sprite_position_tween_reset();
                 _lastTick = currentTick;
             }
 
@@ -727,24 +751,17 @@ namespace OpenRCT2
 
             _uiContext->ProcessMessages();
 
+            SetTweenSprites(draw);
             while (_accumulator >= GAME_UPDATE_TIME_MS)
             {
-                // Get the original position of each sprite
-                if(draw)
-                    sprite_position_tween_store_a();
-
                 Update();
 
                 _accumulator -= GAME_UPDATE_TIME_MS;
-
-                // Get the next position of each sprite
-                if(draw)
-                    sprite_position_tween_store_b();
             }
 
             if (draw)
             {
-                const float alpha = (float)_accumulator / GAME_UPDATE_TIME_MS;
+                const float alpha = game_get_tween_alpha((float)_accumulator / GAME_UPDATE_TIME_MS);
                 sprite_position_tween_all(alpha);
 
                 drawing_engine_draw();
@@ -753,6 +770,19 @@ namespace OpenRCT2
             }
         }
 
+        /**
+         * Starts or stops keeping the sprite positions around each tick. Positions kept before tweening
+         * was stopped are stale, so they are reset when it starts again.
+         */
+        void SetTweenSprites(bool tween)
+        {
+            if (tween && !gTweenSprites)
+            {
+                sprite_position_tween_reset();
+            }
+            gTweenSprites = tween;
+        }
+
         void Update()
         {
             uint32 currentUpdateTick = platform_get_ticks();
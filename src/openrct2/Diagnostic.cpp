@@ -16,6 +16,7 @@
 
 #include <cstdarg>
 #include <cstdio>
+#include <mutex>
 #include <sstream>
 #include "Diagnostic.h"
 
@@ -74,6 +75,9 @@ void diagnostic_log_with_location(DIAGNOSTIC_LEVEL diagnosticLevel, const char *
 
 #else
 
+// Keeps the parts of a message from different threads from interleaving
+static std::mutex _logMutex;
+
 #ifdef __WIIU__
 
 const char * _level_strings[5] = {
@@ -101,6 +105,7 @@ void diagnostic_log(DIAGNOSTIC_LEVEL diagnosticLevel, const char *format, ...)
     if (!_log_levels[diagnosticLevel])
         return;
 
+    std::lock_guard<std::mutex> lock(_logMutex);
     FILE * stream = diagnostic_get_stream(diagnosticLevel);
 
     // Level
@@ -124,6 +129,7 @@ void diagnostic_log_with_location(DIAGNOSTIC_LEVEL diagnosticLevel, const char *
     if (!_log_levels[diagnosticLevel])
         return;
 
+    std::lock_guard<std::mutex> lock(_logMutex);
     FILE * stream = diagnostic_get_stream(diagnosticLevel);
 
     // Level and source code information
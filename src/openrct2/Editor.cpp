@@ -195,6 +195,7 @@ namespace Editor
         {
         case FILE_EXTENSION_SC6:
         case FILE_EXTENSION_SV6:
+        case FILE_EXTENSION_PARK:
             return ReadS6(path);
         case FILE_EXTENSION_SC4:
             return LoadLandscapeFromSC4(path);
@@ -249,7 +250,7 @@ namespace Editor
         {
             loadResult = load_from_sc6(path);
         }
-        else if (_stricmp(extension, ".sv6") == 0)
+        else if (_stricmp(extension, ".sv6") == 0 || _stricmp(extension, ".park") == 0)
         {
             loadResult = load_from_sv6(path);
         }
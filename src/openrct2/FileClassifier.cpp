@@ -18,11 +18,13 @@
 #include "core/FileStream.hpp"
 #include "core/Path.hpp"
 #include "FileClassifier.h"
+#include "ParkFile.h"
 #include "rct12/SawyerChunkReader.h"
 
 #include "scenario/Scenario.h"
 #include "util/SawyerCoding.h"
 
+static bool TryClassifyAsParkFile(IStream * stream, ClassifiedFileInfo * result);
 static bool TryClassifyAsS6(IStream * stream, ClassifiedFileInfo * result);
 static bool TryClassifyAsS4(IStream * stream, ClassifiedFileInfo * result);
 static bool TryClassifyAsTD4_TD6(IStream * stream, ClassifiedFileInfo * result);
@@ -47,6 +49,12 @@ bool TryClassifyFile(IStream * stream, ClassifiedFileInfo * result)
     //      between them is to decode it. Decoding however is currently not protected
     //      against invalid compression data for that decoding algorithm and will crash.
 
+    // Native park container detection
+    if (TryClassifyAsParkFile(stream, result))
+    {
+        return true;
+    }
+
     // S6 detection
     if (TryClassifyAsS6(stream, result))
     {
@@ -68,6 +76,39 @@ bool TryClassifyFile(IStream * stream, ClassifiedFileInfo * result)
     return false;
 }
 
+static bool TryClassifyAsParkFile(IStream * stream, ClassifiedFileInfo * result)
+{
+    if (!ParkFile::IsParkFile(stream))
+    {
+        return false;
+    }
+
+    bool success = false;
+    uint64 originalPosition = stream->GetPosition();
+    try
+    {
+        auto reader = ParkFileReader(stream);
+        rct_s6_header s6Header;
+        reader.ReadSection(PARK_FILE_SECTION_HEADER, &s6Header, sizeof(s6Header));
+        if (s6Header.type == S6_TYPE_SAVEDGAME)
+        {
+            result->Type = FILE_TYPE::SAVED_GAME;
+        }
+        else if (s6Header.type == S6_TYPE_SCENARIO)
+        {
+            result->Type = FILE_TYPE::SCENARIO;
+        }
+        result->Version = s6Header.version;
+        success = true;
+    }
+    catch (const std::exception &e)
+    {
+        log_verbose(e.what());
+    }
+    stream->SetPosition(originalPosition);
+    return success;
+}
+
 static bool TryClassifyAsS6(IStream * stream, ClassifiedFileInfo * result)
 {
     bool success = false;
@@ -178,6 +219,7 @@ uint32 get_file_extension_type(const utf8 * path)
     if (String::Equals(extension, ".sc6", true)) return FILE_EXTENSION_SC6;
     if (String::Equals(extension, ".sv6", true)) return FILE_EXTENSION_SV6;
     if (String::Equals(extension, ".td6", true)) return FILE_EXTENSION_TD6;
+    if (String::Equals(extension, ".park", true)) return FILE_EXTENSION_PARK;
     return FILE_EXTENSION_UNKNOWN;
 }
 
@@ -28,6 +28,7 @@ enum
     FILE_EXTENSION_SC6,
     FILE_EXTENSION_SV6,
     FILE_EXTENSION_TD6,
+    FILE_EXTENSION_PARK,
 };
 
 #include <string>
@@ -14,6 +14,7 @@
  *****************************************************************************/
 #pragma endregion
 
+#include <chrono>
 #include <memory>
 #include "audio/audio.h"
 #include "Cheats.h"
@@ -43,6 +44,7 @@
 #include "peep/Staff.h"
 #include "platform/platform.h"
 #include "rct1/RCT1.h"
+#include "Replay.h"
 #include "ride/Ride.h"
 #include "ride/RideRatings.h"
 #include "ride/Station.h"
@@ -70,6 +72,11 @@
 
 #define NUMBER_OF_AUTOSAVES_TO_KEEP 9
 
+// Number of ticks a client tries to stay behind the server so a late tick packet does not stall it
+#define NETWORK_CLIENT_TICK_BUFFER 3
+// Fastest a client may run the simulation relative to real time while catching up
+#define NETWORK_CLIENT_MAX_CATCHUP_RATE 8.0f
+
 uint16 gTicksSinceLastUpdate;
 uint8  gGamePaused    = 0;
 sint32 gGameSpeed     = 1;
@@ -82,11 +89,20 @@ char   gCurrentLoadedPath[MAX_PATH];
 
 bool gLoadKeepWindowsOpen = false;
 
+bool   gGameLogicProfiling = false;
+double gGameLogicTimings[GAME_LOGIC_SUBSYSTEM_COUNT];
+static std::chrono::high_resolution_clock::time_point _gameLogicSplitTime;
+
 uint8 gUnk13CA740;
 uint8 gUnk141F568;
 
 uint32 gCurrentTicks;
 
+bool gTweenSprites = false;
+
+static float _clientTickBalance = 0;
+static float _clientTickRate = 1;
+
 GAME_COMMAND_CALLBACK_POINTER * game_command_callback = nullptr;
 static GAME_COMMAND_CALLBACK_POINTER * const game_command_callback_table[] = {
     nullptr,
@@ -328,6 +344,52 @@ void update_palette_effects()
     }
 }
 
+/**
+ * Paces a network client so it stays a few ticks behind the server. Rather than stalling until the
+ * next tick packet arrives and then bursting, the client runs slightly slower while inside the
+ * buffer and gradually faster the further it falls behind.
+ */
+static uint32 game_get_client_update_count(uint32 numUpdates)
+{
+    sint32 lag = (sint32)(network_get_server_tick() - gCurrentTicks);
+    float rate;
+    if (lag < NETWORK_CLIENT_TICK_BUFFER)
+    {
+        // Gently rebuild the buffer, a full stall is far more noticeable
+        rate = 1.0f - (NETWORK_CLIENT_TICK_BUFFER - lag) / 32.0f;
+    }
+    else
+    {
+        rate = 1.0f + (lag - NETWORK_CLIENT_TICK_BUFFER) / 8.0f;
+        rate = std::min(rate, NETWORK_CLIENT_MAX_CATCHUP_RATE);
+    }
+
+    _clientTickRate = rate;
+    _clientTickBalance += numUpdates * rate;
+    numUpdates = (uint32)_clientTickBalance;
+    _clientTickBalance -= numUpdates;
+    if (numUpdates == 0 && game_is_not_paused())
+    {
+        // No tick this frame, but keep receiving from the server
+        network_update();
+    }
+    return numUpdates;
+}
+
+float game_get_tween_alpha(float frameProgress)
+{
+    if (game_is_paused())
+    {
+        return 1.0f;
+    }
+    if (network_get_mode() == NETWORK_MODE_CLIENT && network_get_status() == NETWORK_STATUS_CONNECTED && network_get_authstatus() == NETWORK_AUTH_OK)
+    {
+        // Paced ticks rarely line up with updates, so go by how far the client is towards its next tick
+        return std::min(1.0f, _clientTickBalance + frameProgress * _clientTickRate);
+    }
+    return frameProgress;
+}
+
 void game_update()
 {
     gInUpdateCode = true;
@@ -356,11 +418,12 @@ void game_update()
 
     if (network_get_mode() == NETWORK_MODE_CLIENT && network_get_status() == NETWORK_STATUS_CONNECTED && network_get_authstatus() == NETWORK_AUTH_OK)
     {
-        if (network_get_server_tick() - gCurrentTicks >= 10)
-        {
-            // Make sure client doesn't fall behind the server too much
-            numUpdates += 10;
-        }
+        numUpdates = game_get_client_update_count(numUpdates);
+    }
+    else
+    {
+        _clientTickBalance = 0;
+        _clientTickRate = 1;
     }
 
     if (game_is_paused())
@@ -374,12 +437,18 @@ void game_update()
         network_update();
 
         network_process_game_commands();
+        replay_process_commands();
     }
 
     // Update the game one or more times
     for (uint32 i = 0; i < numUpdates; i++)
     {
+        uint32 ticks = gCurrentTicks;
         game_logic_update();
+        if (gTweenSprites && gCurrentTicks != ticks)
+        {
+            sprite_position_tween_advance();
+        }
 
         if (gGameSpeed > 1)
             continue;
@@ -445,8 +514,38 @@ void game_update()
     gInUpdateCode         = false;
 }
 
+static void game_logic_profile_split(sint32 subsystem)
+{
+    if (gGameLogicProfiling)
+    {
+        auto now = std::chrono::high_resolution_clock::now();
+        gGameLogicTimings[subsystem] += std::chrono::duration<double>(now - _gameLogicSplitTime).count();
+        _gameLogicSplitTime = now;
+    }
+}
+
+const char * game_logic_get_subsystem_name(sint32 subsystem)
+{
+    switch (subsystem)
+    {
+    case GAME_LOGIC_SUBSYSTEM_SCENARIO: return "scenario";
+    case GAME_LOGIC_SUBSYSTEM_MAP:      return "map";
+    case GAME_LOGIC_SUBSYSTEM_PEEPS:    return "peeps";
+    case GAME_LOGIC_SUBSYSTEM_VEHICLES: return "vehicles";
+    case GAME_LOGIC_SUBSYSTEM_SPRITES:  return "sprites";
+    case GAME_LOGIC_SUBSYSTEM_RIDES:    return "rides";
+    case GAME_LOGIC_SUBSYSTEM_COMMANDS: return "commands";
+    default:                            return "other";
+    }
+}
+
 void game_logic_update()
 {
+    if (gGameLogicProfiling)
+    {
+        _gameLogicSplitTime = std::chrono::high_resolution_clock::now();
+    }
+
     gScreenAge++;
     if (gScreenAge == 0)
         gScreenAge--;
@@ -474,25 +573,48 @@ void game_logic_update()
         network_check_desynchronization();
     }
 
+    game_logic_profile_split(GAME_LOGIC_SUBSYSTEM_OTHER);
+    replay_update_begin();
+    game_logic_profile_split(GAME_LOGIC_SUBSYSTEM_COMMANDS);
+
+    // Viewports do not move while the simulation runs, so invalidations can be filtered against them
+    viewport_invalidation_begin_batch();
     sub_68B089();
+    game_logic_profile_split(GAME_LOGIC_SUBSYSTEM_SPRITES);
     scenario_update();
     climate_update();
+    game_logic_profile_split(GAME_LOGIC_SUBSYSTEM_SCENARIO);
     map_update_tiles();
-    // Temporarily remove provisional paths to prevent peep from interacting with them
+    // Temporarily remove provisional paths to prevent peep from interacting with them. The ghost
+    // commands this runs are local to this client, so they are not part of a recording.
+    replay_suspend_recording();
     map_remove_provisional_elements();
+    replay_resume_recording();
     map_update_path_wide_flags();
+    game_logic_profile_split(GAME_LOGIC_SUBSYSTEM_MAP);
     peep_update_all();
+    game_logic_profile_split(GAME_LOGIC_SUBSYSTEM_PEEPS);
+    replay_suspend_recording();
     map_restore_provisional_elements();
+    replay_resume_recording();
+    game_logic_profile_split(GAME_LOGIC_SUBSYSTEM_MAP);
     vehicle_update_all();
+    game_logic_profile_split(GAME_LOGIC_SUBSYSTEM_VEHICLES);
     sprite_misc_update_all();
+    game_logic_profile_split(GAME_LOGIC_SUBSYSTEM_SPRITES);
     ride_update_all();
+    game_logic_profile_split(GAME_LOGIC_SUBSYSTEM_RIDES);
     park_update();
     research_update();
+    game_logic_profile_split(GAME_LOGIC_SUBSYSTEM_SCENARIO);
     ride_ratings_update_all();
     ride_measurements_update();
+    game_logic_profile_split(GAME_LOGIC_SUBSYSTEM_RIDES);
     news_item_update_current();
+    game_logic_profile_split(GAME_LOGIC_SUBSYSTEM_SCENARIO);
 
     map_animation_invalidate_all();
+    viewport_invalidation_end_batch();
     vehicle_sounds_update();
     peep_update_crowd_noise();
     climate_update_sound();
@@ -523,7 +645,10 @@ void game_logic_update()
 
     // Separated out processing commands in network_update which could call scenario_rand where gInUpdateCode is false.
     // All commands that are received are first queued and then executed where gInUpdateCode is set to true.
+    game_logic_profile_split(GAME_LOGIC_SUBSYSTEM_OTHER);
     network_process_game_commands();
+    replay_update_end();
+    game_logic_profile_split(GAME_LOGIC_SUBSYSTEM_COMMANDS);
 
     network_flush();
 
@@ -575,10 +700,12 @@ sint32 game_do_command(sint32 eax, sint32 ebx, sint32 ecx, sint32 edx, sint32 es
 sint32 game_do_command_p(uint32 command, sint32 * eax, sint32 * ebx, sint32 * ecx, sint32 * edx, sint32 * esi, sint32 * edi, sint32 * ebp)
 {
     sint32 cost, flags;
-    sint32 original_ebx, original_edx, original_esi, original_edi, original_ebp;
+    sint32 original_eax, original_ebx, original_ecx, original_edx, original_esi, original_edi, original_ebp;
 
     *esi = command;
+    original_eax = *eax;
     original_ebx = *ebx;
+    original_ecx = *ecx;
     original_edx = *edx;
     original_esi = *esi;
     original_edi = *edi;
@@ -673,9 +800,22 @@ sint32 game_do_command_p(uint32 command, sint32 * eax, sint32 * ebx, sint32 * ec
                 }
             }
 
+            // Only top level commands are recorded, replaying them runs the nested ones again
+            if (gGameCommandNestLevel == 1)
+            {
+                const sint32 args[] = { original_eax, original_ebx, original_ecx, original_edx, original_esi, original_edi, original_ebp };
+                replay_record_game_command(args, game_command_playerid);
+                replay_suspend_recording();
+            }
+
             // Second call to actually perform the operation
             new_game_command_table[command](eax, ebx, ecx, edx, esi, edi, ebp);
 
+            if (gGameCommandNestLevel == 1)
+            {
+                replay_resume_recording();
+            }
+
             // Do the callback (required for multiplayer to work correctly), but only for top level commands
             if (gGameCommandNestLevel == 1)
             {
@@ -1499,7 +1639,7 @@ static void limit_autosave_count(const size_t numberOfFilesToKeep, bool processL
     {
         platform_get_user_directory(filter, "save", sizeof(filter));
         safe_strcat_path(filter, "autosave", sizeof(filter));
-        safe_strcat_path(filter, "autosave_*.sv6", sizeof(filter));
+        safe_strcat_path(filter, "autosave_*.park;autosave_*.sv6", sizeof(filter));
     }
 
     // At first, count how many autosaves there are
@@ -1563,8 +1703,9 @@ static void limit_autosave_count(const size_t numberOfFilesToKeep, bool processL
 
 void game_autosave()
 {
+    // Autosaves use the native park container as it is much quicker to write than an SV6
     const char * subDirectory  = "save";
-    const char * fileExtension = ".sv6";
+    const char * fileExtension = ".park";
     uint32 saveFlags = 0x80000000;
     if (gScreenFlags & SCREEN_FLAGS_EDITOR)
     {
@@ -128,6 +128,19 @@ enum
     ERROR_TYPE_FILE_LOAD = 255
 };
 
+enum GAME_LOGIC_SUBSYSTEM
+{
+    GAME_LOGIC_SUBSYSTEM_SCENARIO,
+    GAME_LOGIC_SUBSYSTEM_MAP,
+    GAME_LOGIC_SUBSYSTEM_PEEPS,
+    GAME_LOGIC_SUBSYSTEM_VEHICLES,
+    GAME_LOGIC_SUBSYSTEM_SPRITES,
+    GAME_LOGIC_SUBSYSTEM_RIDES,
+    GAME_LOGIC_SUBSYSTEM_COMMANDS,
+    GAME_LOGIC_SUBSYSTEM_OTHER,
+    GAME_LOGIC_SUBSYSTEM_COUNT,
+};
+
 using GAME_COMMAND_POINTER          = void(sint32 * eax, sint32 * ebx, sint32 * ecx, sint32 * edx, sint32 * esi, sint32 * edi, sint32 * ebp);
 using GAME_COMMAND_CALLBACK_POINTER = void(sint32 eax, sint32 ebx, sint32 ecx, sint32 edx, sint32 esi, sint32 edi, sint32 ebp);
 
@@ -157,6 +170,14 @@ extern char   gCurrentLoadedPath[260];
 
 extern bool gLoadKeepWindowsOpen;
 
+// Set by the main loop while it draws sprites between ticks, game_update then keeps the sprite
+// positions before and after each tick
+extern bool gTweenSprites;
+
+// Seconds game_logic_update has spent in each subsystem, only measured while profiling is enabled
+extern bool   gGameLogicProfiling;
+extern double gGameLogicTimings[GAME_LOGIC_SUBSYSTEM_COUNT];
+
 extern uint8 gUnk13CA740;
 extern uint8 gUnk141F568;
 
@@ -165,7 +186,14 @@ void game_reduce_game_speed();
 
 void game_create_windows();
 void game_update();
+
+/**
+ * How far between their positions before and after the last tick to draw the sprites, given how far
+ * the frame is into the current update interval.
+ */
+float game_get_tween_alpha(float frameProgress);
 void game_logic_update();
+const char * game_logic_get_subsystem_name(sint32 subsystem);
 void reset_all_sprite_quadrant_placements();
 void update_palette_effects();
 
@@ -66,6 +66,8 @@ extern sint32 gNetworkStart;
 extern char gNetworkStartHost[128];
 extern sint32 gNetworkStartPort;
 extern char* gNetworkStartAddress;
+extern bool gNetworkStartRelay;
+extern sint32 gNetworkStartRelayPort;
 #endif
 
 extern uint32 gCurrentDrawCount;
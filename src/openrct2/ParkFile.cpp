@@ -0,0 +1,282 @@
+#pragma region Copyright (c) 2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+
+#include <algorithm>
+#include <atomic>
+#include "core/IStream.hpp"
+#include "core/JobPool.hpp"
+#include "ParkFile.h"
+#include "zlib.h"
+
+// Layout:
+//   magic (u32), version (u32), number of sections (u32), length of the whole file (u64)
+//   per section: id (u32), codec (u8), offset (u64), length (u64), compressed length (u64), CRC-32 (u32)
+//   section data at the offsets given, relative to the start of the file
+constexpr uint32 PARK_FILE_MAGIC_NUMBER = 0x4B524150; // PARK
+constexpr uint32 PARK_FILE_VERSION = 1;
+constexpr uint64 PARK_FILE_HEADER_SIZE = 20;
+constexpr uint64 PARK_FILE_SECTION_ENTRY_SIZE = 33;
+constexpr uint32 PARK_FILE_MAX_SECTIONS = 256;
+constexpr uint64 PARK_FILE_MAX_SECTION_LENGTH = 64 * 1024 * 1024;
+
+enum PARK_FILE_CODEC : uint8
+{
+    PARK_FILE_CODEC_NONE,
+    PARK_FILE_CODEC_DEFLATE,
+};
+
+static uint32 CalculateChecksum(const void * data, size_t length)
+{
+    return (uint32)crc32(0, (const Bytef *)data, (uInt)length);
+}
+
+static std::vector<uint8> Compress(const void * data, size_t length, sint32 level)
+{
+    uLongf compressedLength = compressBound((uLong)length);
+    std::vector<uint8> result(compressedLength);
+    if (compress2(result.data(), &compressedLength, (const Bytef *)data, (uLong)length, level) != Z_OK)
+    {
+        throw IOException("Unable to compress park section.");
+    }
+    result.resize(compressedLength);
+    return result;
+}
+
+bool ParkFile::IsParkFile(IStream * stream)
+{
+    uint64 position = stream->GetPosition();
+    if (position + sizeof(uint32) > stream->GetLength())
+    {
+        return false;
+    }
+    uint32 magic = stream->ReadValue<uint32>();
+    stream->SetPosition(position);
+    return magic == PARK_FILE_MAGIC_NUMBER;
+}
+
+void ParkFileWriter::AddSection(uint32 id, const void * data, size_t length)
+{
+    _sections.push_back({ id, data, length });
+}
+
+void ParkFileWriter::Write(IStream * stream, PARK_FILE_COMPRESSION compression) const
+{
+    // Compress every section first so that the table can be written with the final offsets. The sections are
+    // independent so they are compressed in parallel along with their checksums.
+    std::vector<std::vector<uint8>> compressedSections(_sections.size());
+    std::vector<uint32> checksums(_sections.size());
+    std::atomic_bool compressionFailed = { false };
+    sint32 level = compression == PARK_FILE_COMPRESSION::FAST ? Z_BEST_SPEED : Z_BEST_COMPRESSION;
+    {
+        JobPool jobPool(_sections.size());
+        for (size_t i = 0; i < _sections.size(); i++)
+        {
+            jobPool.AddTask([this, i, compression, level, &compressedSections, &checksums, &compressionFailed]() -> void
+            {
+                const auto &section = _sections[i];
+                checksums[i] = CalculateChecksum(section.Data, section.Length);
+                if (compression == PARK_FILE_COMPRESSION::NONE)
+                {
+                    return;
+                }
+                try
+                {
+                    compressedSections[i] = Compress(section.Data, section.Length, level);
+                }
+                catch (const std::exception &)
+                {
+                    compressionFailed = true;
+                }
+                if (compressedSections[i].size() >= section.Length)
+                {
+                    // Store data that doesn't compress as it is
+                    compressedSections[i].clear();
+                    compressedSections[i].shrink_to_fit();
+                }
+            });
+        }
+        jobPool.Join();
+    }
+    if (compressionFailed)
+    {
+        throw IOException("Unable to compress park section.");
+    }
+
+    uint64 offset = PARK_FILE_HEADER_SIZE + _sections.size() * PARK_FILE_SECTION_ENTRY_SIZE;
+    uint64 length = offset;
+    for (size_t i = 0; i < _sections.size(); i++)
+    {
+        bool isCompressed = !compressedSections[i].empty();
+        length += isCompressed ? compressedSections[i].size() : _sections[i].Length;
+    }
+
+    stream->WriteValue<uint32>(PARK_FILE_MAGIC_NUMBER);
+    stream->WriteValue<uint32>(PARK_FILE_VERSION);
+    stream->WriteValue<uint32>((uint32)_sections.size());
+    stream->WriteValue<uint64>(length);
+    for (size_t i = 0; i < _sections.size(); i++)
+    {
+        const auto &section = _sections[i];
+        bool isCompressed = !compressedSections[i].empty();
+        uint64 compressedLength = isCompressed ? compressedSections[i].size() : section.Length;
+
+        stream->WriteValue<uint32>(section.Id);
+        stream->WriteValue<uint8>(isCompressed ? PARK_FILE_CODEC_DEFLATE : PARK_FILE_CODEC_NONE);
+        stream->WriteValue<uint64>(offset);
+        stream->WriteValue<uint64>(section.Length);
+        stream->WriteValue<uint64>(compressedLength);
+        stream->WriteValue<uint32>(checksums[i]);
+        offset += compressedLength;
+    }
+    for (size_t i = 0; i < _sections.size(); i++)
+    {
+        if (compressedSections[i].empty())
+        {
+            stream->Write(_sections[i].Data, _sections[i].Length);
+        }
+        else
+        {
+            stream->Write(compressedSections[i].data(), compressedSections[i].size());
+        }
+    }
+}
+
+ParkFileReader::ParkFileReader(IStream * stream)
+    : _stream(stream)
+{
+    _start = stream->GetPosition();
+    if (stream->ReadValue<uint32>() != PARK_FILE_MAGIC_NUMBER)
+    {
+        throw IOException("Not a park file.");
+    }
+    if (stream->ReadValue<uint32>() != PARK_FILE_VERSION)
+    {
+        throw IOException("Unsupported park file version.");
+    }
+
+    uint32 numSections = stream->ReadValue<uint32>();
+    _length = stream->ReadValue<uint64>();
+    if (numSections > PARK_FILE_MAX_SECTIONS || _start + _length > stream->GetLength())
+    {
+        throw IOException("Corrupt park file.");
+    }
+
+    _sections.resize(numSections);
+    for (auto &section : _sections)
+    {
+        section.Id = stream->ReadValue<uint32>();
+        section.Codec = stream->ReadValue<uint8>();
+        section.Offset = stream->ReadValue<uint64>();
+        section.Length = stream->ReadValue<uint64>();
+        section.CompressedLength = stream->ReadValue<uint64>();
+        section.Checksum = stream->ReadValue<uint32>();
+
+        bool isValid = section.Length <= PARK_FILE_MAX_SECTION_LENGTH &&
+                       section.Offset + section.CompressedLength <= _length;
+        if (section.Codec == PARK_FILE_CODEC_NONE)
+        {
+            isValid &= section.CompressedLength == section.Length;
+        }
+        else
+        {
+            isValid &= section.Codec == PARK_FILE_CODEC_DEFLATE;
+        }
+        if (!isValid)
+        {
+            throw IOException("Corrupt park file.");
+        }
+    }
+}
+
+bool ParkFileReader::HasSection(uint32 id) const
+{
+    return GetSection(id) != nullptr;
+}
+
+size_t ParkFileReader::ReadSection(uint32 id, void * dst, size_t length)
+{
+    auto section = GetSection(id);
+    if (section == nullptr)
+    {
+        throw IOException("Park file is missing a section.");
+    }
+
+    size_t sectionLength = (size_t)section->Length;
+    if (sectionLength <= length)
+    {
+        DecodeSection(*section, dst);
+        std::fill_n((uint8 *)dst + sectionLength, length - sectionLength, 0);
+    }
+    else
+    {
+        _decodedBuffer.resize(sectionLength);
+        DecodeSection(*section, _decodedBuffer.data());
+        std::copy_n(_decodedBuffer.data(), length, (uint8 *)dst);
+    }
+    return sectionLength;
+}
+
+std::vector<uint8> ParkFileReader::ReadSection(uint32 id)
+{
+    auto section = GetSection(id);
+    if (section == nullptr)
+    {
+        throw IOException("Park file is missing a section.");
+    }
+
+    std::vector<uint8> result((size_t)section->Length);
+    DecodeSection(*section, result.data());
+    return result;
+}
+
+const ParkFileReader::SectionEntry * ParkFileReader::GetSection(uint32 id) const
+{
+    for (const auto &section : _sections)
+    {
+        if (section.Id == id)
+        {
+            return &section;
+        }
+    }
+    return nullptr;
+}
+
+void ParkFileReader::DecodeSection(const SectionEntry &section, void * dst)
+{
+    _stream->SetPosition(_start + section.Offset);
+    if (section.Codec == PARK_FILE_CODEC_NONE)
+    {
+        _stream->Read(dst, (size_t)section.Length);
+    }
+    else
+    {
+        _compressedBuffer.resize((size_t)section.CompressedLength);
+        _stream->Read(_compressedBuffer.data(), _compressedBuffer.size());
+
+        uLongf decodedLength = (uLongf)section.Length;
+        sint32 result = uncompress((Bytef *)dst, &decodedLength, _compressedBuffer.data(), (uLong)_compressedBuffer.size());
+        if (result != Z_OK || decodedLength != section.Length)
+        {
+            throw IOException("Corrupt park file section.");
+        }
+    }
+
+    if (CalculateChecksum(dst, (size_t)section.Length) != section.Checksum)
+    {
+        throw IOException("Park file section checksum does not match.");
+    }
+}
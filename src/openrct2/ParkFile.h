@@ -0,0 +1,125 @@
+#pragma region Copyright (c) 2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+
+#pragma once
+
+#include <vector>
+#include "common.h"
+
+interface IStream;
+
+/**
+ * How hard the sections of a park file are compressed.
+ */
+enum class PARK_FILE_COMPRESSION : uint8
+{
+    NONE,
+    FAST,       // Quickest to write, used for autosaves
+    SMALL,      // Smallest output, for parks that are kept or shared
+};
+
+/**
+ * The sections of a park file. Each holds the same data as the SV6 chunk it is named after.
+ */
+enum PARK_FILE_SECTION : uint32
+{
+    PARK_FILE_SECTION_HEADER,
+    PARK_FILE_SECTION_INFO,
+    PARK_FILE_SECTION_PACKED_OBJECTS,
+    PARK_FILE_SECTION_OBJECTS,
+    PARK_FILE_SECTION_DATE,
+    PARK_FILE_SECTION_TILE_ELEMENTS,
+    PARK_FILE_SECTION_PARK,
+};
+
+namespace ParkFile
+{
+    /**
+     * Checks whether a park file starts at the current position of the stream, without moving it.
+     */
+    bool IsParkFile(IStream * stream);
+}
+
+/**
+ * Writes the native park container. Sections are compressed individually and listed in a table
+ * at the start of the file along with a checksum of each, so they can be read back in any order.
+ */
+class ParkFileWriter final
+{
+private:
+    struct Section
+    {
+        uint32              Id;
+        const void *        Data;
+        size_t              Length;
+    };
+
+    std::vector<Section> _sections;
+
+public:
+    /**
+     * Adds a section to be written. The data is not copied and must remain valid until Write is called.
+     */
+    void AddSection(uint32 id, const void * data, size_t length);
+    void Write(IStream * stream, PARK_FILE_COMPRESSION compression) const;
+};
+
+/**
+ * Reads sections of the native park container from a stream.
+ */
+class ParkFileReader final
+{
+private:
+    struct SectionEntry
+    {
+        uint32  Id;
+        uint8   Codec;
+        uint64  Offset;
+        uint64  Length;
+        uint64  CompressedLength;
+        uint32  Checksum;
+    };
+
+    IStream * const             _stream;
+    uint64                      _start = 0;
+    uint64                      _length = 0;
+    std::vector<SectionEntry>   _sections;
+    std::vector<uint8>          _compressedBuffer;
+    std::vector<uint8>          _decodedBuffer;
+
+public:
+    explicit ParkFileReader(IStream * stream);
+
+    /**
+     * Gets the length of the whole container, from the position the stream was at when it was opened.
+     */
+    uint64 GetLength() const { return _length; }
+    bool HasSection(uint32 id) const;
+
+    /**
+     * Reads a section directly into the destination buffer. If the section is larger than length,
+     * only length is copied. If the section is smaller than length, the remaining space is padded
+     * with zero.
+     * @returns The length of the section.
+     */
+    size_t ReadSection(uint32 id, void * dst, size_t length);
+    std::vector<uint8> ReadSection(uint32 id);
+
+private:
+    const SectionEntry * GetSection(uint32 id) const;
+    void DecodeSection(const SectionEntry &section, void * dst);
+};
@@ -83,6 +83,11 @@ namespace ParkImporter
     IParkImporter * CreateS4();
     IParkImporter * CreateS6(IObjectRepository * objectRepository, IObjectManager * objectManager);
 
+    /**
+     * Reads the scenario index details of an SC4 by decoding only the fields needed, rather than the whole park.
+     */
+    bool ReadS4ScenarioDetails(const std::string &path, scenario_index_entry * dst);
+
     bool ExtensionIsRCT1(const std::string &extension);
     bool ExtensionIsScenario(const std::string &extension);
 }
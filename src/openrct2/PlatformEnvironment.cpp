@@ -195,8 +195,10 @@ const char * PlatformEnvironment::DirectoryNamesRCT2[] =
     nullptr,                // LANGUAGE
     nullptr,                // LOG_CHAT
     nullptr,                // LOG_SERVER
+    nullptr,                // LOG_DESYNCS
     nullptr,                // NETWORK_KEY
     "ObjData",              // OBJECT
+    nullptr,                // REPLAY
     "Saved Games",          // SAVE
     "Scenarios",            // SCENARIO
     nullptr,                // SCREENSHOT
@@ -213,8 +215,10 @@ const char * PlatformEnvironment::DirectoryNamesOpenRCT2[] =
     "language",             // LANGUAGE
     "chatlogs",             // LOG_CHAT
     "serverlogs",           // LOG_SERVER
+    "desyncs",              // LOG_DESYNCS
     "keys",                 // NETWORK_KEY
     "object",               // OBJECT
+    "replay",               // REPLAY
     "save",                 // SAVE
     "scenario",             // SCENARIO
     "screenshot",           // SCREENSHOT
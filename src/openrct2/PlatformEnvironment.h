@@ -43,8 +43,10 @@ namespace OpenRCT2
         LANGUAGE,           // Contains language packs.
         LOG_CHAT,           // Contains chat logs.
         LOG_SERVER,         // Contains server logs.
+        LOG_DESYNCS,        // Contains desync dumps.
         NETWORK_KEY,        // Contains the user's public and private keys.
         OBJECT,             // Contains objects.
+        REPLAY,             // Contains recorded sessions.
         SAVE,               // Contains saved games (SV6).
         SCENARIO,           // Contains scenarios (SC6).
         SCREENSHOT,         // Contains screenshots.
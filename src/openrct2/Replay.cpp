@@ -0,0 +1,417 @@
+#pragma region Copyright (c) 2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#include <algorithm>
+#include <memory>
+#include "actions/GameAction.h"
+#include "core/DataSerialiser.h"
+#include "core/FileStream.hpp"
+#include "core/IStream.hpp"
+#include "core/MemoryStream.h"
+#include "core/Util.hpp"
+#include "Game.h"
+#include "network/network.h"
+#include "Replay.h"
+#include "ride/Ride.h"
+
+static constexpr uint32 REPLAY_MAGIC = 0x5052524F; // ORRP
+static constexpr uint32 REPLAY_VERSION = 2;
+// Ticks between the digests a recording keeps to verify its replay against
+static constexpr uint32 REPLAY_RECORD_DIGEST_INTERVAL = 400;
+
+enum
+{
+    REPLAY_COMMAND_FLAG_ACTION = 1 << 0,
+    REPLAY_COMMAND_FLAG_IN_UPDATE = 1 << 1,
+};
+
+static const ReplayRecording * _replay = nullptr;
+static size_t _replayNextCommand = 0;
+static size_t _replayNextDigest = 0;
+static bool _replayDiverged = false;
+static StateDigest _replayExpectedDigest;
+static StateDigest _replayActualDigest;
+
+static std::unique_ptr<ReplayRecording> _recording;
+static uint32 _recordingStartTick = 0;
+static sint32 _recordingSuspended = 0;
+static bool _recordingInUpdate = false;
+
+void ReplayRecording::Clear()
+{
+    Park.clear();
+    Commands.clear();
+    Digests.clear();
+}
+
+void ReplayRecording::AddGameCommand(uint32 tick, const uint32 * args, uint8 playerId, bool inUpdate)
+{
+    ReplayCommand command;
+    command.Tick = tick;
+    command.PlayerId = playerId;
+    command.InUpdate = inUpdate;
+    std::copy_n(args, Util::CountOf(command.Args), command.Args);
+    Commands.push_back(std::move(command));
+}
+
+void ReplayRecording::AddGameAction(uint32 tick, const GameAction * action, bool inUpdate)
+{
+    DataSerialiser ds(true);
+    action->Serialise(ds);
+    const MemoryStream &stream = ds.GetStream();
+    auto data = (const uint8 *)stream.GetData();
+
+    ReplayCommand command;
+    command.Tick = tick;
+    command.PlayerId = (uint8)action->GetPlayer();
+    command.IsAction = true;
+    command.InUpdate = inUpdate;
+    command.ActionType = action->GetType();
+    command.ActionData.assign(data, data + stream.GetLength());
+    Commands.push_back(std::move(command));
+}
+
+static void WriteBytes(IStream * stream, const std::vector<uint8> &bytes)
+{
+    stream->WriteValue<uint32>((uint32)bytes.size());
+    stream->Write(bytes.data(), bytes.size());
+}
+
+static void ReadBytes(IStream * stream, std::vector<uint8> &bytes)
+{
+    uint32 size = stream->ReadValue<uint32>();
+    if (size > stream->GetLength() - stream->GetPosition())
+    {
+        throw IOException("Replay data is truncated.");
+    }
+    bytes.resize(size);
+    stream->Read(bytes.data(), size);
+}
+
+void ReplayRecording::Save(IStream * stream) const
+{
+    stream->WriteValue<uint32>(REPLAY_MAGIC);
+    stream->WriteValue<uint32>(REPLAY_VERSION);
+    WriteBytes(stream, Park);
+
+    stream->WriteValue<uint32>((uint32)Commands.size());
+    for (const auto &command : Commands)
+    {
+        stream->WriteValue<uint32>(command.Tick);
+        stream->WriteValue<uint8>(command.PlayerId);
+        uint8 flags = 0;
+        if (command.IsAction) flags |= REPLAY_COMMAND_FLAG_ACTION;
+        if (command.InUpdate) flags |= REPLAY_COMMAND_FLAG_IN_UPDATE;
+        stream->WriteValue<uint8>(flags);
+        if (command.IsAction)
+        {
+            stream->WriteValue<uint32>(command.ActionType);
+            WriteBytes(stream, command.ActionData);
+        }
+        else
+        {
+            for (uint32 arg : command.Args)
+            {
+                stream->WriteValue<uint32>(arg);
+            }
+        }
+    }
+
+    stream->WriteValue<uint32>((uint32)Digests.size());
+    for (const auto &digest : Digests)
+    {
+        stream->WriteValue<uint32>(digest.Tick);
+        for (uint32 hash : digest.Hashes)
+        {
+            stream->WriteValue<uint32>(hash);
+        }
+    }
+}
+
+void ReplayRecording::Load(IStream * stream)
+{
+    Clear();
+    if (stream->ReadValue<uint32>() != REPLAY_MAGIC)
+    {
+        throw IOException("Not a replay file.");
+    }
+    if (stream->ReadValue<uint32>() != REPLAY_VERSION)
+    {
+        throw IOException("Unsupported replay version.");
+    }
+    ReadBytes(stream, Park);
+
+    uint32 numCommands = stream->ReadValue<uint32>();
+    for (uint32 i = 0; i < numCommands; i++)
+    {
+        ReplayCommand command;
+        command.Tick = stream->ReadValue<uint32>();
+        command.PlayerId = stream->ReadValue<uint8>();
+        uint8 flags = stream->ReadValue<uint8>();
+        command.IsAction = (flags & REPLAY_COMMAND_FLAG_ACTION) != 0;
+        command.InUpdate = (flags & REPLAY_COMMAND_FLAG_IN_UPDATE) != 0;
+        if (command.IsAction)
+        {
+            command.ActionType = stream->ReadValue<uint32>();
+            ReadBytes(stream, command.ActionData);
+        }
+        else
+        {
+            for (uint32 &arg : command.Args)
+            {
+                arg = stream->ReadValue<uint32>();
+            }
+        }
+        Commands.push_back(std::move(command));
+    }
+
+    uint32 numDigests = stream->ReadValue<uint32>();
+    for (uint32 i = 0; i < numDigests; i++)
+    {
+        StateDigest digest;
+        digest.Tick = stream->ReadValue<uint32>();
+        for (uint32 &hash : digest.Hashes)
+        {
+            hash = stream->ReadValue<uint32>();
+        }
+        Digests.push_back(digest);
+    }
+}
+
+static void ExecuteCommand(const ReplayCommand &command)
+{
+    // Commands run with the flags they were recorded with, e.g. networked for commands a client
+    // received from its server
+    if (command.IsAction)
+    {
+        GameAction::Ptr action = GameActions::Create(command.ActionType);
+        if (action == nullptr)
+        {
+            log_warning("Unknown game action %u in replay.", command.ActionType);
+            return;
+        }
+        MemoryStream stream(command.ActionData.data(), command.ActionData.size());
+        DataSerialiser ds(false, stream);
+        action->Serialise(ds);
+        GameActions::Execute(action.get());
+    }
+    else
+    {
+        const uint32 * args = command.Args;
+        game_command_playerid = command.PlayerId;
+        game_do_command(args[0], args[1], args[2], args[3], args[4], args[5], args[6]);
+    }
+}
+
+/**
+ * Runs the commands recorded for the current tick, only those recorded between updates unless
+ * the tick's update has already run.
+ */
+static void RunCommands(bool inUpdate)
+{
+    const auto &commands = _replay->Commands;
+    while (_replayNextCommand < commands.size())
+    {
+        const ReplayCommand &command = commands[_replayNextCommand];
+        if (command.Tick > gCurrentTicks || (command.Tick == gCurrentTicks && command.InUpdate && !inUpdate))
+        {
+            break;
+        }
+
+        _replayNextCommand++;
+        if (command.Tick < gCurrentTicks)
+        {
+            log_warning("Skipping replay command for tick %u, current tick is %u.", command.Tick, gCurrentTicks);
+            continue;
+        }
+        ExecuteCommand(command);
+    }
+}
+
+bool replay_begin(const ReplayRecording * recording)
+{
+    replay_end();
+    if (_recording != nullptr || !network_load_map(recording->Park.data(), recording->Park.size()))
+    {
+        return false;
+    }
+    game_load_init();
+    fix_invalid_vehicle_sprite_sizes();
+
+    _replay = recording;
+    return true;
+}
+
+void replay_end()
+{
+    _replay = nullptr;
+    _replayNextCommand = 0;
+    _replayNextDigest = 0;
+    _replayDiverged = false;
+}
+
+bool replay_is_active()
+{
+    return _replay != nullptr;
+}
+
+bool replay_is_finished()
+{
+    return _replay == nullptr || _replayNextCommand >= _replay->Commands.size();
+}
+
+bool replay_get_divergence(StateDigest * expected, StateDigest * actual)
+{
+    if (_replayDiverged)
+    {
+        *expected = _replayExpectedDigest;
+        *actual = _replayActualDigest;
+    }
+    return _replayDiverged;
+}
+
+void replay_check_digest()
+{
+    if (_replay == nullptr || _replayDiverged)
+    {
+        return;
+    }
+
+    const auto &digests = _replay->Digests;
+    while (_replayNextDigest < digests.size() && digests[_replayNextDigest].Tick < gCurrentTicks)
+    {
+        _replayNextDigest++;
+    }
+    if (_replayNextDigest < digests.size() && digests[_replayNextDigest].Tick == gCurrentTicks)
+    {
+        const StateDigest &expected = digests[_replayNextDigest++];
+        StateDigest actual = StateDigest::Compute(gCurrentTicks);
+        if (actual.FindMismatch(expected) != STATE_DIGEST_COUNT)
+        {
+            _replayDiverged = true;
+            _replayExpectedDigest = expected;
+            _replayActualDigest = actual;
+        }
+    }
+}
+
+void replay_update_begin()
+{
+    if (_replay != nullptr)
+    {
+        RunCommands(false);
+        replay_check_digest();
+    }
+    if (_recording != nullptr && (gCurrentTicks - _recordingStartTick) % REPLAY_RECORD_DIGEST_INTERVAL == 0)
+    {
+        _recording->Digests.push_back(StateDigest::Compute(gCurrentTicks));
+    }
+    _recordingInUpdate = true;
+}
+
+void replay_update_end()
+{
+    if (_replay != nullptr)
+    {
+        RunCommands(true);
+    }
+    _recordingInUpdate = false;
+}
+
+void replay_process_commands()
+{
+    if (_replay != nullptr)
+    {
+        RunCommands(false);
+    }
+}
+
+bool replay_start_recording()
+{
+    if (_recording != nullptr || _replay != nullptr)
+    {
+        return false;
+    }
+
+    auto recording = std::make_unique<ReplayRecording>();
+    if (!network_save_map(recording->Park))
+    {
+        return false;
+    }
+    _recording = std::move(recording);
+    _recordingStartTick = gCurrentTicks;
+    _recordingSuspended = 0;
+    return true;
+}
+
+bool replay_stop_recording(const std::string &path)
+{
+    if (_recording == nullptr)
+    {
+        return false;
+    }
+
+    // The final digest lets a replay verify the whole session, not just the last interval
+    auto recording = std::move(_recording);
+    if (recording->Digests.empty() || recording->Digests.back().Tick != gCurrentTicks)
+    {
+        recording->Digests.push_back(StateDigest::Compute(gCurrentTicks));
+    }
+    try
+    {
+        auto fs = FileStream(path, FILE_MODE_WRITE);
+        recording->Save(&fs);
+        return true;
+    }
+    catch (const std::exception &e)
+    {
+        log_error("Unable to save replay: %s", e.what());
+        return false;
+    }
+}
+
+bool replay_is_recording()
+{
+    return _recording != nullptr;
+}
+
+void replay_record_game_command(const sint32 * args, sint32 playerId)
+{
+    if (_recording != nullptr && _recordingSuspended == 0)
+    {
+        const uint32 registers[] = { (uint32)args[0], (uint32)args[1], (uint32)args[2], (uint32)args[3],
+                                     (uint32)args[4], (uint32)args[5], (uint32)args[6] };
+        _recording->AddGameCommand(gCurrentTicks, registers, (uint8)playerId, _recordingInUpdate);
+    }
+}
+
+void replay_record_game_action(const GameAction * action)
+{
+    if (_recording != nullptr && _recordingSuspended == 0)
+    {
+        _recording->AddGameAction(gCurrentTicks, action, _recordingInUpdate);
+    }
+}
+
+void replay_suspend_recording()
+{
+    _recordingSuspended++;
+}
+
+void replay_resume_recording()
+{
+    _recordingSuspended--;
+}
@@ -0,0 +1,84 @@
+#pragma region Copyright (c) 2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "common.h"
+#include "StateDigest.h"
+
+interface IStream;
+struct GameAction;
+
+struct ReplayCommand
+{
+    uint32              Tick = 0;
+    uint8               PlayerId = 0;
+    bool                IsAction = false;
+    // Whether the command ran inside game_logic_update, after the tick's simulation, rather than
+    // between two updates
+    bool                InUpdate = false;
+    uint32              Args[7] = {};   // eax, ebx, ecx, edx, esi, edi, ebp of a game command
+    uint32              ActionType = 0;
+    std::vector<uint8>  ActionData;     // Serialised game action
+};
+
+/**
+ * A park in network map format together with every game command run against it since it was
+ * loaded. Replaying the commands at their ticks reproduces the session deterministically.
+ */
+struct ReplayRecording
+{
+    std::vector<uint8>          Park;
+    std::vector<ReplayCommand>  Commands;
+    // Digests the replay is expected to reproduce, e.g. those received from a server
+    std::vector<StateDigest>    Digests;
+
+    void Clear();
+    void AddGameCommand(uint32 tick, const uint32 * args, uint8 playerId, bool inUpdate);
+    void AddGameAction(uint32 tick, const GameAction * action, bool inUpdate);
+
+    void Save(IStream * stream) const;
+    void Load(IStream * stream);
+};
+
+/**
+ * Loads the park of the recording and starts feeding its commands to game_logic_update. Each
+ * digest of the recording is checked at the start of its tick, replaying stops being valid at the
+ * first one that does not match.
+ */
+bool replay_begin(const ReplayRecording * recording);
+void replay_end();
+bool replay_is_active();
+bool replay_is_finished();
+bool replay_get_divergence(StateDigest * expected, StateDigest * actual);
+void replay_check_digest();
+
+void replay_update_begin();
+void replay_update_end();
+void replay_process_commands();
+
+/**
+ * Records every command run from now on, starting from a snapshot of the current park.
+ */
+bool replay_start_recording();
+bool replay_stop_recording(const std::string &path);
+bool replay_is_recording();
+void replay_record_game_command(const sint32 * args, sint32 playerId);
+void replay_record_game_action(const GameAction * action);
+void replay_suspend_recording();
+void replay_resume_recording();
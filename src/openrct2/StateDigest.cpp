@@ -0,0 +1,258 @@
+#pragma region Copyright (c) 2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include "management/Finance.h"
+#include "ride/Ride.h"
+#include "scenario/Scenario.h"
+#include "StateDigest.h"
+#include "world/Map.h"
+#include "world/Park.h"
+#include "world/Sprite.h"
+
+static constexpr uint64 FNV_OFFSET_BASIS = 0xCBF29CE484222325ULL;
+static constexpr uint64 FNV_PRIME = 0x100000001B3ULL;
+
+/**
+ * FNV-1a over 64-bit words rather than bytes. Weaker mixing than the byte-wise variant but
+ * several times faster, and any single changed word still changes the result.
+ */
+static uint64 HashBytes(uint64 hash, const void * data, size_t size)
+{
+    auto src = (const uint8 *)data;
+    for (; size >= sizeof(uint64); size -= sizeof(uint64), src += sizeof(uint64))
+    {
+        uint64 word;
+        std::memcpy(&word, src, sizeof(uint64));
+        hash = (hash ^ word) * FNV_PRIME;
+    }
+    for (; size > 0; size--, src++)
+    {
+        hash = (hash ^ *src) * FNV_PRIME;
+    }
+    return hash;
+}
+
+template<typename T>
+static uint64 HashValue(uint64 hash, const T &value)
+{
+    return HashBytes(hash, &value, sizeof(T));
+}
+
+/**
+ * Hashes an object in place, skipping the given byte range. Saves copying large structures just to
+ * clear a field that must not contribute to the digest.
+ */
+static uint64 HashBytesExcept(uint64 hash, const void * data, size_t size, size_t skipOffset, size_t skipSize)
+{
+    auto src = (const uint8 *)data;
+    hash = HashBytes(hash, src, skipOffset);
+    return HashBytes(hash, src + skipOffset + skipSize, size - skipOffset - skipSize);
+}
+
+static uint32 FoldHash(uint64 hash)
+{
+    return (uint32)(hash ^ (hash >> 32));
+}
+
+static uint32 HashRNG()
+{
+    uint64 hash = FNV_OFFSET_BASIS;
+    hash = HashValue(hash, gScenarioSrand0);
+    hash = HashValue(hash, gScenarioSrand1);
+    return FoldHash(hash);
+}
+
+static uint32 HashSprites()
+{
+    uint64 hash = FNV_OFFSET_BASIS;
+    for (size_t i = 0; i < MAX_SPRITES; i++)
+    {
+        const rct_sprite * sprite = get_sprite(i);
+        // Same exclusions as sprite_checksum
+        if (sprite->unknown.sprite_identifier == SPRITE_IDENTIFIER_NULL ||
+            sprite->unknown.sprite_identifier == SPRITE_IDENTIFIER_MISC)
+        {
+            continue;
+        }
+
+        // Skip the screen bounds, and the invalidation flags for peeps
+        constexpr size_t boundsOffset = offsetof(rct_unk_sprite, sprite_left);
+        constexpr size_t boundsEnd = offsetof(rct_unk_sprite, sprite_direction);
+        auto src = (const uint8 *)sprite;
+        hash = HashBytes(hash, src, boundsOffset);
+        if (sprite->unknown.sprite_identifier == SPRITE_IDENTIFIER_PEEP)
+        {
+            hash = HashBytesExcept(hash, src + boundsEnd, sizeof(rct_sprite) - boundsEnd,
+                offsetof(rct_peep, window_invalidate_flags) - boundsEnd, sizeof(uint8));
+        }
+        else
+        {
+            hash = HashBytes(hash, src + boundsEnd, sizeof(rct_sprite) - boundsEnd);
+        }
+    }
+    return FoldHash(hash);
+}
+
+static uint32 HashRides()
+{
+    uint64 hash = FNV_OFFSET_BASIS;
+    for (size_t i = 0; i < MAX_RIDES; i++)
+    {
+        const Ride * ride = &gRideList[i];
+        if (ride->type == RIDE_TYPE_NULL)
+        {
+            continue;
+        }
+
+        hash = HashBytesExcept(hash, ride, sizeof(Ride), offsetof(Ride, window_invalidate_flags), sizeof(uint8));
+    }
+    return FoldHash(hash);
+}
+
+static uint32 HashTileElements()
+{
+    // Walk the tiles rather than the element array, ghosts are inserted into it by each player's
+    // construction tools and would shift every element that follows
+    uint64 hash = FNV_OFFSET_BASIS;
+    sint32 mapSize = std::min<sint32>(gMapSize, MAXIMUM_MAP_SIZE_TECHNICAL);
+    for (sint32 y = 0; y < mapSize; y++)
+    {
+        for (sint32 x = 0; x < mapSize; x++)
+        {
+            const rct_tile_element * tileElement = map_get_first_element_at(x, y);
+            if (tileElement == nullptr)
+            {
+                continue;
+            }
+            do
+            {
+                if (!tile_element_is_ghost(tileElement))
+                {
+                    // Only the two flag bytes need masking, the rest is hashed straight from the map
+                    uint8 flags[2] = {
+                        (uint8)(tileElement->type & ~TILE_ELEMENT_TYPE_FLAG_HIGHLIGHT),
+                        (uint8)(tileElement->flags & ~TILE_ELEMENT_FLAG_LAST_TILE),
+                    };
+                    hash = HashBytes(hash, flags, sizeof(flags));
+                    hash = HashBytes(hash, &tileElement->base_height, sizeof(rct_tile_element) - offsetof(rct_tile_element, base_height));
+                }
+            }
+            while (!tile_element_is_last_for_tile(tileElement++));
+            hash = HashValue(hash, (uint32)((y << 16) | x));
+        }
+    }
+    return FoldHash(hash);
+}
+
+static uint32 HashFinances()
+{
+    uint64 hash = FNV_OFFSET_BASIS;
+    hash = HashValue(hash, gCash);
+    hash = HashValue(hash, gBankLoan);
+    hash = HashValue(hash, gBankLoanInterestRate);
+    hash = HashValue(hash, gCurrentExpenditure);
+    hash = HashValue(hash, gCurrentProfit);
+    hash = HashValue(hash, gHistoricalProfit);
+    hash = HashValue(hash, gParkValue);
+    hash = HashValue(hash, gCompanyValue);
+    hash = HashValue(hash, gParkEntranceFee);
+    hash = HashValue(hash, gTotalIncomeFromAdmissions);
+    hash = HashValue(hash, gExpenditureTable);
+    return FoldHash(hash);
+}
+
+StateDigest StateDigest::Compute(uint32 tick)
+{
+    StateDigest digest;
+    digest.Tick = tick;
+    digest.Hashes[STATE_DIGEST_RNG] = HashRNG();
+    digest.Hashes[STATE_DIGEST_SPRITES] = HashSprites();
+    digest.Hashes[STATE_DIGEST_RIDES] = HashRides();
+    digest.Hashes[STATE_DIGEST_TILE_ELEMENTS] = HashTileElements();
+    digest.Hashes[STATE_DIGEST_FINANCES] = HashFinances();
+    return digest;
+}
+
+sint32 StateDigest::FindMismatch(const StateDigest &other) const
+{
+    for (sint32 i = 0; i < STATE_DIGEST_COUNT; i++)
+    {
+        if (Hashes[i] != other.Hashes[i])
+        {
+            return i;
+        }
+    }
+    return STATE_DIGEST_COUNT;
+}
+
+void StateDigestHistory::Add(const StateDigest &digest)
+{
+    // A tick going backwards means a new park was loaded
+    if (!_digests.empty() && digest.Tick <= _digests.back().Tick)
+    {
+        _digests.clear();
+    }
+    if (_digests.size() >= _capacity)
+    {
+        _digests.pop_front();
+    }
+    _digests.push_back(digest);
+}
+
+const StateDigest * StateDigestHistory::Find(uint32 tick) const
+{
+    // Ticks are stored in ascending order, though not necessarily contiguously
+    size_t lo = 0;
+    size_t hi = _digests.size();
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        if (_digests[mid].Tick < tick)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    if (lo < _digests.size() && _digests[lo].Tick == tick)
+    {
+        return &_digests[lo];
+    }
+    return nullptr;
+}
+
+void StateDigestHistory::Clear()
+{
+    _digests.clear();
+}
+
+const char * state_digest_get_subsystem_name(sint32 subsystem)
+{
+    switch (subsystem)
+    {
+    case STATE_DIGEST_RNG:           return "rng";
+    case STATE_DIGEST_SPRITES:       return "sprites";
+    case STATE_DIGEST_RIDES:         return "rides";
+    case STATE_DIGEST_TILE_ELEMENTS: return "tile elements";
+    case STATE_DIGEST_FINANCES:      return "finances";
+    default:                         return "none";
+    }
+}
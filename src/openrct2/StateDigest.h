@@ -0,0 +1,71 @@
+#pragma region Copyright (c) 2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#pragma once
+
+#include "common.h"
+#include "core/RingBuffer.hpp"
+
+enum STATE_DIGEST_SUBSYSTEM
+{
+    STATE_DIGEST_RNG,
+    STATE_DIGEST_SPRITES,
+    STATE_DIGEST_RIDES,
+    STATE_DIGEST_TILE_ELEMENTS,
+    STATE_DIGEST_FINANCES,
+    STATE_DIGEST_COUNT,
+};
+
+/**
+ * Cheap per-subsystem hashes of the game state at the start of a tick. Anything that only the local
+ * user interface touches (ghosts, highlights, invalidation flags, sprite bounds) is left out so that
+ * the digests of a server and its clients can be compared directly.
+ */
+struct StateDigest
+{
+    uint32 Tick = 0;
+    uint32 Hashes[STATE_DIGEST_COUNT] = {};
+
+    static StateDigest Compute(uint32 tick);
+
+    /**
+     * Returns the first subsystem whose hash differs from the other digest, or STATE_DIGEST_COUNT
+     * if both digests match.
+     */
+    sint32 FindMismatch(const StateDigest &other) const;
+};
+
+/**
+ * A rolling window of the digests of the most recent ticks.
+ */
+class StateDigestHistory final
+{
+private:
+    RingBuffer<StateDigest> _digests;
+    size_t                  _capacity;
+
+public:
+    explicit StateDigestHistory(size_t capacity) : _capacity(capacity) { }
+
+    void Add(const StateDigest &digest);
+    const StateDigest * Find(uint32 tick) const;
+    void Clear();
+
+    size_t GetCount() const { return _digests.size(); }
+    const StateDigest & operator[](size_t index) const { return _digests[index]; }
+};
+
+const char * state_digest_get_subsystem_name(sint32 subsystem);
@@ -23,6 +23,7 @@
 #include "../localisation/Localisation.h"
 #include "../network/network.h"
 #include "../platform/platform.h"
+#include "../Replay.h"
 #include "../scenario/Scenario.h"
 #include "../world/Park.h"
 #include "GameAction.h"
@@ -181,7 +182,10 @@ namespace GameActions
             log_verbose("[%s] GameAction::Execute\n", "sv");
 
             // Execute the action, changing the game state
+            replay_record_game_action(action);
+            replay_suspend_recording();
             result = action->Execute();
+            replay_resume_recording();
 
             gCommandPosition.x = result->Position.x;
             gCommandPosition.y = result->Position.y;
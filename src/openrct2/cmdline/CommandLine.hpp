@@ -100,6 +100,8 @@ namespace CommandLine
     extern const CommandLineCommand ScreenshotCommands[];
     extern const CommandLineCommand SpriteCommands[];
     extern const CommandLineCommand BenchGfxCommands[];
+    extern const CommandLineCommand DesyncCommands[];
+    extern const CommandLineCommand ReplayCommands[];
 
     extern const CommandLineExample RootExamples[];
 
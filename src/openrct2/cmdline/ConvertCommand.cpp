@@ -63,9 +63,10 @@ exitcode_t CommandLine::HandleCommandConvert(CommandLineArgEnumerator * enumerat
 
     // Validate target type
     if (destinationFileType != FILE_EXTENSION_SC6 &&
-        destinationFileType != FILE_EXTENSION_SV6)
+        destinationFileType != FILE_EXTENSION_SV6 &&
+        destinationFileType != FILE_EXTENSION_PARK)
     {
-        Console::Error::WriteLine("Only conversion to .SC6 or .SV4 is supported.");
+        Console::Error::WriteLine("Only conversion to .SC6, .SV6 or .PARK is supported.");
         return EXITCODE_FAIL;
     }
 
@@ -88,8 +89,15 @@ exitcode_t CommandLine::HandleCommandConvert(CommandLineArgEnumerator * enumerat
             return EXITCODE_FAIL;
         }
         break;
+    case FILE_EXTENSION_PARK:
+        if (destinationFileType == FILE_EXTENSION_PARK)
+        {
+            Console::Error::WriteLine("File is already an OpenRCT2 park.");
+            return EXITCODE_FAIL;
+        }
+        break;
     default:
-        Console::Error::WriteLine("Only conversion from .SC4, .SV4, .SC6 or .SV6 is supported.");
+        Console::Error::WriteLine("Only conversion from .SC4, .SV4, .SC6, .SV6 or .PARK is supported.");
         return EXITCODE_FAIL;
     }
 
@@ -135,6 +143,10 @@ exitcode_t CommandLine::HandleCommandConvert(CommandLineArgEnumerator * enumerat
         {
             exporter->SaveScenario(destinationPath);
         }
+        else if (destinationFileType == FILE_EXTENSION_PARK)
+        {
+            exporter->SaveParkFile(destinationPath, false, PARK_FILE_COMPRESSION::SMALL);
+        }
         else
         {
             exporter->SaveGame(destinationPath);
@@ -165,6 +177,7 @@ static const utf8 * GetFileTypeFriendlyName(uint32 fileType)
     case FILE_EXTENSION_SV4: return "RollerCoaster Tycoon 1 saved game";
     case FILE_EXTENSION_SC6: return "RollerCoaster Tycoon 2 scenario";
     case FILE_EXTENSION_SV6: return "RollerCoaster Tycoon 2 saved game";
+    case FILE_EXTENSION_PARK: return "OpenRCT2 park";
     }
 
     assert(false);
@@ -0,0 +1,243 @@
+#pragma region Copyright (c) 2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include "../Context.h"
+#include "../core/Console.hpp"
+#include "../core/FileStream.hpp"
+#include "../Game.h"
+#include "../OpenRCT2.h"
+#include "../platform/platform.h"
+#include "../Replay.h"
+#include "CommandLine.hpp"
+
+using namespace OpenRCT2;
+
+static exitcode_t HandleDesync(CommandLineArgEnumerator * argEnumerator);
+static exitcode_t HandleReplay(CommandLineArgEnumerator * argEnumerator);
+
+const CommandLineCommand CommandLine::DesyncCommands[]
+{
+    // Main commands
+    DefineCommand("", "<file>", nullptr, HandleDesync),
+    CommandTableEnd
+};
+
+const CommandLineCommand CommandLine::ReplayCommands[]
+{
+    // Main commands
+    DefineCommand("", "<file>", nullptr, HandleReplay),
+    CommandTableEnd
+};
+
+static bool LoadRecording(CommandLineArgEnumerator * argEnumerator, ReplayRecording * recording)
+{
+    const utf8 * path;
+    if (!argEnumerator->TryPopString(&path))
+    {
+        Console::Error::WriteLine("Expected a recording to replay.");
+        return false;
+    }
+
+    try
+    {
+        auto fs = FileStream(path, FILE_MODE_OPEN);
+        recording->Load(&fs);
+        return true;
+    }
+    catch (const std::exception &e)
+    {
+        Console::Error::WriteLine("Unable to read '%s': %s", path, e.what());
+        return false;
+    }
+}
+
+/**
+ * Runs game_logic_update until every command and digest of the recording has been replayed, or
+ * until the replayed state diverges from the recording.
+ */
+static void RunReplay(const ReplayRecording &recording)
+{
+    uint32 endTick = gCurrentTicks;
+    if (!recording.Commands.empty())
+    {
+        // Commands recorded inside an update need that update to run
+        const ReplayCommand &command = recording.Commands.back();
+        endTick = std::max(endTick, command.Tick + (command.InUpdate ? 1 : 0));
+    }
+    if (!recording.Digests.empty())
+    {
+        endTick = std::max(endTick, recording.Digests.back().Tick);
+    }
+
+    StateDigest expected, actual;
+    gInUpdateCode = true;
+    while (gCurrentTicks < endTick && !replay_get_divergence(&expected, &actual))
+    {
+        if (game_is_paused())
+        {
+            // Commands still run while paused, one of them may unpause the game
+            replay_process_commands();
+            if (game_is_paused())
+            {
+                Console::WriteLine("The game stays paused at tick %u.", gCurrentTicks);
+                break;
+            }
+            continue;
+        }
+        game_logic_update();
+    }
+
+    // Commands and digest recorded after the last update
+    replay_process_commands();
+    replay_check_digest();
+    gInUpdateCode = false;
+}
+
+static bool ReportDivergence(uint32 startTick)
+{
+    StateDigest expected, actual;
+    if (!replay_get_divergence(&expected, &actual))
+    {
+        return false;
+    }
+
+    Console::WriteLine("First divergence at tick %u (%u ticks after the park was loaded):",
+        expected.Tick, expected.Tick - startTick);
+    for (sint32 i = 0; i < STATE_DIGEST_COUNT; i++)
+    {
+        if (expected.Hashes[i] != actual.Hashes[i])
+        {
+            Console::WriteLine("  %-14s expected %08X, got %08X", state_digest_get_subsystem_name(i),
+                expected.Hashes[i], actual.Hashes[i]);
+        }
+    }
+    return true;
+}
+
+static std::unique_ptr<IContext> BeginReplay(const ReplayRecording &recording)
+{
+    gOpenRCT2Headless = true;
+    std::unique_ptr<IContext> context(CreateContext());
+    if (!context->Initialise())
+    {
+        return nullptr;
+    }
+    if (!replay_begin(&recording))
+    {
+        Console::Error::WriteLine("Unable to load the park of the recording.");
+        return nullptr;
+    }
+    return context;
+}
+
+/**
+ * Replays a desync dump written by a network client and reports the first tick at which the
+ * replayed state stops matching the digests the server sent.
+ */
+static exitcode_t HandleDesync(CommandLineArgEnumerator * argEnumerator)
+{
+    core_init();
+    ReplayRecording recording;
+    if (!LoadRecording(argEnumerator, &recording))
+    {
+        return EXITCODE_FAIL;
+    }
+    if (recording.Digests.empty())
+    {
+        Console::Error::WriteLine("The dump contains no digests to compare against.");
+        return EXITCODE_FAIL;
+    }
+
+    auto context = BeginReplay(recording);
+    if (context == nullptr)
+    {
+        return EXITCODE_FAIL;
+    }
+
+    uint32 startTick = gCurrentTicks;
+    Console::WriteLine("Replaying %u commands from tick %u.", (uint32)recording.Commands.size(), startTick);
+    RunReplay(recording);
+
+    exitcode_t result = EXITCODE_OK;
+    if (ReportDivergence(startTick))
+    {
+        result = EXITCODE_FAIL;
+    }
+    else
+    {
+        Console::WriteLine("No divergence up to tick %u, the desync depends on state outside the dump.", gCurrentTicks);
+    }
+    replay_end();
+    return result;
+}
+
+/**
+ * Replays a recording as fast as possible and reports the simulation throughput, where the time
+ * went and whether the final state matches the recording.
+ */
+static exitcode_t HandleReplay(CommandLineArgEnumerator * argEnumerator)
+{
+    core_init();
+    ReplayRecording recording;
+    if (!LoadRecording(argEnumerator, &recording))
+    {
+        return EXITCODE_FAIL;
+    }
+
+    auto context = BeginReplay(recording);
+    if (context == nullptr)
+    {
+        return EXITCODE_FAIL;
+    }
+
+    uint32 startTick = gCurrentTicks;
+    std::fill_n(gGameLogicTimings, GAME_LOGIC_SUBSYSTEM_COUNT, 0.0);
+    gGameLogicProfiling = true;
+    auto startTime = std::chrono::high_resolution_clock::now();
+    RunReplay(recording);
+    std::chrono::duration<double> duration = std::chrono::high_resolution_clock::now() - startTime;
+    gGameLogicProfiling = false;
+
+    uint32 numTicks = gCurrentTicks - startTick;
+    double seconds = duration.count();
+    Console::WriteLine("Replayed %u ticks and %u commands in %.3f seconds, %.1f ticks/s.",
+        numTicks, (uint32)recording.Commands.size(), seconds, seconds > 0 ? numTicks / seconds : 0.0);
+    for (sint32 i = 0; i < GAME_LOGIC_SUBSYSTEM_COUNT; i++)
+    {
+        double subsystemSeconds = gGameLogicTimings[i];
+        Console::WriteLine("  %-10s %10.3f ms %6.1f%%", game_logic_get_subsystem_name(i), subsystemSeconds * 1000,
+            seconds > 0 ? subsystemSeconds * 100 / seconds : 0.0);
+    }
+
+    exitcode_t result = EXITCODE_OK;
+    if (ReportDivergence(startTick))
+    {
+        result = EXITCODE_FAIL;
+    }
+    else if (recording.Digests.empty())
+    {
+        Console::WriteLine("The recording has no state digests to verify against.");
+    }
+    else
+    {
+        Console::WriteLine("State verified against %u digests.", (uint32)recording.Digests.size());
+    }
+    replay_end();
+    return result;
+}
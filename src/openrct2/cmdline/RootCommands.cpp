@@ -46,6 +46,8 @@ sint32  gNetworkStart = NETWORK_MODE_NONE;
 char gNetworkStartHost[128];
 sint32  gNetworkStartPort = NETWORK_DEFAULT_PORT;
 char* gNetworkStartAddress = nullptr;
+bool gNetworkStartRelay = false;
+sint32 gNetworkStartRelayPort = NETWORK_DEFAULT_PORT;
 
 static uint32 _port            = 0;
 static char*  _address         = nullptr;
@@ -93,6 +95,7 @@ static exitcode_t HandleCommandEdit(CommandLineArgEnumerator * enumerator);
 static exitcode_t HandleCommandIntro(CommandLineArgEnumerator * enumerator);
 static exitcode_t HandleCommandHost(CommandLineArgEnumerator * enumerator);
 static exitcode_t HandleCommandJoin(CommandLineArgEnumerator * enumerator);
+static exitcode_t HandleCommandRelay(CommandLineArgEnumerator * enumerator);
 static exitcode_t HandleCommandSetRCT2(CommandLineArgEnumerator * enumerator);
 static exitcode_t HandleCommandScanObjects(CommandLineArgEnumerator * enumerator);
 
@@ -127,6 +130,7 @@ const CommandLineCommand CommandLine::RootCommands[]
 #ifndef DISABLE_NETWORK
     DefineCommand("host",     "<uri>",                  StandardOptions, HandleCommandHost   ),
     DefineCommand("join",     "<hostname>",             StandardOptions, HandleCommandJoin   ),
+    DefineCommand("relay",    "<hostname> <port>",      StandardOptions, HandleCommandRelay  ),
 #endif
     DefineCommand("set-rct2", "<path>",                 StandardOptions, HandleCommandSetRCT2),
     DefineCommand("convert",  "<source> <destination>", StandardOptions, CommandLine::HandleCommandConvert),
@@ -141,6 +145,8 @@ const CommandLineCommand CommandLine::RootCommands[]
     DefineSubCommand("screenshot", CommandLine::ScreenshotCommands),
     DefineSubCommand("sprite",     CommandLine::SpriteCommands    ),
     DefineSubCommand("benchgfx",   CommandLine::BenchGfxCommands  ),
+    DefineSubCommand("desync",     CommandLine::DesyncCommands    ),
+    DefineSubCommand("replay",     CommandLine::ReplayCommands    ),
 
     CommandTableEnd
 };
@@ -155,6 +161,9 @@ const CommandLineExample CommandLine::RootExamples[]
 #endif
 #ifndef DISABLE_NETWORK
     { "host ./my_park.sv6 --port 11753 --headless",   "run a headless server for a saved park" },
+    { "relay example.com 11754 --headless",           "relay a server to spectators on port 11754" },
+    { "desync ./desyncs/20180101-120000.desync",      "find the tick and subsystem a desync started at" },
+    { "replay ./replay/session.replay",               "benchmark the simulation with a recorded session" },
 #endif
     ExampleTableEnd
 };
@@ -325,6 +334,27 @@ exitcode_t HandleCommandJoin(CommandLineArgEnumerator * enumerator)
     return EXITCODE_CONTINUE;
 }
 
+exitcode_t HandleCommandRelay(CommandLineArgEnumerator * enumerator)
+{
+    exitcode_t result = HandleCommandJoin(enumerator);
+    if (result != EXITCODE_CONTINUE)
+    {
+        return result;
+    }
+
+    sint32 relayPort;
+    if (!enumerator->TryPopInteger(&relayPort) || relayPort <= 0 || relayPort > UINT16_MAX)
+    {
+        Console::Error::WriteLine("Expected a port to relay the server to spectators on.");
+        return EXITCODE_FAIL;
+    }
+
+    gNetworkStartRelay = true;
+    gNetworkStartRelayPort = relayPort;
+    gNetworkStartAddress = _address;
+    return EXITCODE_CONTINUE;
+}
+
 #endif // DISABLE_NETWORK
 
 static exitcode_t HandleCommandSetRCT2(CommandLineArgEnumerator * enumerator)
@@ -392,6 +392,8 @@ namespace Config
             model->log_chat = reader->GetBoolean("log_chat", false);
             model->log_server_actions = reader->GetBoolean("log_server_actions", false);
             model->pause_server_if_no_clients = reader->GetBoolean("pause_server_if_no_clients", false);
+            model->stats_port = reader->GetSint32("stats_port", 0);
+            model->stats_log_interval = reader->GetSint32("stats_log_interval", 60);
         }
     }
 
@@ -417,6 +419,8 @@ namespace Config
         writer->WriteBoolean("log_chat", model->log_chat);
         writer->WriteBoolean("log_server_actions", model->log_server_actions);
         writer->WriteBoolean("pause_server_if_no_clients", model->pause_server_if_no_clients);
+        writer->WriteSint32("stats_port", model->stats_port);
+        writer->WriteSint32("stats_log_interval", model->stats_log_interval);
     }
 
     static void ReadNotifications(IIniReader * reader)
@@ -153,6 +153,8 @@ struct NetworkConfiguration
     bool        log_chat;
     bool        log_server_actions;
     bool        pause_server_if_no_clients;
+    sint32      stats_port;
+    sint32      stats_log_interval;
 };
 
 struct NotificationConfiguration
@@ -16,8 +16,10 @@
 
 #pragma once
 
+#include <type_traits>
 #include "Endianness.h"
 #include "MemoryStream.h"
+#include "VarInt.hpp"
 
 template<typename T>
 struct DataSerializerTraits {
@@ -41,6 +43,36 @@ struct DataSerializerTraitsIntegral
     }
 };
 
+// Wider integers are mostly small, so they are written as varints rather than at full width
+template<typename T>
+struct DataSerializerTraitsVarInt
+{
+    static void encode(IStream *stream, const T& val)
+    {
+        uint32 raw = std::is_signed<T>::value ? VarInt::ZigZagEncode((sint32)val) : (uint32)val;
+        uint8 buffer[VarInt::MAX_LENGTH];
+        stream->Write(buffer, VarInt::Encode(raw, buffer));
+    }
+    static void decode(IStream *stream, T& val)
+    {
+        uint8 buffer[VarInt::MAX_LENGTH];
+        size_t length = 0;
+        do
+        {
+            if (length == VarInt::MAX_LENGTH)
+            {
+                throw IOException("Invalid varint.");
+            }
+            stream->Read(&buffer[length]);
+        }
+        while (buffer[length++] & 0x80);
+
+        uint32 raw = 0;
+        VarInt::Decode(buffer, length, &raw);
+        val = std::is_signed<T>::value ? (T)VarInt::ZigZagDecode(raw) : (T)raw;
+    }
+};
+
 template<>
 struct DataSerializerTraits<bool> : public DataSerializerTraitsIntegral<bool> {};
 
@@ -51,16 +83,16 @@ template<>
 struct DataSerializerTraits<sint8> : public DataSerializerTraitsIntegral<sint8> {};
 
 template<>
-struct DataSerializerTraits<uint16> : public DataSerializerTraitsIntegral<uint16> {};
+struct DataSerializerTraits<uint16> : public DataSerializerTraitsVarInt<uint16> {};
 
 template<>
-struct DataSerializerTraits<sint16> : public DataSerializerTraitsIntegral<sint16> {};
+struct DataSerializerTraits<sint16> : public DataSerializerTraitsVarInt<sint16> {};
 
 template<>
-struct DataSerializerTraits<uint32> : public DataSerializerTraitsIntegral<uint32> {};
+struct DataSerializerTraits<uint32> : public DataSerializerTraitsVarInt<uint32> {};
 
 template<>
-struct DataSerializerTraits<sint32> : public DataSerializerTraitsIntegral<sint32> {};
+struct DataSerializerTraits<sint32> : public DataSerializerTraitsVarInt<sint32> {};
 
 template<>
 struct DataSerializerTraits<std::string>
@@ -16,16 +16,25 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstring>
+#include <memory>
+#include <numeric>
 #include <string>
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 #include "../common.h"
 #include "File.h"
 #include "FileScanner.h"
 #include "FileStream.hpp"
+#include "JobPool.hpp"
+#include "MemoryMappedFile.h"
 #include "MemoryStream.h"
 #include "Path.hpp"
+#include "String.hpp"
 
 struct DirectoryStats
 {
@@ -35,14 +44,22 @@ struct DirectoryStats
     uint32 PathChecksum = 0;
 };
 
+struct ScannedFileStats
+{
+    uint64 Size = 0;
+    uint64 LastModified = 0;
+};
+
 struct ScanResult
 {
     DirectoryStats const Stats;
     std::vector<std::string> const Files;
+    std::vector<ScannedFileStats> const FileStats;
 
-    ScanResult(DirectoryStats stats, std::vector<std::string> files)
+    ScanResult(DirectoryStats stats, std::vector<std::string> files, std::vector<ScannedFileStats> fileStats)
         : Stats(stats),
-          Files(files)
+          Files(files),
+          FileStats(fileStats)
     {
     }
 };
@@ -55,7 +72,17 @@ struct FileIndexHeader
     uint8           VersionB = 0;
     uint16          LanguageId = 0;
     DirectoryStats  Stats;
+    uint32          NumFiles = 0;
+    uint32          NumRecords = 0;
     uint32          NumItems = 0;
+    uint32          RecordSize = 0;
+    uint32          NumSlots = 0;
+    uint32          FileTableOffset = 0;
+    uint32          RecordTableOffset = 0;
+    uint32          SlotTableOffset = 0;
+    uint32          PoolOffset = 0;
+    uint32          PoolSize = 0;
+    uint32          FileSize = 0;
 };
 
 template<>
@@ -72,16 +99,266 @@ inline constexpr FileIndexHeader bswap<FileIndexHeader>(const FileIndexHeader &n
             .FileDateModifiedChecksum = bswap(nat.Stats.FileDateModifiedChecksum),
             .PathChecksum = bswap(nat.Stats.PathChecksum),
         },
+        .NumFiles = bswap(nat.NumFiles),
+        .NumRecords = bswap(nat.NumRecords),
         .NumItems = bswap(nat.NumItems),
+        .RecordSize = bswap(nat.RecordSize),
+        .NumSlots = bswap(nat.NumSlots),
+        .FileTableOffset = bswap(nat.FileTableOffset),
+        .RecordTableOffset = bswap(nat.RecordTableOffset),
+        .SlotTableOffset = bswap(nat.SlotTableOffset),
+        .PoolOffset = bswap(nat.PoolOffset),
+        .PoolSize = bswap(nat.PoolSize),
+        .FileSize = bswap(nat.FileSize),
+    };
+}
+
+// A file found by the scan and the record of the item it produced
+struct FileIndexFileRecord
+{
+    uint32 PathOffset = 0;
+    uint32 ItemIndex = 0;
+    uint64 Size = 0;
+    uint64 LastModified = 0;
+};
+
+template<>
+inline constexpr FileIndexFileRecord bswap<FileIndexFileRecord>(const FileIndexFileRecord &nat) {
+    return FileIndexFileRecord{
+        .PathOffset = bswap(nat.PathOffset),
+        .ItemIndex = bswap(nat.ItemIndex),
+        .Size = bswap(nat.Size),
+        .LastModified = bswap(nat.LastModified),
+    };
+}
+
+// A slot of the hash table that finds item records by key
+struct FileIndexSlot
+{
+    uint64 Key = 0;
+    uint32 ItemIndex = 0;
+    uint32 Reserved = 0;
+};
+
+template<>
+inline constexpr FileIndexSlot bswap<FileIndexSlot>(const FileIndexSlot &nat) {
+    return FileIndexSlot{
+        .Key = bswap(nat.Key),
+        .ItemIndex = bswap(nat.ItemIndex),
+        .Reserved = bswap(nat.Reserved),
     };
 }
 
-template<typename TItem>
+/**
+ * Collects the strings and data that item records refer to while an index is written.
+ */
+class FileIndexPool final
+{
+private:
+    // Offset 0 is the empty string
+    std::vector<uint8> _data = { 0 };
+
+public:
+    uint32 AddString(const utf8 * str)
+    {
+        if (str == nullptr || str[0] == '\0')
+        {
+            return 0;
+        }
+        return AddData(str, String::SizeOf(str) + 1);
+    }
+
+    uint32 AddString(const std::string &str)
+    {
+        return AddString(str.c_str());
+    }
+
+    uint32 AddData(const void * data, size_t length)
+    {
+        auto offset = (uint32)_data.size();
+        auto bytes = (const uint8 *)data;
+        _data.insert(_data.end(), bytes, bytes + length);
+        return offset;
+    }
+
+    const std::vector<uint8> & GetData() const
+    {
+        return _data;
+    }
+};
+
+/**
+ * The contents of an index file: a header, a table of scanned files, a table of fixed size item
+ * records, a hash table of item keys and a pool of the strings and data the records refer to.
+ * Records are read straight from the mapped file and their strings are used in place. Every table
+ * is checked against the length of the file before it is used, so a damaged or truncated index is
+ * rejected rather than read past its end.
+ */
+class FileIndexData final
+{
+public:
+    // Item index of files that did not produce an item and of empty hash table slots
+    static constexpr uint32 NO_ITEM = 0xFFFFFFFF;
+
+private:
+    std::unique_ptr<MemoryMappedFile> _file;
+    std::vector<uint8> _buffer;
+    const uint8 * _data = nullptr;
+    size_t _length = 0;
+    FileIndexHeader _header;
+
+public:
+    explicit FileIndexData(const std::string &path)
+        : _file(std::make_unique<MemoryMappedFile>(path))
+    {
+        _data = (const uint8 *)_file->GetData();
+        _length = _file->GetLength();
+        ReadHeader();
+    }
+
+    explicit FileIndexData(std::vector<uint8> buffer)
+        : _buffer(std::move(buffer))
+    {
+        _data = _buffer.data();
+        _length = _buffer.size();
+        ReadHeader();
+    }
+
+    FileIndexData(const FileIndexData &) = delete;
+    FileIndexData & operator=(const FileIndexData &) = delete;
+
+    const FileIndexHeader & GetHeader() const
+    {
+        return _header;
+    }
+
+    FileIndexFileRecord GetFile(uint32 index) const
+    {
+        if (index >= _header.NumFiles)
+        {
+            throw IOException("File record out of range.");
+        }
+        return ReadAt<FileIndexFileRecord>(_header.FileTableOffset + (size_t)index * sizeof(FileIndexFileRecord));
+    }
+
+    template<typename TRecord>
+    TRecord GetRecord(uint32 index) const
+    {
+        if (index >= _header.NumRecords || _header.RecordSize != sizeof(TRecord))
+        {
+            throw IOException("Item record out of range.");
+        }
+        return ReadAt<TRecord>(_header.RecordTableOffset + (size_t)index * sizeof(TRecord));
+    }
+
+    /**
+     * Gets a string from the pool. The pool ends with a NUL, so every offset inside it is a valid string.
+     */
+    const utf8 * GetString(uint32 offset) const
+    {
+        if (offset >= _header.PoolSize)
+        {
+            throw IOException("String out of range.");
+        }
+        return (const utf8 *)(_data + _header.PoolOffset + offset);
+    }
+
+    const void * GetData(uint32 offset, size_t length) const
+    {
+        if (offset > _header.PoolSize || length > _header.PoolSize - offset)
+        {
+            throw IOException("Data out of range.");
+        }
+        return _data + _header.PoolOffset + offset;
+    }
+
+    /**
+     * Checks whether a pointer handed out by GetString or GetData belongs to this index.
+     */
+    bool Contains(const void * ptr) const
+    {
+        auto bytes = (const uint8 *)ptr;
+        return bytes >= _data && bytes < _data + _length;
+    }
+
+    /**
+     * Finds the record of the loaded item with the given key, or returns NO_ITEM.
+     */
+    uint32 Find(uint64 key) const
+    {
+        uint32 numSlots = _header.NumSlots;
+        uint32 slot = GetSlot(key, numSlots);
+        for (uint32 i = 0; i < numSlots; i++)
+        {
+            auto entry = ReadAt<FileIndexSlot>(_header.SlotTableOffset + (size_t)slot * sizeof(FileIndexSlot));
+            if (entry.ItemIndex == NO_ITEM)
+            {
+                break;
+            }
+            if (entry.Key == key)
+            {
+                return entry.ItemIndex < _header.NumItems ? entry.ItemIndex : NO_ITEM;
+            }
+            slot = (slot + 1) & (numSlots - 1);
+        }
+        return NO_ITEM;
+    }
+
+    static uint32 GetSlot(uint64 key, uint32 numSlots)
+    {
+        return (uint32)((key * 0x9E3779B97F4A7C15ULL) >> 32) & (numSlots - 1);
+    }
+
+private:
+    template<typename T>
+    T ReadAt(size_t offset) const
+    {
+        T value;
+        std::memcpy(&value, _data + offset, sizeof(T));
+        return bswap(value);
+    }
+
+    void ReadHeader()
+    {
+        if (_length < sizeof(FileIndexHeader))
+        {
+            throw IOException("Index file is too short.");
+        }
+        _header = ReadAt<FileIndexHeader>(0);
+        if (_header.HeaderSize != sizeof(FileIndexHeader))
+        {
+            throw IOException("Index file has an unknown header.");
+        }
+
+        // The length is checked first, a file that was cut short or appended to is not used at all
+        if (_header.FileSize != _length ||
+            !IsTableValid(_header.FileTableOffset, _header.NumFiles, sizeof(FileIndexFileRecord)) ||
+            !IsTableValid(_header.RecordTableOffset, _header.NumRecords, _header.RecordSize) ||
+            !IsTableValid(_header.SlotTableOffset, _header.NumSlots, sizeof(FileIndexSlot)) ||
+            !IsTableValid(_header.PoolOffset, _header.PoolSize, 1) ||
+            _header.PoolSize == 0 ||
+            _data[_header.PoolOffset + _header.PoolSize - 1] != '\0' ||
+            _header.NumItems > _header.NumRecords ||
+            (_header.NumSlots & (_header.NumSlots - 1)) != 0)
+        {
+            throw IOException("Index file is truncated or damaged.");
+        }
+    }
+
+    bool IsTableValid(uint32 offset, uint32 count, uint32 size) const
+    {
+        return (uint64)offset + (uint64)count * size <= _length;
+    }
+};
+
+template<typename TItem, typename TRecord>
 class FileIndex
 {
 private:
     // Index file format version which when incremented forces a rebuild
-    static constexpr uint8 FILE_INDEX_VERSION = 4;
+    static constexpr uint8 FILE_INDEX_VERSION = 6;
+
+    static constexpr uint32 NO_ITEM = FileIndexData::NO_ITEM;
 
     std::string const _name;
     uint32 const _magicNumber;
@@ -122,29 +399,36 @@ public:
     /**
      * Queries and directories and loads the index header. If the index is up to date,
      * the items are loaded from the index and returned, otherwise the index is rebuilt.
+     * Items can refer to strings held by the index data, pass indexData to keep it alive.
      */
-    std::vector<TItem> LoadOrBuild() const
+    std::vector<TItem> LoadOrBuild(std::shared_ptr<const FileIndexData> * indexData = nullptr) const
     {
         std::vector<TItem> items;
+        std::shared_ptr<const FileIndexData> data;
         auto scanResult = Scan();
-        auto readIndexResult = ReadIndexFile(scanResult.Stats);
-        if (std::get<0>(readIndexResult))
+        IndexedFileMap unchangedFiles;
+        if (!ReadIndexFile(scanResult, &data, &items, &unchangedFiles))
         {
-            // Index was loaded
-            items = std::get<1>(readIndexResult);
+            // Index was not loaded, only index files that are new or have changed
+            data = Build(scanResult, std::move(data), unchangedFiles);
+            items = ReadItems(*data);
         }
-        else
+        if (indexData != nullptr)
         {
-            // Index was not loaded
-            items = Build(scanResult);
+            *indexData = data;
         }
         return items;
     }
 
-    std::vector<TItem> Rebuild() const
+    std::vector<TItem> Rebuild(std::shared_ptr<const FileIndexData> * indexData = nullptr) const
     {
         auto scanResult = Scan();
-        auto items = Build(scanResult);
+        auto data = Build(scanResult, nullptr, IndexedFileMap());
+        auto items = ReadItems(*data);
+        if (indexData != nullptr)
+        {
+            *indexData = data;
+        }
         return items;
     }
 
@@ -156,20 +440,48 @@ protected:
     virtual std::tuple<bool, TItem> Create(const std::string &path) const abstract;
 
     /**
-     * Serialises an index item to the given stream.
+     * Creates the fixed size record of an index item, adding its strings and data to the pool.
      */
-    virtual void Serialise(IStream * stream, const TItem &item) const abstract;
+    virtual TRecord Serialise(const TItem &item, FileIndexPool * pool) const abstract;
 
     /**
-     * Deserialises an index item from the given stream.
+     * Creates an index item from its record. Strings and data can be used in place from the index data.
      */
-    virtual TItem Deserialise(IStream * stream) const abstract;
+    virtual TItem Deserialise(const TRecord &record, const FileIndexData &data) const abstract;
+
+    /**
+     * Frees an item returned by Create once it has been written to the index.
+     */
+    virtual void FreeItem(TItem * item) const
+    {
+    }
+
+    /**
+     * Gets the key the item can be found by with FileIndexData::Find.
+     */
+    virtual bool GetKey(const TItem &item, uint64 * key) const
+    {
+        return false;
+    }
+
+    /**
+     * Orders the items as they are to be loaded. The items from the returned count on are left
+     * out when the index is loaded, but are kept for when it is next rebuilt.
+     */
+    virtual size_t Arrange(const std::vector<const TItem *> &items, std::vector<size_t> * order) const
+    {
+        return items.size();
+    }
 
 private:
+    // Record index of the item of each file that is unchanged since the index was written
+    typedef std::unordered_map<std::string, uint32> IndexedFileMap;
+
     ScanResult Scan() const
     {
         DirectoryStats stats {};
         std::vector<std::string> files;
+        std::vector<ScannedFileStats> fileStats;
         for (const auto& directory : SearchPaths)
         {
             log_verbose("FileIndex:Scanning for %s in '%s'", _pattern.c_str(), directory.c_str());
@@ -182,6 +494,7 @@ private:
                 auto path = std::string(scanner->GetPath());
 
                 files.push_back(path);
+                fileStats.push_back({ fileInfo->Size, fileInfo->LastModified });
 
                 stats.TotalFiles++;
                 stats.TotalFileSize += fileInfo->Size;
@@ -193,111 +506,355 @@ private:
             }
             delete scanner;
         }
-        return ScanResult(stats, files);
+        return ScanResult(stats, files, fileStats);
     }
 
-    std::vector<TItem> Build(const ScanResult &scanResult) const
+    std::shared_ptr<const FileIndexData> Build(const ScanResult &scanResult,
+                                               std::shared_ptr<const FileIndexData> previous,
+                                               const IndexedFileMap &unchangedFiles) const
     {
-        std::vector<TItem> items;
-        Console::WriteLine("Building %s (%zu items)", _name.c_str(), scanResult.Files.size());
+        const size_t totalCount = scanResult.Files.size();
+        std::vector<std::tuple<bool, TItem>> results(totalCount);
+        std::vector<size_t> pendingFiles;
+        for (size_t i = 0; i < totalCount; i++)
+        {
+            if (!ReadUnchangedItem(scanResult.Files[i], previous.get(), unchangedFiles, &results[i]))
+            {
+                pendingFiles.push_back(i);
+            }
+        }
 
+        Console::WriteLine("Building %s (%zu of %zu items)", _name.c_str(), pendingFiles.size(), totalCount);
         auto startTime = std::chrono::high_resolution_clock::now();
-        // Start at 1, so that we can reach 100% completion status
-        size_t i = 1;
-        for (auto filePath : scanResult.Files)
-        {
-            Console::WriteFormat("File %5d of %d, done %3d%%\r", i, scanResult.Files.size(), i * 100 / scanResult.Files.size());
-            i++;
-            log_verbose("FileIndex:Indexing '%s'", filePath.c_str());
-            auto item = Create(filePath);
-            if (std::get<0>(item))
+        if (!pendingFiles.empty())
+        {
+            // Each file is indexed by whichever worker is free, but the results keep the scan order
+            // so that the index file is the same regardless of timing.
+            std::atomic<size_t> processed(0);
+            JobPool jobPool;
+            for (size_t fileIndex : pendingFiles)
             {
-                items.push_back(std::get<1>(item));
+                jobPool.AddTask([this, &scanResult, &results, &processed, fileIndex]() -> void
+                {
+                    const auto &filePath = scanResult.Files[fileIndex];
+                    log_verbose("FileIndex:Indexing '%s'", filePath.c_str());
+                    try
+                    {
+                        results[fileIndex] = Create(filePath);
+                    }
+                    catch (const std::exception &e)
+                    {
+                        Console::Error::WriteLine("Unable to index '%s': %s", filePath.c_str(), e.what());
+                    }
+                    processed++;
+                });
             }
+
+            // Progress is only ever printed from this thread
+            const size_t pendingCount = pendingFiles.size();
+            jobPool.Join([&processed, pendingCount]() -> void
+            {
+                size_t completed = processed;
+                Console::WriteFormat("File %5zu of %zu, done %3zu%%\r", completed, pendingCount, completed * 100 / pendingCount);
+            });
+            Console::WriteFormat("File %5zu of %zu, done %3zu%%\r", pendingCount, pendingCount, (size_t)100);
         }
 
-        WriteIndexFile(scanResult.Stats, items);
+        // The items are read back from the new index, so the created ones are no longer needed
+        auto image = CreateIndexImage(scanResult, results);
+
+        // Unmap the old index before it is replaced, Windows does not replace a file that is mapped
+        previous = nullptr;
+        WriteIndexFile(image);
+        auto data = std::make_shared<const FileIndexData>(std::move(image));
+        for (size_t fileIndex : pendingFiles)
+        {
+            if (std::get<0>(results[fileIndex]))
+            {
+                FreeItem(&std::get<1>(results[fileIndex]));
+            }
+        }
 
         auto endTime = std::chrono::high_resolution_clock::now();
         auto duration = (std::chrono::duration<float>)(endTime - startTime);
         Console::WriteLine("Finished building %s in %.2f seconds.", _name.c_str(), duration.count());
+        return data;
+    }
+
+    bool ReadUnchangedItem(const std::string &path,
+                           const FileIndexData * previous,
+                           const IndexedFileMap &unchangedFiles,
+                           std::tuple<bool, TItem> * result) const
+    {
+        auto it = unchangedFiles.find(path);
+        if (it == unchangedFiles.end())
+        {
+            return false;
+        }
+        if (it->second == NO_ITEM)
+        {
+            *result = std::make_tuple(false, TItem());
+            return true;
+        }
+        try
+        {
+            *result = std::make_tuple(true, Deserialise(previous->GetRecord<TRecord>(it->second), *previous));
+            return true;
+        }
+        catch (const std::exception &)
+        {
+            // Index the file again if its record can not be read
+            return false;
+        }
+    }
+
+    std::vector<TItem> ReadItems(const FileIndexData &data) const
+    {
+        uint32 numItems = data.GetHeader().NumItems;
+        std::vector<TItem> items;
+        items.reserve(numItems);
+        for (uint32 i = 0; i < numItems; i++)
+        {
+            items.push_back(Deserialise(data.GetRecord<TRecord>(i), data));
+        }
         return items;
     }
 
-    std::tuple<bool, std::vector<TItem>> ReadIndexFile(const DirectoryStats &stats) const
+    /**
+     * Reads the index file. If the directories have not changed, all items are read and true is returned.
+     * Otherwise the records of files whose size and modification time still match are added to unchangedFiles.
+     */
+    bool ReadIndexFile(const ScanResult &scanResult,
+                       std::shared_ptr<const FileIndexData> * indexData,
+                       std::vector<TItem> * items,
+                       IndexedFileMap * unchangedFiles) const
     {
         bool loadedItems = false;
-        std::vector<TItem> items;
         if (File::Exists(_indexPath))
         {
             try
             {
                 log_verbose("FileIndex:Loading index: '%s'", _indexPath.c_str());
-                auto fs = FileStream(_indexPath, FILE_MODE_OPEN);
-                uint64 size = fs.GetLength();
-                void* buffer = malloc(size);
-                fs.Read(buffer, size);
-                auto ms = MemoryStream(buffer, size, MEMORY_ACCESS::OWNER);
+                auto data = std::make_shared<const FileIndexData>(_indexPath);
 
                 // Read header, check if we need to re-scan
-                auto header = ms.ReadValue<FileIndexHeader>();
-                if (header.HeaderSize == sizeof(FileIndexHeader) &&
-                    header.MagicNumber == _magicNumber &&
+                const DirectoryStats &stats = scanResult.Stats;
+                const auto &header = data->GetHeader();
+                if (header.MagicNumber == _magicNumber &&
                     header.VersionA == FILE_INDEX_VERSION &&
                     header.VersionB == _version &&
                     header.LanguageId == gCurrentLanguage &&
-                    header.Stats.TotalFiles == stats.TotalFiles &&
+                    header.RecordSize == sizeof(TRecord))
+                {
+                    *indexData = data;
+                    if (header.Stats.TotalFiles == stats.TotalFiles &&
 #ifndef __psp2__ //slows down too much, see FileScanner.cpp
-                    header.Stats.TotalFileSize == stats.TotalFileSize &&
-                    header.Stats.FileDateModifiedChecksum == stats.FileDateModifiedChecksum &&
+                        header.Stats.TotalFileSize == stats.TotalFileSize &&
+                        header.Stats.FileDateModifiedChecksum == stats.FileDateModifiedChecksum &&
 #endif
-                    header.Stats.PathChecksum == stats.PathChecksum)
-                {
-                    // Directory is the same, just read the saved items
-                    for (uint32 i = 0; i < header.NumItems; i++)
+                        header.Stats.PathChecksum == stats.PathChecksum)
                     {
-                        auto item = Deserialise(&ms);
-                        items.push_back(item);
+                        // Directory is the same, just read the saved items
+                        *items = ReadItems(*data);
+                        loadedItems = true;
+                    }
+                    else
+                    {
+                        Console::WriteLine("%s out of date", _name.c_str());
+                        ReadUnchangedFiles(*data, scanResult, unchangedFiles);
                     }
-                    loadedItems = true;
                 }
                 else
                 {
                     Console::WriteLine("%s out of date", _name.c_str());
                 }
-                
             }
             catch (const std::exception &e)
             {
                 Console::Error::WriteLine("Unable to load index: '%s'.", _indexPath.c_str());
                 Console::Error::WriteLine("%s", e.what());
+                indexData->reset();
+                items->clear();
+                unchangedFiles->clear();
+                loadedItems = false;
+            }
+        }
+        return loadedItems;
+    }
+
+    void ReadUnchangedFiles(const FileIndexData &data, const ScanResult &scanResult, IndexedFileMap * unchangedFiles) const
+    {
+        std::unordered_map<std::string, size_t> scannedFiles;
+        for (size_t i = 0; i < scanResult.Files.size(); i++)
+        {
+            scannedFiles[scanResult.Files[i]] = i;
+        }
+
+        const auto &header = data.GetHeader();
+        for (uint32 i = 0; i < header.NumFiles; i++)
+        {
+            auto file = data.GetFile(i);
+            auto it = scannedFiles.find(data.GetString(file.PathOffset));
+            if (it != scannedFiles.end())
+            {
+                const auto &fileStats = scanResult.FileStats[it->second];
+                if (fileStats.Size == file.Size &&
+                    fileStats.LastModified == file.LastModified &&
+                    (file.ItemIndex == NO_ITEM || file.ItemIndex < header.NumRecords))
+                {
+                    (*unchangedFiles)[it->first] = file.ItemIndex;
+                }
             }
         }
-        return std::make_tuple(loadedItems, items);
     }
 
-    void WriteIndexFile(const DirectoryStats &stats, const std::vector<TItem> &items) const
+    std::vector<uint8> CreateIndexImage(const ScanResult &scanResult, const std::vector<std::tuple<bool, TItem>> &results) const
+    {
+        std::vector<const TItem *> items;
+        std::vector<size_t> itemFiles;
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            if (std::get<0>(results[i]))
+            {
+                items.push_back(&std::get<1>(results[i]));
+                itemFiles.push_back(i);
+            }
+        }
+
+        // Records are stored in the arranged order, the ones left out follow the loaded items
+        std::vector<size_t> order(items.size());
+        std::iota(order.begin(), order.end(), 0);
+        size_t numItems = std::min(Arrange(items, &order), order.size());
+
+        FileIndexPool pool;
+        std::vector<uint32> fileItems(results.size(), NO_ITEM);
+        std::vector<TRecord> records;
+        records.reserve(order.size());
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            fileItems[itemFiles[order[i]]] = (uint32)i;
+            records.push_back(Serialise(*items[order[i]], &pool));
+        }
+
+        std::vector<FileIndexFileRecord> files;
+        files.reserve(results.size());
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            FileIndexFileRecord file;
+            file.PathOffset = pool.AddString(scanResult.Files[i]);
+            file.ItemIndex = fileItems[i];
+            file.Size = scanResult.FileStats[i].Size;
+            file.LastModified = scanResult.FileStats[i].LastModified;
+            files.push_back(file);
+        }
+
+        // Hash table of the loaded items, kept at most half full
+        std::vector<FileIndexSlot> slots;
+        for (size_t i = 0; i < numItems; i++)
+        {
+            FileIndexSlot entry;
+            entry.ItemIndex = (uint32)i;
+            if (GetKey(*items[order[i]], &entry.Key))
+            {
+                if (slots.empty())
+                {
+                    size_t numSlots = 2;
+                    while (numSlots < numItems * 2)
+                    {
+                        numSlots *= 2;
+                    }
+                    FileIndexSlot emptySlot;
+                    emptySlot.ItemIndex = NO_ITEM;
+                    slots.resize(numSlots, emptySlot);
+                }
+                uint32 slot = FileIndexData::GetSlot(entry.Key, (uint32)slots.size());
+                while (slots[slot].ItemIndex != NO_ITEM)
+                {
+                    slot = (slot + 1) & (uint32)(slots.size() - 1);
+                }
+                slots[slot] = entry;
+            }
+        }
+
+        // The pool gets a final NUL so that no string can run past its end
+        const auto &poolData = pool.GetData();
+        uint64 fileTableOffset = AlignOffset(sizeof(FileIndexHeader));
+        uint64 recordTableOffset = AlignOffset(fileTableOffset + files.size() * sizeof(FileIndexFileRecord));
+        uint64 slotTableOffset = AlignOffset(recordTableOffset + records.size() * sizeof(TRecord));
+        uint64 poolOffset = slotTableOffset + slots.size() * sizeof(FileIndexSlot);
+        uint64 fileSize = poolOffset + poolData.size() + 1;
+        if (fileSize > UINT32_MAX)
+        {
+            throw IOException("Index is too large.");
+        }
+
+        FileIndexHeader header;
+        header.MagicNumber = _magicNumber;
+        header.VersionA = FILE_INDEX_VERSION;
+        header.VersionB = _version;
+        header.LanguageId = gCurrentLanguage;
+        header.Stats = scanResult.Stats;
+        header.NumFiles = (uint32)files.size();
+        header.NumRecords = (uint32)records.size();
+        header.NumItems = (uint32)numItems;
+        header.RecordSize = (uint32)sizeof(TRecord);
+        header.NumSlots = (uint32)slots.size();
+        header.FileTableOffset = (uint32)fileTableOffset;
+        header.RecordTableOffset = (uint32)recordTableOffset;
+        header.SlotTableOffset = (uint32)slotTableOffset;
+        header.PoolOffset = (uint32)poolOffset;
+        header.PoolSize = (uint32)(poolData.size() + 1);
+        header.FileSize = (uint32)fileSize;
+
+        MemoryStream ms((size_t)fileSize);
+        ms.WriteValue(header);
+        WritePadding(&ms, fileTableOffset);
+        for (const auto &file : files)
+        {
+            ms.WriteValue(file);
+        }
+        WritePadding(&ms, recordTableOffset);
+        for (const auto &record : records)
+        {
+            ms.WriteValue(record);
+        }
+        WritePadding(&ms, slotTableOffset);
+        for (const auto &slot : slots)
+        {
+            ms.WriteValue(slot);
+        }
+        ms.Write(poolData.data(), poolData.size());
+        ms.WriteValue<uint8>(0);
+
+        auto image = (const uint8 *)ms.GetData();
+        return std::vector<uint8>(image, image + ms.GetLength());
+    }
+
+    /**
+     * Writes the index next to the old one and then moves it over the old one, so that an index
+     * file another game has mapped is replaced rather than truncated underneath it.
+     */
+    void WriteIndexFile(const std::vector<uint8> &image) const
     {
         try
         {
             log_verbose("FileIndex:Writing index: '%s'", _indexPath.c_str());
             Path::CreateDirectory(Path::GetDirectory(_indexPath));
-            auto fs = FileStream(_indexPath, FILE_MODE_WRITE);
-    
-            // Write header
-            FileIndexHeader header;
-            header.MagicNumber = _magicNumber;
-            header.VersionA = FILE_INDEX_VERSION;
-            header.VersionB = _version;
-            header.LanguageId = gCurrentLanguage;
-            header.Stats = stats;
-            header.NumItems = (uint32)items.size();
-            fs.WriteValue(header);
-    
-            // Write items
-            for (const auto& item : items)
+
+            auto tempPath = _indexPath + ".tmp";
             {
-                Serialise(&fs, item);
+                auto fs = FileStream(tempPath, FILE_MODE_WRITE);
+                fs.Write(image.data(), image.size());
+            }
+            if (!File::Move(tempPath, _indexPath))
+            {
+                // Not every platform moves over an existing file
+                File::Delete(_indexPath);
+                if (!File::Move(tempPath, _indexPath))
+                {
+                    File::Delete(tempPath);
+                    throw IOException("Unable to replace index file.");
+                }
             }
         }
         catch (const std::exception &e)
@@ -307,6 +864,19 @@ private:
         }
     }
 
+    static uint64 AlignOffset(uint64 offset)
+    {
+        return (offset + 7) & ~(uint64)7;
+    }
+
+    static void WritePadding(IStream * stream, uint64 offset)
+    {
+        while (stream->GetPosition() < offset)
+        {
+            stream->WriteValue<uint8>(0);
+        }
+    }
+
     static uint32 GetPathChecksum(const std::string &path)
     {
         uint32 hash = 0xD8430DED;
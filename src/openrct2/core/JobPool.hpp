@@ -0,0 +1,131 @@
+#pragma region Copyright (c) 2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../common.h"
+
+/**
+ * A fixed set of worker threads that run queued tasks until the pool is destroyed.
+ */
+class JobPool
+{
+private:
+    typedef std::unique_lock<std::mutex> unique_lock;
+
+    std::atomic_bool                  _shouldStop = { false };
+    size_t                            _processing = 0;
+    std::vector<std::thread>          _threads;
+    std::deque<std::function<void()>> _pending;
+    std::condition_variable           _condPending;
+    std::condition_variable           _condComplete;
+    std::mutex                        _mutex;
+
+public:
+    explicit JobPool(size_t maxThreads = 255)
+    {
+        size_t numThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        numThreads = std::min(numThreads, maxThreads);
+        for (size_t n = 0; n < numThreads; n++)
+        {
+            _threads.emplace_back(&JobPool::ProcessQueue, this);
+        }
+    }
+
+    ~JobPool()
+    {
+        {
+            unique_lock lock(_mutex);
+            _shouldStop = true;
+            _condPending.notify_all();
+        }
+        for (auto &th : _threads)
+        {
+            th.join();
+        }
+    }
+
+    void AddTask(std::function<void()> workFn)
+    {
+        unique_lock lock(_mutex);
+        _pending.push_back(std::move(workFn));
+        _condPending.notify_one();
+    }
+
+    /**
+     * Waits until all queued tasks have completed.
+     * @param reportFn Called on the calling thread about every 100 ms while waiting.
+     */
+    void Join(std::function<void()> reportFn = nullptr)
+    {
+        unique_lock lock(_mutex);
+        while (!_pending.empty() || _processing != 0)
+        {
+            if (reportFn)
+            {
+                _condComplete.wait_for(lock, std::chrono::milliseconds(100));
+                lock.unlock();
+                reportFn();
+                lock.lock();
+            }
+            else
+            {
+                _condComplete.wait(lock);
+            }
+        }
+    }
+
+    size_t CountPending()
+    {
+        unique_lock lock(_mutex);
+        return _pending.size();
+    }
+
+private:
+    void ProcessQueue()
+    {
+        unique_lock lock(_mutex);
+        while (true)
+        {
+            _condPending.wait(lock, [this] { return _shouldStop || !_pending.empty(); });
+            if (_pending.empty())
+            {
+                // Only reached when stopping
+                break;
+            }
+
+            auto workFn = std::move(_pending.front());
+            _pending.pop_front();
+            _processing++;
+
+            lock.unlock();
+            workFn();
+            lock.lock();
+
+            _processing--;
+            _condComplete.notify_all();
+        }
+    }
+};
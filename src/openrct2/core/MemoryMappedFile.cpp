@@ -0,0 +1,108 @@
+#pragma region Copyright (c) 2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#elif (defined(__unix__) || defined(__APPLE__)) && !defined(__psp2__) && !defined(__WIIU__)
+    #define MEMORY_MAPPED_FILE_USE_MMAP
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "File.h"
+#include "Memory.hpp"
+#include "MemoryMappedFile.h"
+#include "../util/Util.h"
+
+MemoryMappedFile::MemoryMappedFile(const std::string &path)
+{
+#if defined(_WIN32)
+    auto pathW = utf8_to_widechar(path.c_str());
+    // Allow the file to be replaced while it is mapped, the mapping keeps the old contents
+    HANDLE hFile = CreateFileW(pathW, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    free(pathW);
+    if (hFile != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER fileSize;
+        if (GetFileSizeEx(hFile, &fileSize) && fileSize.QuadPart > 0 && (uint64)fileSize.QuadPart <= SIZE_MAX)
+        {
+            HANDLE hMapping = CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (hMapping != nullptr)
+            {
+                _data = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+                if (_data != nullptr)
+                {
+                    _hFile = hFile;
+                    _hMapping = hMapping;
+                    _length = (size_t)fileSize.QuadPart;
+                    _mapped = true;
+                    return;
+                }
+                CloseHandle(hMapping);
+            }
+        }
+        CloseHandle(hFile);
+    }
+#elif defined(MEMORY_MAPPED_FILE_USE_MMAP)
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd != -1)
+    {
+        struct stat statInfo;
+        if (fstat(fd, &statInfo) == 0 && statInfo.st_size > 0 && (uint64)statInfo.st_size <= SIZE_MAX)
+        {
+            void * data = mmap(nullptr, (size_t)statInfo.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                _data = data;
+                _length = (size_t)statInfo.st_size;
+                _mapped = true;
+            }
+        }
+        // The mapping stays valid after the descriptor is closed
+        close(fd);
+        if (_mapped)
+        {
+            return;
+        }
+    }
+#endif
+
+    // Mapping is not available, read the file instead
+    size_t length;
+    _data = File::ReadAllBytes(path, &length);
+    _length = length;
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    if (_mapped)
+    {
+#if defined(_WIN32)
+        UnmapViewOfFile(_data);
+        CloseHandle((HANDLE)_hMapping);
+        CloseHandle((HANDLE)_hFile);
+#elif defined(MEMORY_MAPPED_FILE_USE_MMAP)
+        munmap((void *)_data, _length);
+#endif
+    }
+    else
+    {
+        Memory::Free((void *)_data);
+    }
+}
@@ -0,0 +1,99 @@
+#pragma region Copyright (c) 2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#pragma once
+
+#include <utility>
+#include <vector>
+#include "../common.h"
+
+/**
+ * A double ended queue stored in a single growable array. Unlike std::list and std::deque, no
+ * allocation takes place once the buffer has grown to the largest number of items it has held.
+ */
+template<typename T>
+class RingBuffer final
+{
+private:
+    std::vector<T>  _items;
+    size_t          _head = 0;
+    size_t          _count = 0;
+
+public:
+    bool empty() const { return _count == 0; }
+    size_t size() const { return _count; }
+
+    T & front() { return _items[_head]; }
+    const T & front() const { return _items[_head]; }
+    T & back() { return (*this)[_count - 1]; }
+
+    T & operator[](size_t index) { return _items[(_head + index) & (_items.size() - 1)]; }
+    const T & operator[](size_t index) const { return _items[(_head + index) & (_items.size() - 1)]; }
+
+    void push_back(T item)
+    {
+        Reserve(_count + 1);
+        _items[(_head + _count) & (_items.size() - 1)] = std::move(item);
+        _count++;
+    }
+
+    void push_front(T item)
+    {
+        Reserve(_count + 1);
+        _head = (_head - 1) & (_items.size() - 1);
+        _items[_head] = std::move(item);
+        _count++;
+    }
+
+    void pop_front()
+    {
+        _items[_head] = T();
+        _head = (_head + 1) & (_items.size() - 1);
+        _count--;
+    }
+
+    void clear()
+    {
+        while (!empty())
+        {
+            pop_front();
+        }
+        _head = 0;
+    }
+
+private:
+    void Reserve(size_t count)
+    {
+        if (count <= _items.size())
+        {
+            return;
+        }
+
+        // Capacity is always a power of two so that indices wrap with a mask
+        size_t capacity = _items.empty() ? 8 : _items.size() * 2;
+        while (capacity < count)
+        {
+            capacity *= 2;
+        }
+        std::vector<T> items(capacity);
+        for (size_t i = 0; i < _count; i++)
+        {
+            items[i] = std::move((*this)[i]);
+        }
+        _items = std::move(items);
+        _head = 0;
+    }
+};
@@ -0,0 +1,95 @@
+#pragma region Copyright (c) 2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include "../common.h"
+
+/**
+ * A fixed size queue that one thread pushes to and one other thread pops from without locking.
+ */
+template<typename T>
+class SpscQueue final
+{
+private:
+    std::vector<T>      _items;
+    const size_t        _mask;
+    // Written only by the consumer and the producer respectively
+    std::atomic<size_t> _head = { 0 };
+    std::atomic<size_t> _tail = { 0 };
+
+public:
+    /**
+     * @param capacity The number of items the queue can hold, rounded up to a power of two.
+     */
+    explicit SpscQueue(size_t capacity)
+        : _items(RoundUpToPowerOfTwo(capacity)),
+          _mask(_items.size() - 1)
+    {
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue & operator=(const SpscQueue &) = delete;
+
+    /**
+     * Called by the producer. Returns false and leaves item untouched if the queue is full.
+     */
+    bool TryPush(T &item)
+    {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head.load(std::memory_order_acquire) == _items.size())
+        {
+            return false;
+        }
+        _items[tail & _mask] = std::move(item);
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Called by the consumer. Returns false if the queue is empty.
+     */
+    bool TryPop(T &item)
+    {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        item = std::move(_items[head & _mask]);
+        _items[head & _mask] = T();
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool IsEmpty() const
+    {
+        return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+    }
+
+private:
+    static size_t RoundUpToPowerOfTwo(size_t value)
+    {
+        size_t result = 1;
+        while (result < value)
+        {
+            result *= 2;
+        }
+        return result;
+    }
+};
@@ -0,0 +1,73 @@
+#pragma region Copyright (c) 2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#pragma once
+
+#include "../common.h"
+
+/**
+ * Variable-length integer encoding: seven bits per byte, least significant group first, with the top bit
+ * set on every byte except the last. Signed values are zigzag mapped first so small negatives stay short.
+ */
+namespace VarInt
+{
+    constexpr size_t MAX_LENGTH = 5;
+
+    inline uint32 ZigZagEncode(sint32 value)
+    {
+        return ((uint32)value << 1) ^ (uint32)(value >> 31);
+    }
+
+    inline sint32 ZigZagDecode(uint32 value)
+    {
+        return (sint32)(value >> 1) ^ -(sint32)(value & 1);
+    }
+
+    /**
+     * Writes the value to buffer, which must hold at least MAX_LENGTH bytes.
+     * @returns the number of bytes written.
+     */
+    inline size_t Encode(uint32 value, uint8 * buffer)
+    {
+        size_t length = 0;
+        while (value >= 0x80)
+        {
+            buffer[length++] = (uint8)(value | 0x80);
+            value >>= 7;
+        }
+        buffer[length++] = (uint8)value;
+        return length;
+    }
+
+    /**
+     * Reads a value from the first length bytes of data.
+     * @returns the number of bytes read, or 0 if the data is truncated or the value is too long.
+     */
+    inline size_t Decode(const uint8 * data, size_t length, uint32 * value)
+    {
+        uint32 result = 0;
+        for (size_t i = 0; i < length && i < MAX_LENGTH; i++)
+        {
+            result |= (uint32)(data[i] & 0x7F) << (7 * i);
+            if (!(data[i] & 0x80))
+            {
+                *value = result;
+                return i + 1;
+            }
+        }
+        return 0;
+    }
+}
@@ -320,7 +320,10 @@ const rct_g1_element * gfx_get_g1_element(sint32 image_id);
 void gfx_set_g1_element(sint32 imageId, const rct_g1_element * g1);
 bool is_csg_loaded();
 uint32 gfx_object_allocate_images(const rct_g1_element * images, uint32 count);
+uint32 gfx_object_allocate_lazy_images(class ImageTable * imageTable);
 void gfx_object_free_images(uint32 baseImageId, uint32 count);
+bool gfx_object_ensure_image_loaded(uint32 imageId);
+void gfx_object_trim_images();
 void gfx_object_check_all_images_freed();
 void FASTCALL gfx_bmp_sprite_to_buffer(const uint8* palette_pointer, uint8* unknown_pointer, uint8* source_pointer, uint8* dest_pointer, const rct_g1_element* source_image, rct_drawpixelinfo *dest_dpi, sint32 height, sint32 width, sint32 image_type);
 void FASTCALL gfx_rle_sprite_to_buffer(const uint8* RESTRICT source_bits_pointer, uint8* RESTRICT dest_bits_pointer, const uint8* RESTRICT palette_pointer, const rct_drawpixelinfo * RESTRICT dpi, sint32 image_type, sint32 source_y_start, sint32 height, sint32 source_x_start, sint32 width);
@@ -16,8 +16,10 @@
 
 #include <algorithm>
 #include <list>
+#include <vector>
 #include "../core/Console.hpp"
 #include "../core/Guard.hpp"
+#include "../object/ImageTable.h"
 #include "../OpenRCT2.h"
 
 #include "Drawing.h"
@@ -26,16 +28,34 @@ constexpr uint32 BASE_IMAGE_ID = 29294;
 constexpr uint32 MAX_IMAGES = 262144;
 constexpr uint32 INVALID_IMAGE_ID = UINT32_MAX;
 
+// Image data of lazily loaded objects that is kept in memory before unused tables are unloaded
+constexpr size_t MAX_LAZY_IMAGE_DATA_SIZE = 64 * 1024 * 1024;
+
 struct ImageList
 {
     uint32 BaseId;
     uint32 Count;
 };
 
+struct LazyImageList
+{
+    ImageTable *    Table;
+    uint32          BaseId;
+    uint32          Count;
+    uint32          LastUsedFrame;
+};
+
 static bool                 _initialised = false;
 static std::list<ImageList> _freeLists;
 static uint32               _allocatedImageCount;
 
+// Slot 0 is unused, so an owner of 0 means the image is not loaded lazily
+static std::vector<LazyImageList>   _lazyImageLists(1);
+static std::vector<uint16>          _lazyImageListFreeSlots;
+static std::vector<uint16>          _lazyImageOwners;
+static size_t                       _lazyImageDataSize;
+static uint32                       _lazyImageFrame;
+
 #ifdef DEBUG
 static std::list<ImageList> _allocatedLists;
 
@@ -226,10 +246,148 @@ uint32 gfx_object_allocate_images(const rct_g1_element * images, uint32 count)
     return baseImageId;
 }
 
+uint32 gfx_object_allocate_lazy_images(ImageTable * imageTable)
+{
+    uint32 count = imageTable->GetCount();
+    uint32 baseImageId = gfx_object_allocate_images(imageTable->GetImages(), count);
+    if (baseImageId == INVALID_IMAGE_ID)
+    {
+        return INVALID_IMAGE_ID;
+    }
+
+    uint16 slot;
+    if (_lazyImageListFreeSlots.empty())
+    {
+        slot = (uint16)_lazyImageLists.size();
+        _lazyImageLists.push_back({});
+    }
+    else
+    {
+        slot = _lazyImageListFreeSlots.back();
+        _lazyImageListFreeSlots.pop_back();
+    }
+    _lazyImageLists[slot] = { imageTable, baseImageId, count, _lazyImageFrame };
+
+    if (_lazyImageOwners.empty())
+    {
+        _lazyImageOwners.resize(MAX_IMAGES);
+    }
+    std::fill_n(_lazyImageOwners.begin() + (baseImageId - BASE_IMAGE_ID), count, slot);
+    if (imageTable->IsLoaded())
+    {
+        _lazyImageDataSize += imageTable->GetDataSize();
+    }
+    return baseImageId;
+}
+
+static uint16 GetLazyImageListSlot(uint32 imageId)
+{
+    if (imageId < BASE_IMAGE_ID || imageId >= BASE_IMAGE_ID + MAX_IMAGES || _lazyImageOwners.empty())
+    {
+        return 0;
+    }
+    return _lazyImageOwners[imageId - BASE_IMAGE_ID];
+}
+
+static void SetLazyImageListElements(const LazyImageList &imageList)
+{
+    const rct_g1_element * images = imageList.Table->GetImages();
+    for (uint32 i = 0; i < imageList.Count; i++)
+    {
+        gfx_set_g1_element(imageList.BaseId + i, &images[i]);
+    }
+}
+
+/**
+ * Loads the image data of the object owning the given image if it is not in memory yet.
+ * @returns false if the data could not be loaded.
+ */
+bool gfx_object_ensure_image_loaded(uint32 imageId)
+{
+    uint16 slot = GetLazyImageListSlot(imageId);
+    if (slot == 0)
+    {
+        return true;
+    }
+
+    LazyImageList &imageList = _lazyImageLists[slot];
+    imageList.LastUsedFrame = _lazyImageFrame;
+    if (imageList.Table->IsLoaded())
+    {
+        return true;
+    }
+    if (!imageList.Table->Load())
+    {
+        return false;
+    }
+    _lazyImageDataSize += imageList.Table->GetDataSize();
+    SetLazyImageListElements(imageList);
+    return true;
+}
+
+/**
+ * Unloads the image data of the least recently drawn objects until the loaded data is within the
+ * limit. Must only be called between frames, as the images being unloaded become invalid.
+ */
+void gfx_object_trim_images()
+{
+    _lazyImageFrame++;
+    if (_lazyImageDataSize <= MAX_LAZY_IMAGE_DATA_SIZE)
+    {
+        return;
+    }
+
+    std::vector<uint16> candidates;
+    for (size_t slot = 1; slot < _lazyImageLists.size(); slot++)
+    {
+        const LazyImageList &imageList = _lazyImageLists[slot];
+        // Keep everything drawn in the last frame
+        if (imageList.Table != nullptr && imageList.Table->IsLoaded() &&
+            imageList.LastUsedFrame + 1 < _lazyImageFrame)
+        {
+            candidates.push_back((uint16)slot);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](uint16 a, uint16 b) -> bool
+    {
+        return _lazyImageLists[a].LastUsedFrame < _lazyImageLists[b].LastUsedFrame;
+    });
+
+    for (uint16 slot : candidates)
+    {
+        if (_lazyImageDataSize <= MAX_LAZY_IMAGE_DATA_SIZE)
+        {
+            break;
+        }
+
+        const LazyImageList &imageList = _lazyImageLists[slot];
+        _lazyImageDataSize -= imageList.Table->GetDataSize();
+        imageList.Table->Unload();
+        SetLazyImageListElements(imageList);
+        for (uint32 i = 0; i < imageList.Count; i++)
+        {
+            drawing_engine_invalidate_image(imageList.BaseId + i);
+        }
+    }
+}
+
 void gfx_object_free_images(uint32 baseImageId, uint32 count)
 {
     if (baseImageId != 0 && baseImageId != INVALID_IMAGE_ID)
     {
+        uint16 slot = GetLazyImageListSlot(baseImageId);
+        if (slot != 0)
+        {
+            LazyImageList &imageList = _lazyImageLists[slot];
+            if (imageList.Table->IsLoaded())
+            {
+                _lazyImageDataSize -= imageList.Table->GetDataSize();
+            }
+            std::fill_n(_lazyImageOwners.begin() + (baseImageId - BASE_IMAGE_ID), count, 0);
+            imageList = {};
+            _lazyImageListFreeSlots.push_back(slot);
+        }
+
         // Zero the G1 elements so we don't have invalid pointers
         // and data lying about
         for (uint32 i = 0; i < count; i++)
@@ -165,6 +165,7 @@ void drawing_engine_draw()
 {
     if (_drawingEngine != nullptr && _painter != nullptr)
     {
+        gfx_object_trim_images();
         _drawingEngine->BeginDraw();
         _painter->Paint(_drawingEngine);
         _drawingEngine->EndDraw();
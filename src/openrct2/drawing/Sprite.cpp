@@ -21,6 +21,8 @@
 #include "../config/Config.h"
 #include "../Context.h"
 #include "../core/FileStream.hpp"
+#include "../core/MemoryMappedFile.h"
+#include "../core/MemoryStream.h"
 #include "../core/Path.hpp"
 #include "../OpenRCT2.h"
 #include "../platform/platform.h"
@@ -54,6 +56,8 @@ struct rct_gx
     rct_g1_header header;
     std::vector<rct_g1_element> elements;
     void * data;
+    // Set when the pixel data is used in place from the mapped file rather than read into data
+    std::unique_ptr<MemoryMappedFile> mappedFile;
 };
 
 constexpr struct
@@ -223,6 +227,49 @@ static std::string gfx_get_csg_data_path()
     return path;
 }
 
+/**
+ * Opens a graphics file for reading its element headers. When built with USE_MMAP the file is mapped
+ * instead of read so that its pixel data can later be used in place by gfx_read_gx_data.
+ */
+static std::unique_ptr<IStream> gfx_open_gx(rct_gx * gx, const std::string &path)
+{
+#ifdef USE_MMAP
+    gx->mappedFile = std::make_unique<MemoryMappedFile>(path);
+    return std::make_unique<MemoryStream>(gx->mappedFile->GetData(), gx->mappedFile->GetLength());
+#else
+    return std::make_unique<FileStream>(path, FILE_MODE_OPEN);
+#endif
+}
+
+/**
+ * Gets the pixel data of a graphics file, which starts at the current position of the stream. Pixel data
+ * of a mapped file is not copied, so every process using the same file shares the pages holding it.
+ */
+static uint8 * gfx_read_gx_data(rct_gx * gx, IStream * stream)
+{
+    if (gx->mappedFile != nullptr)
+    {
+        uint64 position = stream->GetPosition();
+        if (position + gx->header.total_size > gx->mappedFile->GetLength())
+        {
+            throw IOException("Graphics data is truncated.");
+        }
+        gx->data = nullptr;
+        return (uint8 *)gx->mappedFile->GetData() + position;
+    }
+
+    gx->data = stream->ReadArray<uint8>(gx->header.total_size);
+    return (uint8 *)gx->data;
+}
+
+static void gfx_unload_gx(rct_gx * gx)
+{
+    SafeFree(gx->data);
+    gx->mappedFile = nullptr;
+    gx->elements.clear();
+    gx->elements.shrink_to_fit();
+}
+
 static rct_gx   _g1 = { 0 };
 static rct_gx   _g2 = { 0 };
 static rct_gx   _csg = { 0 };
@@ -243,8 +290,8 @@ bool gfx_load_g1(void * platformEnvironment)
     try
     {
         auto path = Path::Combine(env->GetDirectoryPath(DIRBASE::RCT2, DIRID::DATA), "g1.dat");
-        auto fs = FileStream(path, FILE_MODE_OPEN);
-        _g1.header = fs.ReadValue<rct_g1_header>();
+        auto fs = gfx_open_gx(&_g1, path);
+        _g1.header = fs->ReadValue<rct_g1_header>();
 
         log_verbose("g1.dat, number of entries: %u", _g1.header.num_entries);
 
@@ -256,23 +303,22 @@ bool gfx_load_g1(void * platformEnvironment)
         // Read element headers
         _g1.elements.resize(324206);
         bool is_rctc = _g1.header.num_entries == SPR_RCTC_G1_END;
-        read_and_convert_gxdat(&fs, _g1.header.num_entries, is_rctc, _g1.elements.data());
+        read_and_convert_gxdat(fs.get(), _g1.header.num_entries, is_rctc, _g1.elements.data());
         gTinyFontAntiAliased = is_rctc;
 
         // Read element data
-        _g1.data = fs.ReadArray<uint8>(_g1.header.total_size);
+        uint8 * data = gfx_read_gx_data(&_g1, fs.get());
 
         // Fix entry data offsets
         for (uint32 i = 0; i < _g1.header.num_entries; i++)
         {
-            _g1.elements[i].offset += (uintptr_t)_g1.data;
+            _g1.elements[i].offset += (uintptr_t)data;
         }
         return true;
     }
     catch (const std::exception &)
     {
-        _g1.elements.clear();
-        _g1.elements.shrink_to_fit();
+        gfx_unload_gx(&_g1);
 
         log_fatal("Unable to load g1 graphics");
         if (!gOpenRCT2Headless)
@@ -286,23 +332,17 @@ bool gfx_load_g1(void * platformEnvironment)
 
 void gfx_unload_g1()
 {
-    SafeFree(_g1.data);
-    _g1.elements.clear();
-    _g1.elements.shrink_to_fit();
+    gfx_unload_gx(&_g1);
 }
 
 void gfx_unload_g2()
 {
-    SafeFree(_g2.data);
-    _g2.elements.clear();
-    _g2.elements.shrink_to_fit();
+    gfx_unload_gx(&_g2);
 }
 
 void gfx_unload_csg()
 {
-    SafeFree(_csg.data);
-    _csg.elements.clear();
-    _csg.elements.shrink_to_fit();
+    gfx_unload_gx(&_csg);
 }
 
 bool gfx_load_g2()
@@ -317,27 +357,26 @@ bool gfx_load_g2()
     printf("%s\n", path);
     try
     {
-        auto fs = FileStream(path, FILE_MODE_OPEN);
-        _g2.header = fs.ReadValue<rct_g1_header>();
+        auto fs = gfx_open_gx(&_g2, path);
+        _g2.header = fs->ReadValue<rct_g1_header>();
 
         // Read element headers
         _g2.elements.resize(_g2.header.num_entries);
-        read_and_convert_gxdat(&fs, _g2.header.num_entries, false, _g2.elements.data());
+        read_and_convert_gxdat(fs.get(), _g2.header.num_entries, false, _g2.elements.data());
 
         // Read element data
-        _g2.data = fs.ReadArray<uint8>(_g2.header.total_size);
+        uint8 * data = gfx_read_gx_data(&_g2, fs.get());
 
         // Fix entry data offsets
         for (uint32 i = 0; i < _g2.header.num_entries; i++)
         {
-            _g2.elements[i].offset += (uintptr_t)_g2.data;
+            _g2.elements[i].offset += (uintptr_t)data;
         }
         return true;
     }
     catch (const std::exception &)
     {
-        _g2.elements.clear();
-        _g2.elements.shrink_to_fit();
+        gfx_unload_gx(&_g2);
 
         log_fatal("Unable to load g2 graphics %s", path);
         if (!gOpenRCT2Headless)
@@ -364,9 +403,9 @@ bool gfx_load_csg()
     try
     {
         auto fileHeader = FileStream(pathHeaderPath, FILE_MODE_OPEN);
-        auto fileData = FileStream(pathDataPath, FILE_MODE_OPEN);
+        auto fileData = gfx_open_gx(&_csg, pathDataPath);
         size_t fileHeaderSize = fileHeader.GetLength();
-        size_t fileDataSize = fileData.GetLength();
+        size_t fileDataSize = fileData->GetLength();
 
         _csg.header.num_entries = (uint32)(fileHeaderSize / sizeof(rct_g1_element_32bit));
         _csg.header.total_size = (uint32)fileDataSize;
@@ -374,6 +413,7 @@ bool gfx_load_csg()
         if (_csg.header.num_entries < 69917)
         {
             log_warning("Cannot load CSG1.DAT, it has too few entries. Only CSG1.DAT from Loopy Landscapes will work.");
+            gfx_unload_gx(&_csg);
             return false;
         }
 
@@ -382,12 +422,12 @@ bool gfx_load_csg()
         read_and_convert_gxdat(&fileHeader, _csg.header.num_entries, false, _csg.elements.data());
 
         // Read element data
-        _csg.data = fileData.ReadArray<uint8>(_csg.header.total_size);
+        uint8 * data = gfx_read_gx_data(&_csg, fileData.get());
 
         // Fix entry data offsets
         for (uint32 i = 0; i < _csg.header.num_entries; i++)
         {
-            _csg.elements[i].offset += (uintptr_t)_csg.data;
+            _csg.elements[i].offset += (uintptr_t)data;
             // RCT1 used zoomed offsets that counted from the beginning of the file, rather than from the current sprite.
             _csg.elements[i].zoomed_offset = i - (SPR_CSG_BEGIN + _csg.elements[i].zoomed_offset);
         }
@@ -396,8 +436,7 @@ bool gfx_load_csg()
     }
     catch (const std::exception &)
     {
-        _csg.elements.clear();
-        _csg.elements.shrink_to_fit();
+        gfx_unload_gx(&_csg);
 
         log_error("Unable to load csg graphics");
         return false;
@@ -803,6 +842,10 @@ const rct_g1_element * gfx_get_g1_element(sint32 image_id)
         {
             return nullptr;
         }
+        if (!gfx_object_ensure_image_loaded(image_id))
+        {
+            return nullptr;
+        }
         return &_g1.elements[image_id];
     }
     if (image_id < SPR_CSG_BEGIN)
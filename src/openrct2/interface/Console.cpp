@@ -23,6 +23,7 @@
 #include "../Context.h"
 #include "../core/Guard.hpp"
 #include "../core/Math.hpp"
+#include "../core/Path.hpp"
 #include "../core/String.hpp"
 #include "../core/Util.hpp"
 #include "../drawing/Drawing.h"
@@ -44,8 +45,10 @@
 #include "../object/ObjectManager.h"
 #include "../object/ObjectRepository.h"
 #include "../OpenRCT2.h"
+#include "../PlatformEnvironment.h"
 #include "../peep/Staff.h"
 #include "../platform/platform.h"
+#include "../Replay.h"
 #include "../ride/Ride.h"
 #include "../ride/RideData.h"
 #include "../util/SawyerCoding.h"
@@ -1313,6 +1316,61 @@ static sint32 cc_show_limits(const utf8 ** argv, sint32 argc)
     return 0;
 }
 
+static sint32 cc_record_start(const utf8 ** argv, sint32 argc)
+{
+    if (replay_is_recording())
+    {
+        console_writeline_error("Already recording.");
+    }
+    else if (!replay_start_recording())
+    {
+        console_writeline_error("Unable to start recording.");
+    }
+    else
+    {
+        console_printf("Recording started at tick %u.", gCurrentTicks);
+    }
+    return 0;
+}
+
+static sint32 cc_record_stop(const utf8 ** argv, sint32 argc)
+{
+    if (!replay_is_recording())
+    {
+        console_writeline_error("Not recording.");
+        return 0;
+    }
+
+    auto env = OpenRCT2::GetContext()->GetPlatformEnvironment();
+    auto directory = env->GetDirectoryPath(OpenRCT2::DIRBASE::USER, OpenRCT2::DIRID::REPLAY);
+    platform_ensure_directory_exists(directory.c_str());
+    std::string name = argc > 0 ? argv[0] : "session";
+    auto path = Path::Combine(directory, name + ".replay");
+    if (replay_stop_recording(path))
+    {
+        console_printf("Recording saved to %s", path.c_str());
+    }
+    else
+    {
+        console_writeline_error("Unable to save recording.");
+    }
+    return 0;
+}
+
+static sint32 cc_network_stats(const utf8 ** argv, sint32 argc)
+{
+    auto lines = network_get_stats_summary();
+    if (lines.empty())
+    {
+        console_writeline("No network connections.");
+    }
+    for (const auto &line : lines)
+    {
+        console_writeline(line.c_str());
+    }
+    return 0;
+}
+
 static sint32 cc_for_date(const utf8 **argv, sint32 argc)
 {
     sint32 year = 0;
@@ -1447,7 +1505,10 @@ static constexpr const console_command console_command_table[] = {
     { "remove_unused_objects", cc_remove_unused_objects, "Removes all the unused objects from the object selection.", "remove_unused_objects" },
     { "remove_park_fences", cc_remove_park_fences, "Removes all park fences from the surface", "remove_park_fences"},
     { "show_limits", cc_show_limits, "Shows the map data counts and limits.", "show_limits" },
-    { "date", cc_for_date, "Sets the date to a given date.", "Format <year>[ <month>[ <day>]]."}
+    { "date", cc_for_date, "Sets the date to a given date.", "Format <year>[ <month>[ <day>]]."},
+    { "record_start", cc_record_start, "Starts recording every game command, to replay the session with the 'replay' command line command.", "record_start" },
+    { "record_stop", cc_record_stop, "Stops recording and saves the recording in the replay directory.", "record_stop [name]" },
+    { "network_stats", cc_network_stats, "Shows the traffic, queue depth and round trip times of each network connection.", "network_stats" },
 };
 
 static sint32 cc_windows(const utf8 **argv, sint32 argc) {
@@ -15,6 +15,7 @@
 #pragma endregion
 
 #include <algorithm>
+#include <vector>
 #include "../config/Config.h"
 #include "../Context.h"
 #include "../core/Math.hpp"
@@ -59,6 +60,23 @@ paint_entry *gNextFreePaintStruct;
 uint8 gCurrentRotation;
 uint32 gCurrentViewportFlags = 0;
 
+struct viewport_invalidation_rect
+{
+    sint32 left, top, right, bottom;
+};
+
+#define VIEWPORT_INVALIDATION_ZOOM_LEVELS 4
+
+// While the game is being updated, the viewports do not move. Invalidations are then tested against
+// the area all viewports of a given zoom level cover, and the rest is collected per viewport.
+static bool _invalidationBatchActive = false;
+static bool _invalidationAreaValid[VIEWPORT_INVALIDATION_ZOOM_LEVELS];
+static viewport_invalidation_rect _invalidationArea[VIEWPORT_INVALIDATION_ZOOM_LEVELS];
+static std::vector<viewport_invalidation_rect> _invalidationBatch[MAX_VIEWPORT_COUNT];
+
+static bool viewport_is_visible_for_invalidation(rct_viewport * viewport);
+static void viewport_invalidate_visible(rct_viewport * viewport, sint32 left, sint32 top, sint32 right, sint32 bottom);
+
 static uint32 _currentImageType;
 
 static rct_drawpixelinfo _viewportDpi1;
@@ -1557,6 +1575,14 @@ void get_map_coordinates_from_pos_window(rct_window * window, sint32 screenX, si
  * Left, top, right and bottom represent 2D map coordinates at zoom 0.
  */
 void viewport_invalidate(rct_viewport *viewport, sint32 left, sint32 top, sint32 right, sint32 bottom)
+{
+    if (viewport_is_visible_for_invalidation(viewport))
+    {
+        viewport_invalidate_visible(viewport, left, top, right, bottom);
+    }
+}
+
+static bool viewport_is_visible_for_invalidation(rct_viewport * viewport)
 {
     // if unknown viewport visibility, use the containing window to discover the status
     if (viewport->visibility == VC_UNKNOWN)
@@ -1567,14 +1593,17 @@ void viewport_invalidate(rct_viewport *viewport, sint32 left, sint32 top, sint32
             {
                 // note, window_is_visible will update viewport->visibility, so this should have a low hit count
                 if (!window_is_visible(w)) {
-                    return;
+                    return false;
                 }
             }
         }
     }
 
-    if (viewport->visibility == VC_COVERED) return;
+    return viewport->visibility != VC_COVERED;
+}
 
+static void viewport_invalidate_visible(rct_viewport * viewport, sint32 left, sint32 top, sint32 right, sint32 bottom)
+{
     sint32 viewportLeft = viewport->view_x;
     sint32 viewportTop = viewport->view_y;
     sint32 viewportRight = viewport->view_x + viewport->view_width;
@@ -1602,6 +1631,124 @@ void viewport_invalidate(rct_viewport *viewport, sint32 left, sint32 top, sint32
     }
 }
 
+/**
+ * Invalidates the given area in screen space on all viewports at or below the given zoom level.
+ * @param maxZoom The highest zoom level to invalidate, or -1 for all.
+ */
+void viewports_invalidate(sint32 left, sint32 top, sint32 right, sint32 bottom, sint32 maxZoom)
+{
+    if (maxZoom == -1 || maxZoom >= VIEWPORT_INVALIDATION_ZOOM_LEVELS)
+    {
+        maxZoom = VIEWPORT_INVALIDATION_ZOOM_LEVELS - 1;
+    }
+
+    if (_invalidationBatchActive)
+    {
+        // Reject anything that is not near any viewport with one test
+        if (!_invalidationAreaValid[maxZoom])
+            return;
+
+        const viewport_invalidation_rect &area = _invalidationArea[maxZoom];
+        if (right <= area.left || left >= area.right || bottom <= area.top || top >= area.bottom)
+            return;
+    }
+
+    for (sint32 i = 0; i < MAX_VIEWPORT_COUNT; i++)
+    {
+        rct_viewport * viewport = &g_viewport_list[i];
+        if (viewport->width == 0 || viewport->zoom > maxZoom)
+            continue;
+
+        if (_invalidationBatchActive)
+        {
+            if (right <= viewport->view_x || left >= viewport->view_x + viewport->view_width ||
+                bottom <= viewport->view_y || top >= viewport->view_y + viewport->view_height)
+            {
+                continue;
+            }
+            _invalidationBatch[i].push_back({ left, top, right, bottom });
+        }
+        else
+        {
+            viewport_invalidate(viewport, left, top, right, bottom);
+        }
+    }
+}
+
+/**
+ * Starts collecting invalidations until viewport_invalidation_end_batch is called. The viewports
+ * must not move or change zoom in between.
+ */
+void viewport_invalidation_begin_batch()
+{
+    if (gOpenRCT2Headless)
+        return;
+
+    for (sint32 zoom = 0; zoom < VIEWPORT_INVALIDATION_ZOOM_LEVELS; zoom++)
+    {
+        _invalidationAreaValid[zoom] = false;
+    }
+
+    for (sint32 i = 0; i < MAX_VIEWPORT_COUNT; i++)
+    {
+        const rct_viewport * viewport = &g_viewport_list[i];
+        if (viewport->width == 0)
+            continue;
+
+        viewport_invalidation_rect viewRect = {
+            viewport->view_x,
+            viewport->view_y,
+            viewport->view_x + viewport->view_width,
+            viewport->view_y + viewport->view_height
+        };
+        for (sint32 zoom = viewport->zoom; zoom < VIEWPORT_INVALIDATION_ZOOM_LEVELS; zoom++)
+        {
+            viewport_invalidation_rect &area = _invalidationArea[zoom];
+            if (!_invalidationAreaValid[zoom])
+            {
+                area = viewRect;
+                _invalidationAreaValid[zoom] = true;
+            }
+            else
+            {
+                area.left = std::min(area.left, viewRect.left);
+                area.top = std::min(area.top, viewRect.top);
+                area.right = std::max(area.right, viewRect.right);
+                area.bottom = std::max(area.bottom, viewRect.bottom);
+            }
+        }
+    }
+    _invalidationBatchActive = true;
+}
+
+/**
+ * Marks everything collected since viewport_invalidation_begin_batch as dirty.
+ */
+void viewport_invalidation_end_batch()
+{
+    if (!_invalidationBatchActive)
+        return;
+
+    _invalidationBatchActive = false;
+    for (sint32 i = 0; i < MAX_VIEWPORT_COUNT; i++)
+    {
+        std::vector<viewport_invalidation_rect> &batch = _invalidationBatch[i];
+        if (batch.empty())
+            continue;
+
+        // The viewport may have been closed in the meantime
+        rct_viewport * viewport = &g_viewport_list[i];
+        if (viewport->width != 0 && viewport_is_visible_for_invalidation(viewport))
+        {
+            for (const auto &rect : batch)
+            {
+                viewport_invalidate_visible(viewport, rect.left, rect.top, rect.right, rect.bottom);
+            }
+        }
+        batch.clear();
+    }
+}
+
 static rct_viewport *viewport_find_from_point(sint32 screenX, sint32 screenY)
 {
     rct_window *w = window_find_from_point(screenX, screenY);
@@ -163,6 +163,9 @@ void sub_68B2B7(paint_session * session, sint32 x, sint32 y);
 void sub_68862C(rct_drawpixelinfo * dpi, paint_struct * ps);
 
 void viewport_invalidate(rct_viewport *viewport, sint32 left, sint32 top, sint32 right, sint32 bottom);
+void viewports_invalidate(sint32 left, sint32 top, sint32 right, sint32 bottom, sint32 maxZoom = -1);
+void viewport_invalidation_begin_batch();
+void viewport_invalidation_end_batch();
 
 void screen_get_map_xy(sint32 screenX, sint32 screenY, sint16 *x, sint16 *y, rct_viewport **viewport);
 void screen_get_map_xy_with_z(sint16 screenX, sint16 screenY, sint16 z, sint16 *mapX, sint16 *mapY);
@@ -33,7 +33,7 @@
 // This string specifies which version of network stream current build uses.
 // It is used for making sure only compatible builds get connected, even within
 // single OpenRCT2 version.
-#define NETWORK_STREAM_VERSION "43"
+#define NETWORK_STREAM_VERSION "47"
 #define NETWORK_STREAM_ID OPENRCT2_VERSION "-" NETWORK_STREAM_VERSION
 
 static rct_peep* _pickup_peep = nullptr;
@@ -72,6 +72,7 @@ static sint32 _pickup_peep_old_x = LOCATION_NULL;
 #include "../Cheats.h"
 
 #include "NetworkAction.h"
+#include "NetworkBatch.h"
 
 #include <openssl/evp.h> // just for OpenSSL_add_all_algorithms()
 
@@ -118,6 +119,7 @@ Network::Network()
     client_command_handlers[NETWORK_COMMAND_GAMEINFO] = &Network::Client_Handle_GAMEINFO;
     client_command_handlers[NETWORK_COMMAND_TOKEN] = &Network::Client_Handle_TOKEN;
     client_command_handlers[NETWORK_COMMAND_OBJECTS] = &Network::Client_Handle_OBJECTS;
+    client_command_handlers[NETWORK_COMMAND_BATCH] = &Network::Client_Handle_BATCH;
     server_command_handlers.resize(NETWORK_COMMAND_MAX, nullptr);
     server_command_handlers[NETWORK_COMMAND_AUTH] = &Network::Server_Handle_AUTH;
     server_command_handlers[NETWORK_COMMAND_CHAT] = &Network::Server_Handle_CHAT;
@@ -179,9 +181,13 @@ void Network::Close()
     }
 
     if (mode == NETWORK_MODE_CLIENT) {
+        _relay = nullptr;
         delete server_connection->Socket;
         server_connection->Socket = nullptr;
     } else if (mode == NETWORK_MODE_SERVER) {
+        // Stop the I/O thread before the connections it services are deleted
+        _ioThread = nullptr;
+        _statsEndpoint = nullptr;
         delete listening_socket;
         listening_socket = nullptr;
         delete _advertiser;
@@ -201,6 +207,10 @@ void Network::Close()
 
     client_connection_list.clear();
     game_command_queue.clear();
+    _broadcastCommandTicks.Reset();
+    _desyncRecording.Clear();
+    _stateDigests.Clear();
+    _serverStateDigests.Clear();
     player_list.clear();
     group_list.clear();
 
@@ -298,6 +308,20 @@ bool Network::BeginClient(const char* host, uint16 port)
     return true;
 }
 
+bool Network::BeginRelay(const char* host, uint16 port, uint16 relayPort, const char* relayAddress)
+{
+    if (!BeginClient(host, port)) {
+        return false;
+    }
+
+    _relay = std::make_unique<NetworkRelay>(*this);
+    if (!_relay->Begin(relayPort, relayAddress)) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
 bool Network::BeginServer(uint16 port, const char* address)
 {
     Close();
@@ -326,6 +350,17 @@ bool Network::BeginServer(uint16 port, const char* address)
         return false;
     }
 
+    _ioThread = std::make_unique<NetworkIOThread>();
+
+    if (gConfigNetwork.stats_port > 0)
+    {
+        _statsEndpoint = std::make_unique<NetworkStatsEndpoint>();
+        if (!_statsEndpoint->Begin((uint16)gConfigNetwork.stats_port))
+        {
+            _statsEndpoint = nullptr;
+        }
+    }
+
     ServerName = String::ToStd(gConfigNetwork.server_name);
     ServerDescription = String::ToStd(gConfigNetwork.server_description);
     ServerGreeting = String::ToStd(gConfigNetwork.server_greeting);
@@ -410,8 +445,14 @@ void Network::Update()
         break;
     case NETWORK_MODE_CLIENT:
         UpdateClient();
+        if (_relay != nullptr) {
+            _relay->Update();
+        }
         break;
     }
+    if (GetMode() != NETWORK_MODE_NONE) {
+        UpdateStats();
+    }
 
     // If the Close() was called during the update, close it for real
     _closeLock = false;
@@ -420,6 +461,121 @@ void Network::Update()
     }
 }
 
+void Network::UpdateStats()
+{
+    auto getStats = [this]() -> std::string
+    {
+        json_t * jsonStats = GetStatsJson();
+        char * text = json_dumps(jsonStats, JSON_COMPACT);
+        json_decref(jsonStats);
+        std::string result = text != nullptr ? text : "{}";
+        free(text);
+        return result;
+    };
+
+    if (_statsEndpoint != nullptr) {
+        _statsEndpoint->Update(getStats);
+    }
+
+    uint32 ticks = platform_get_ticks();
+    if (_lastStatsLogTime == 0) {
+        _lastStatsLogTime = ticks;
+    }
+    if (gConfigNetwork.stats_log_interval > 0 && gConfigNetwork.log_server_actions &&
+        ticks - _lastStatsLogTime >= (uint32)gConfigNetwork.stats_log_interval * 1000) {
+        _lastStatsLogTime = ticks;
+        AppendServerLog("[STATS] " + getStats());
+    }
+}
+
+std::vector<const NetworkConnection *> Network::GetConnections() const
+{
+    std::vector<const NetworkConnection *> connections;
+    if (mode == NETWORK_MODE_CLIENT) {
+        connections.push_back(server_connection);
+    } else if (mode == NETWORK_MODE_SERVER) {
+        for (const auto &connection : client_connection_list) {
+            connections.push_back(connection.get());
+        }
+    }
+    return connections;
+}
+
+static std::string network_get_connection_name(const NetworkConnection * connection)
+{
+    if (network_get_mode() == NETWORK_MODE_CLIENT) {
+        return "server";
+    }
+    if (connection->Player != nullptr) {
+        return connection->Player->Name;
+    }
+    const char * hostName = connection->Socket->GetHostName();
+    return hostName != nullptr ? hostName : "(joining)";
+}
+
+json_t * Network::GetStatsJson() const
+{
+    json_t * jsonConnections = json_array();
+    for (auto connection : GetConnections()) {
+        json_t * jsonConnection = connection->Stats.ToJson();
+        json_object_set_new(jsonConnection, "name", json_string(network_get_connection_name(connection).c_str()));
+        if (connection->Player != nullptr) {
+            json_object_set_new(jsonConnection, "player_id", json_integer(connection->Player->Id));
+        }
+        json_array_append_new(jsonConnections, jsonConnection);
+    }
+
+    json_t * jsonStats = json_object();
+    json_object_set_new(jsonStats, "mode", json_string(mode == NETWORK_MODE_SERVER ? "server" : "client"));
+    json_object_set_new(jsonStats, "tick", json_integer(gCurrentTicks));
+    json_object_set_new(jsonStats, "connections", jsonConnections);
+    return jsonStats;
+}
+
+std::vector<std::string> Network::GetStatsSummary() const
+{
+    std::vector<std::string> lines;
+    char buffer[256];
+    for (auto connection : GetConnections()) {
+        const auto &stats = connection->Stats;
+        snprintf(buffer, sizeof(buffer), "%s: in %.1f KiB, out %.1f KiB, queue %u (max %u), %u send stalls, ping %u ms",
+            network_get_connection_name(connection).c_str(),
+            stats.GetTotalReceived() / 1024.0,
+            stats.GetTotalSent() / 1024.0,
+            stats.QueueDepth,
+            stats.MaxQueueDepth,
+            (uint32)stats.SendStalls,
+            stats.LastRoundTrip);
+        lines.push_back(buffer);
+
+        if (stats.MapTransferSize != 0) {
+            snprintf(buffer, sizeof(buffer), "  map: %u / %u KiB", stats.GetMapTransferred() / 1024, stats.MapTransferSize / 1024);
+            lines.push_back(buffer);
+        }
+
+        std::string line = "  rtt:";
+        for (size_t i = 0; i < NetworkConnectionStats::RTT_BUCKET_COUNT; i++) {
+            if (i < Util::CountOf(NetworkConnectionStats::RTT_BUCKET_LIMITS)) {
+                snprintf(buffer, sizeof(buffer), " <%u:%u", NetworkConnectionStats::RTT_BUCKET_LIMITS[i], stats.RoundTrips[i]);
+            } else {
+                snprintf(buffer, sizeof(buffer), " more:%u", stats.RoundTrips[i]);
+            }
+            line += buffer;
+        }
+        lines.push_back(line);
+
+        line = "  out by type:";
+        for (uint32 i = 0; i <= NETWORK_COMMAND_MAX; i++) {
+            if (stats.Sent[i].Packets != 0) {
+                snprintf(buffer, sizeof(buffer), " %s %.1f KiB", network_get_command_name(i), stats.Sent[i].Bytes / 1024.0);
+                line += buffer;
+            }
+        }
+        lines.push_back(line);
+    }
+    return lines;
+}
+
 void Network::Flush()
 {
     if (GetMode() == NETWORK_MODE_CLIENT)
@@ -428,9 +584,10 @@ void Network::Flush()
     }
     else
     {
+        NetworkBatchCache batchCache;
         for (auto& it : client_connection_list)
         {
-            it->SendQueuedPackets();
+            it->SendQueuedPackets(&batchCache);
         }
     }
 }
@@ -622,8 +779,11 @@ const char* Network::FormatChat(NetworkPlayer* fromplayer, const char* text)
     return formatted;
 }
 
-void Network::SendPacketToClients(NetworkPacket& packet, bool front, bool gameCmd)
+void Network::SendPacketToClients(std::unique_ptr<NetworkPacket> packet, bool front, bool gameCmd)
 {
+    // The packet is shared by every connection's queue rather than copied for each
+    packet->Size = (uint16)packet->Data.size();
+    std::shared_ptr<const NetworkPacket> sharedPacket = std::move(packet);
     for (auto &client_connection : client_connection_list) {
         if (gameCmd) {
             // If marked as game command we can not send the packet to connections that are not fully connected.
@@ -633,7 +793,7 @@ void Network::SendPacketToClients(NetworkPacket& packet, bool front, bool gameCm
                 continue;
             }
         }
-        client_connection->QueuePacket(NetworkPacket::Duplicate(packet), front);
+        client_connection->QueuePacket(sharedPacket, front);
     }
 }
 
@@ -672,9 +832,14 @@ bool Network::CheckSRAND(uint32 tick, uint32 srand0)
 
 void Network::CheckDesynchronizaton()
 {
+    if (GetMode() == NETWORK_MODE_CLIENT) {
+        CheckStateDigest();
+    }
+
     // Check synchronisation
     if (GetMode() == NETWORK_MODE_CLIENT && !_desynchronised && !CheckSRAND(gCurrentTicks, gScenarioSrand0)) {
         _desynchronised = true;
+        WriteDesyncDump();
 
         char str_desync[256];
         format_string(str_desync, 256, STR_MULTIPLAYER_DESYNC, nullptr);
@@ -689,6 +854,69 @@ void Network::CheckDesynchronizaton()
     }
 }
 
+void Network::CheckStateDigest()
+{
+    // Only worth computing for the ticks the server sent a digest for
+    const StateDigest * serverDigest = _serverStateDigests.Find(gCurrentTicks);
+    if (serverDigest == nullptr) {
+        return;
+    }
+
+    StateDigest digest = StateDigest::Compute(gCurrentTicks);
+    _stateDigests.Add(digest);
+
+    sint32 subsystem = digest.FindMismatch(*serverDigest);
+    if (subsystem != STATE_DIGEST_COUNT) {
+        if (!_desyncDumped) {
+            log_warning("State digest mismatch at tick %u, first differing subsystem: %s",
+                        gCurrentTicks, state_digest_get_subsystem_name(subsystem));
+            WriteDesyncDump();
+        }
+    } else if (gCurrentTicks - _desyncRecordingTick >= NETWORK_DESYNC_SNAPSHOT_INTERVAL) {
+        // Only a park known to match the server is worth restarting the recording from
+        SnapshotDesyncRecording();
+    }
+}
+
+void Network::SnapshotDesyncRecording()
+{
+    std::vector<uint8> park;
+    if (!SaveMapData(park)) {
+        log_warning("Unable to snapshot the park for desync dumps.");
+        return;
+    }
+    _desyncRecording.Clear();
+    _desyncRecording.Park = std::move(park);
+    _desyncRecordingTick = gCurrentTicks;
+}
+
+void Network::WriteDesyncDump()
+{
+    if (_desyncDumped || _desyncRecording.Park.empty()) {
+        return;
+    }
+    _desyncDumped = true;
+
+    // The server digests up to now are what a replay of the recording should reproduce
+    _desyncRecording.Digests.clear();
+    for (size_t i = 0; i < _serverStateDigests.GetCount(); i++) {
+        const StateDigest &digest = _serverStateDigests[i];
+        if (digest.Tick >= _desyncRecordingTick && digest.Tick <= gCurrentTicks) {
+            _desyncRecording.Digests.push_back(digest);
+        }
+    }
+
+    try {
+        auto directory = _env->GetDirectoryPath(DIRBASE::USER, DIRID::LOG_DESYNCS);
+        auto path = BeginLog(directory, ServerName, "%Y%m%d-%H%M%S.desync");
+        auto fs = FileStream(path, FILE_MODE_WRITE);
+        _desyncRecording.Save(&fs);
+        log_warning("Desync dump written to %s", path.c_str());
+    } catch (const std::exception &e) {
+        log_error("Unable to write desync dump: %s", e.what());
+    }
+}
+
 void Network::KickPlayer(sint32 playerId)
 {
     for (auto &client_connection : client_connection_list) {
@@ -698,7 +926,7 @@ void Network::KickPlayer(sint32 playerId)
             char str_disconnect_msg[256];
             format_string(str_disconnect_msg, 256, STR_MULTIPLAYER_KICKED_REASON, nullptr);
             Server_Send_SETDISCONNECTMSG(*client_connection, str_disconnect_msg);
-            client_connection->Socket->Disconnect();
+            client_connection->Disconnect();
             break;
         }
     }
@@ -712,7 +940,7 @@ void Network::SetPassword(const char* password)
 void Network::ShutdownClient()
 {
     if (GetMode() == NETWORK_MODE_CLIENT) {
-        server_connection->Socket->Disconnect();
+        server_connection->Disconnect();
     }
 }
 
@@ -1083,7 +1311,7 @@ void Network::Server_Send_AUTH(NetworkConnection& connection)
     connection.QueuePacket(std::move(packet));
     if (connection.AuthStatus != NETWORK_AUTH_OK && connection.AuthStatus != NETWORK_AUTH_REQUIREPASSWORD) {
         connection.SendQueuedPackets();
-        connection.Socket->Disconnect();
+        connection.Disconnect();
     }
 }
 
@@ -1104,10 +1332,17 @@ void Network::Server_Send_MAP(NetworkConnection* connection)
     if (header == nullptr) {
         if (connection) {
             connection->SetLastDisconnectReason(STR_MULTIPLAYER_CONNECTION_CLOSED);
-            connection->Socket->Disconnect();
+            connection->Disconnect();
         }
         return;
     }
+    if (connection) {
+        connection->Stats.BeginMapTransfer(out_size);
+    } else {
+        for (auto &clientConnection : client_connection_list) {
+            clientConnection->Stats.BeginMapTransfer(out_size);
+        }
+    }
     size_t chunksize = 65000;
     for (size_t i = 0; i < out_size; i += chunksize) {
         size_t datasize = Math::Min(chunksize, out_size - i);
@@ -1117,7 +1352,7 @@ void Network::Server_Send_MAP(NetworkConnection* connection)
         if (connection) {
             connection->QueuePacket(std::move(packet));
         } else {
-            SendPacketToClients(*packet);
+            SendPacketToClients(std::move(packet));
         }
     }
     free(header);
@@ -1180,23 +1415,35 @@ void Network::Server_Send_CHAT(const char* text)
     std::unique_ptr<NetworkPacket> packet(NetworkPacket::Allocate());
     *packet << (uint32)NETWORK_COMMAND_CHAT;
     packet->WriteString(text);
-    SendPacketToClients(*packet);
+    SendPacketToClients(std::move(packet));
 }
 
 void Network::Client_Send_GAMECMD(uint32 eax, uint32 ebx, uint32 ecx, uint32 edx, uint32 esi, uint32 edi, uint32 ebp, uint8 callback)
 {
+    const uint32 args[] = { eax, ebx, ecx, edx, esi, edi, ebp };
     std::unique_ptr<NetworkPacket> packet(NetworkPacket::Allocate());
-    *packet << (uint32)NETWORK_COMMAND_GAMECMD << gCurrentTicks << eax << (ebx | GAME_COMMAND_FLAG_NETWORKED)
-            << ecx << edx << esi << edi << ebp << callback;
+    *packet << (uint32)NETWORK_COMMAND_GAMECMD;
+    NetworkGameCommand::WriteTick(*packet, server_connection->SentCommandTicks, gCurrentTicks);
+    NetworkGameCommand::WriteArgs(*packet, args);
+    *packet << callback;
     server_connection->QueuePacket(std::move(packet));
 }
 
 void Network::Server_Send_GAMECMD(uint32 eax, uint32 ebx, uint32 ecx, uint32 edx, uint32 esi, uint32 edi, uint32 ebp, uint8 playerid, uint8 callback)
 {
+    if (playerid == GetPlayerID()) {
+        // The host runs its own commands straight away, before the tick clients will run them at,
+        // so the state at the start of that tick cannot be compared
+        _immediateCommandTick = gCurrentTicks;
+    }
+
+    const uint32 args[] = { eax, ebx, ecx, edx, esi, edi, ebp };
     std::unique_ptr<NetworkPacket> packet(NetworkPacket::Allocate());
-    *packet << (uint32)NETWORK_COMMAND_GAMECMD << gCurrentTicks << eax << (ebx | GAME_COMMAND_FLAG_NETWORKED)
-            << ecx << edx << esi << edi << ebp << playerid << callback;
-    SendPacketToClients(*packet, false, true);
+    *packet << (uint32)NETWORK_COMMAND_GAMECMD;
+    NetworkGameCommand::WriteTick(*packet, _broadcastCommandTicks, gCurrentTicks);
+    NetworkGameCommand::WriteArgs(*packet, args);
+    *packet << playerid << callback;
+    SendPacketToClients(std::move(packet), false, true);
 }
 
 void Network::Client_Send_GAME_ACTION(const GameAction *action)
@@ -1216,7 +1463,10 @@ void Network::Client_Send_GAME_ACTION(const GameAction *action)
     DataSerialiser stream(true);
     action->Serialise(stream);
 
-    *packet << (uint32)NETWORK_COMMAND_GAME_ACTION << gCurrentTicks << action->GetType() << stream;
+    *packet << (uint32)NETWORK_COMMAND_GAME_ACTION;
+    NetworkGameCommand::WriteTick(*packet, server_connection->SentCommandTicks, gCurrentTicks);
+    packet->WriteVarUInt(action->GetType());
+    *packet << stream;
 
     server_connection->QueuePacket(std::move(packet));
 }
@@ -1228,9 +1478,13 @@ void Network::Server_Send_GAME_ACTION(const GameAction *action)
     DataSerialiser stream(true);
     action->Serialise(stream);
 
-    *packet << (uint32)NETWORK_COMMAND_GAME_ACTION << gCurrentTicks << action->GetType() << stream;
+    *packet << (uint32)NETWORK_COMMAND_GAME_ACTION;
+    NetworkGameCommand::WriteTick(*packet, _broadcastCommandTicks, gCurrentTicks);
+    packet->WriteVarUInt(action->GetType());
+    *packet << stream;
 
-    SendPacketToClients(*packet);
+    // Only joined clients follow the broadcast command ticks
+    SendPacketToClients(std::move(packet), false, true);
 }
 
 void Network::Server_Send_TICK()
@@ -1255,13 +1509,23 @@ void Network::Server_Send_TICK()
         checksum_counter = 0;
         flags |= NETWORK_TICK_FLAG_CHECKSUMS;
     }
+    if (gCurrentTicks % NETWORK_STATE_DIGEST_INTERVAL == 0 && _immediateCommandTick != gCurrentTicks) {
+        flags |= NETWORK_TICK_FLAG_DIGEST;
+    }
     // Send flags always, so we can understand packet structure on the other end,
     // and allow for some expansion.
     *packet << flags;
+    if (flags & NETWORK_TICK_FLAG_DIGEST) {
+        StateDigest digest = StateDigest::Compute(gCurrentTicks);
+        _stateDigests.Add(digest);
+        for (uint32 hash : digest.Hashes) {
+            *packet << hash;
+        }
+    }
     if (flags & NETWORK_TICK_FLAG_CHECKSUMS) {
         packet->WriteString(sprite_checksum());
     }
-    SendPacketToClients(*packet);
+    SendPacketToClients(std::move(packet));
 }
 
 void Network::Server_Send_PLAYERLIST()
@@ -1271,7 +1535,7 @@ void Network::Server_Send_PLAYERLIST()
     for (auto &player : player_list) {
         player->Write(*packet);
     }
-    SendPacketToClients(*packet);
+    SendPacketToClients(std::move(packet));
 }
 
 void Network::Client_Send_PING()
@@ -1289,7 +1553,7 @@ void Network::Server_Send_PING()
     for (auto &client_connection : client_connection_list) {
         client_connection->PingTime = platform_get_ticks();
     }
-    SendPacketToClients(*packet, true);
+    SendPacketToClients(std::move(packet), true);
 }
 
 void Network::Server_Send_PINGLIST()
@@ -1299,7 +1563,7 @@ void Network::Server_Send_PINGLIST()
     for (auto &player : player_list) {
         *packet << player->Id << player->Ping;
     }
-    SendPacketToClients(*packet);
+    SendPacketToClients(std::move(packet));
 }
 
 void Network::Server_Send_SETDISCONNECTMSG(NetworkConnection& connection, const char* msg)
@@ -1362,7 +1626,7 @@ void Network::Server_Send_EVENT_PLAYER_JOINED(const char *playerName)
     *packet << (uint32)NETWORK_COMMAND_EVENT;
     *packet << (uint16)SERVER_EVENT_PLAYER_JOINED;
     packet->WriteString(playerName);
-    SendPacketToClients(*packet);
+    SendPacketToClients(std::move(packet));
 }
 
 void Network::Server_Send_EVENT_PLAYER_DISCONNECTED(const char *playerName, const char *reason)
@@ -1372,7 +1636,7 @@ void Network::Server_Send_EVENT_PLAYER_DISCONNECTED(const char *playerName, cons
     *packet << (uint16)SERVER_EVENT_PLAYER_DISCONNECTED;
     packet->WriteString(playerName);
     packet->WriteString(reason);
-    SendPacketToClients(*packet);
+    SendPacketToClients(std::move(packet));
 }
 
 bool Network::ProcessConnection(NetworkConnection& connection)
@@ -1403,7 +1667,10 @@ bool Network::ProcessConnection(NetworkConnection& connection)
             break;
         }
     } while (packetStatus == NETWORK_READPACKET_MORE_DATA || packetStatus == NETWORK_READPACKET_SUCCESS);
-    connection.SendQueuedPackets();
+    // Batched connections are flushed once at the end of each tick, but ticks stop while paused
+    if (!connection.BatchPackets || game_is_paused()) {
+        connection.SendQueuedPackets();
+    }
     if (!connection.ReceivedPacketRecently()) {
         if (!connection.GetLastDisconnectReason()) {
             connection.SetLastDisconnectReason(STR_MULTIPLAYER_NO_DATA);
@@ -1468,6 +1735,9 @@ void Network::ProcessGameCommandQueue()
 
             GameAction *action = gc.action.get();
             action->SetFlags(action->GetFlags() | GAME_COMMAND_FLAG_NETWORKED);
+            if (mode == NETWORK_MODE_CLIENT) {
+                _desyncRecording.AddGameAction(gc.tick, action, true);
+            }
 
             Guard::Assert(action != nullptr);
 
@@ -1489,6 +1759,10 @@ void Network::ProcessGameCommandQueue()
             sint32 flags = gc.ebx;
             if (mode == NETWORK_MODE_SERVER)
                 flags |= GAME_COMMAND_FLAG_NETWORKED;
+            if (mode == NETWORK_MODE_CLIENT) {
+                const uint32 args[] = { gc.eax, gc.ebx, gc.ecx, gc.edx, gc.esi, gc.edi, gc.ebp };
+                _desyncRecording.AddGameCommand(gc.tick, args, gc.playerid, true);
+            }
 
             money32 cost = game_do_command(gc.eax, flags, gc.ecx, gc.edx, gc.esi, gc.edi, gc.ebp);
 
@@ -1544,9 +1818,11 @@ void Network::AddClient(ITcpSocket * socket)
     }
     auto connection = std::make_unique<NetworkConnection>();
     connection->Socket = socket;
+    connection->BatchPackets = true;
     char addr[128];
     snprintf(addr, sizeof(addr), "Client joined from %s", socket->GetHostName());
     AppendServerLog(addr);
+    _ioThread->AddConnection(connection.get());
     client_connection_list.push_back(std::move(connection));
 }
 
@@ -1579,6 +1855,7 @@ void Network::RemoveClient(std::unique_ptr<NetworkConnection>& connection)
     player_list.erase(std::remove_if(player_list.begin(), player_list.end(), [connection_player](std::unique_ptr<NetworkPlayer>& player){
                           return player.get() == connection_player;
                       }), player_list.end());
+    _ioThread->RemoveConnection(connection.get());
     client_connection_list.remove(connection);
     if (gConfigNetwork.pause_server_if_no_clients && game_is_not_paused() && client_connection_list.size() == 0)
     {
@@ -1694,7 +1971,7 @@ void Network::Client_Handle_TOKEN(NetworkConnection& connection, NetworkPacket&
     {
         log_error("Failed to load key %s", keyPath);
         connection.SetLastDisconnectReason(STR_MULTIPLAYER_VERIFICATION_FAILURE);
-        connection.Socket->Disconnect();
+        connection.Disconnect();
         return;
     }
 
@@ -1710,7 +1987,7 @@ void Network::Client_Handle_TOKEN(NetworkConnection& connection, NetworkPacket&
     if (!ok) {
         log_error("Failed to sign server's challenge.");
         connection.SetLastDisconnectReason(STR_MULTIPLAYER_VERIFICATION_FAILURE);
-        connection.Socket->Disconnect();
+        connection.Disconnect();
         return;
     }
     // Don't keep private key in memory. There's no need and it may get leaked
@@ -1736,37 +2013,37 @@ void Network::Client_Handle_AUTH(NetworkConnection& connection, NetworkPacket& p
         break;
     case NETWORK_AUTH_BADNAME:
         connection.SetLastDisconnectReason(STR_MULTIPLAYER_BAD_PLAYER_NAME);
-        connection.Socket->Disconnect();
+        connection.Disconnect();
         break;
     case NETWORK_AUTH_BADVERSION:
     {
         const char *version = packet.ReadString();
         connection.SetLastDisconnectReason(STR_MULTIPLAYER_INCORRECT_SOFTWARE_VERSION, &version);
-        connection.Socket->Disconnect();
+        connection.Disconnect();
         break;
     }
     case NETWORK_AUTH_BADPASSWORD:
         connection.SetLastDisconnectReason(STR_MULTIPLAYER_BAD_PASSWORD);
-        connection.Socket->Disconnect();
+        connection.Disconnect();
         break;
     case NETWORK_AUTH_VERIFICATIONFAILURE:
         connection.SetLastDisconnectReason(STR_MULTIPLAYER_VERIFICATION_FAILURE);
-        connection.Socket->Disconnect();
+        connection.Disconnect();
         break;
     case NETWORK_AUTH_FULL:
         connection.SetLastDisconnectReason(STR_MULTIPLAYER_SERVER_FULL);
-        connection.Socket->Disconnect();
+        connection.Disconnect();
         break;
     case NETWORK_AUTH_REQUIREPASSWORD:
         context_open_window_view(WV_NETWORK_PASSWORD);
         break;
     case NETWORK_AUTH_UNKNOWN_KEY_DISALLOWED:
         connection.SetLastDisconnectReason(STR_MULTIPLAYER_UNKNOWN_KEY_DISALLOWED);
-        connection.Socket->Disconnect();
+        connection.Disconnect();
         break;
     default:
         connection.SetLastDisconnectReason(STR_MULTIPLAYER_INCORRECT_SOFTWARE_VERSION);
-        connection.Socket->Disconnect();
+        connection.Disconnect();
         break;
     }
 }
@@ -1775,6 +2052,8 @@ void Network::Server_Client_Joined(const char* name, const std::string &keyhash,
 {
     NetworkPlayer* player = AddPlayer(name, keyhash);
     connection.Player = player;
+    // The new player has not seen earlier commands, so the next broadcast must carry a full tick
+    _broadcastCommandTicks.Reset();
     if (player) {
         char text[256];
         const char * player_name = (const char *) player->Name.c_str();
@@ -1809,7 +2088,7 @@ void Network::Client_Handle_OBJECTS(NetworkConnection& connection, NetworkPacket
     if (size > OBJECT_ENTRY_COUNT)
     {
         connection.SetLastDisconnectReason(STR_MULTIPLAYER_SERVER_INVALID_REQUEST);
-        connection.Socket->Disconnect();
+        connection.Disconnect();
         log_warning("Server sent invalid amount of objects");
         return;
     }
@@ -1836,6 +2115,25 @@ void Network::Client_Handle_OBJECTS(NetworkConnection& connection, NetworkPacket
     Client_Send_OBJECTS(requested_objects);
 }
 
+void Network::Client_Handle_BATCH(NetworkConnection& connection, NetworkPacket& packet)
+{
+    std::vector<NetworkPacket> packets;
+    if (!NetworkBatch::Read(packet, packets))
+    {
+        log_warning("Received a malformed packet batch.");
+        return;
+    }
+    for (auto &batchedPacket : packets)
+    {
+        // Batches are never nested
+        if (batchedPacket.GetCommand() != NETWORK_COMMAND_BATCH)
+        {
+            connection.Stats.RecordReceivedBatched(batchedPacket.GetCommand(), sizeof(uint16) + batchedPacket.Size);
+            ProcessPacket(connection, batchedPacket);
+        }
+    }
+}
+
 void Network::Server_Handle_OBJECTS(NetworkConnection& connection, NetworkPacket& packet)
 {
     uint32 size;
@@ -1843,7 +2141,7 @@ void Network::Server_Handle_OBJECTS(NetworkConnection& connection, NetworkPacket
     if (size > OBJECT_ENTRY_COUNT)
     {
         connection.SetLastDisconnectReason(STR_MULTIPLAYER_CLIENT_INVALID_REQUEST);
-        connection.Socket->Disconnect();
+        connection.Disconnect();
         std::string playerName = "(unknown)";
         if (connection.Player)
         {
@@ -1991,28 +2289,7 @@ void Network::Client_Handle_MAP(NetworkConnection& connection, NetworkPacket& pa
     memcpy(&chunk_buffer[offset], (void*)packet.Read(chunksize), chunksize);
     if (offset + chunksize == size) {
         context_force_close_window_by_class(WC_NETWORK_STATUS);
-        bool has_to_free = false;
-        uint8 *data = &chunk_buffer[0];
-        size_t data_size = size;
-        // zlib-compressed
-        if (strcmp("open2_sv6_zlib", (char *)&chunk_buffer[0]) == 0)
-        {
-            log_verbose("Received zlib-compressed sv6 map");
-            has_to_free = true;
-            size_t header_len = strlen("open2_sv6_zlib") + 1;
-            data = util_zlib_inflate(&chunk_buffer[header_len], size - header_len, &data_size);
-            if (data == nullptr)
-            {
-                log_warning("Failed to decompress data sent from server.");
-                Close();
-                return;
-            }
-        } else {
-            log_verbose("Assuming received map is in plain sv6 format");
-        }
-
-        auto ms = MemoryStream(data, data_size);
-        if (LoadMap(&ms))
+        if (LoadMapData(&chunk_buffer[0], size))
         {
             game_load_init();
             game_command_queue.clear();
@@ -2020,6 +2297,11 @@ void Network::Client_Handle_MAP(NetworkConnection& connection, NetworkPacket& pa
             server_srand0_tick = 0;
             // window_network_status_open("Loaded new map from network");
             _desynchronised = false;
+            _desyncDumped = false;
+            _desyncRecording.Clear();
+            _desyncRecording.Park.assign(chunk_buffer.begin(), chunk_buffer.begin() + size);
+            _desyncRecordingTick = gCurrentTicks;
+            _stateDigests.Clear();
             gFirstTimeSaving = true;
 
             // Notify user he is now online and which shortcut key enables chat
@@ -2027,17 +2309,56 @@ void Network::Client_Handle_MAP(NetworkConnection& connection, NetworkPacket& pa
 
             // Fix invalid vehicle sprite sizes, thus preventing visual corruption of sprites
             fix_invalid_vehicle_sprite_sizes();
+
+            if (_relay != nullptr) {
+                _relay->OnMapLoaded();
+            }
         }
         else
         {
             //Something went wrong, game is not loaded. Return to main screen.
             game_do_command(0, GAME_COMMAND_FLAG_APPLY, 0, 0, GAME_COMMAND_LOAD_OR_QUIT, 1, 0);
         }
-        if (has_to_free)
+    }
+}
+
+bool Network::SaveMapData(std::vector<uint8> &data) const
+{
+    IObjectManager * objManager = GetObjectManager();
+    size_t size;
+    uint8 * header = save_for_network(size, objManager->GetPackableObjects());
+    if (header == nullptr) {
+        return false;
+    }
+    data.assign(header, header + size);
+    free(header);
+    return true;
+}
+
+bool Network::LoadMapData(const uint8 * data, size_t size)
+{
+    bool result = false;
+    // zlib-compressed
+    if (size > 0 && strcmp("open2_sv6_zlib", (const char *)data) == 0)
+    {
+        log_verbose("Received zlib-compressed sv6 map");
+        size_t header_len = strlen("open2_sv6_zlib") + 1;
+        size_t data_size;
+        uint8 * inflated = util_zlib_inflate((uint8 *)&data[header_len], size - header_len, &data_size);
+        if (inflated == nullptr)
         {
-            free(data);
+            log_warning("Failed to decompress map data.");
+            return false;
         }
+        auto ms = MemoryStream(inflated, data_size);
+        result = LoadMap(&ms);
+        free(inflated);
+    } else {
+        log_verbose("Assuming received map is in plain sv6 format");
+        auto ms = MemoryStream(data, size);
+        result = LoadMap(&ms);
     }
+    return result;
 }
 
 bool Network::LoadMap(IStream * stream)
@@ -2140,6 +2461,9 @@ bool Network::SaveMap(IStream * stream, const std::vector<const ObjectRepository
 
 void Network::Client_Handle_CHAT(NetworkConnection& connection, NetworkPacket& packet)
 {
+    if (_relay != nullptr) {
+        _relay->RelayPacket(packet);
+    }
     const char* text = packet.ReadString();
     if (text) {
         chat_history_add(text);
@@ -2164,26 +2488,34 @@ void Network::Server_Handle_CHAT(NetworkConnection& connection, NetworkPacket& p
 
 void Network::Client_Handle_GAMECMD(NetworkConnection& connection, NetworkPacket& packet)
 {
-    uint32 tick;
-    uint32 args[7];
+    uint32 args[NetworkGameCommand::NUM_ARGS];
     uint8 playerid;
     uint8 callback;
-    packet >> tick >> args[0] >> args[1] >> args[2] >> args[3] >> args[4] >> args[5] >> args[6] >> playerid >> callback;
+    uint32 tick = NetworkGameCommand::ReadTick(packet, connection.ReceivedCommandTicks);
+    NetworkGameCommand::ReadArgs(packet, args);
+    packet >> playerid >> callback;
 
+    if (_relay != nullptr) {
+        _relay->RelayGameCommand(tick, args, playerid, callback);
+    }
     game_command_queue.emplace(tick, args, playerid, callback, _commandId++);
 }
 
 void Network::Client_Handle_GAME_ACTION(NetworkConnection& connection, NetworkPacket& packet)
 {
-    uint32 tick;
-    uint32 type;
-    packet >> tick >> type;
+    uint32 tick = NetworkGameCommand::ReadTick(packet, connection.ReceivedCommandTicks);
+    uint32 type = packet.ReadVarUInt();
 
     MemoryStream stream;
     size_t size = packet.Size - packet.BytesRead;
-    stream.WriteArray(packet.Read(size), size);
+    const uint8 * data = packet.Read(size);
+    stream.WriteArray(data, size);
     stream.SetPosition(0);
 
+    if (_relay != nullptr) {
+        _relay->RelayGameAction(tick, type, data, size);
+    }
+
     DataSerialiser ds(false, stream);
 
     GameAction::Ptr action = GameActions::Create(type);
@@ -2211,14 +2543,12 @@ void Network::Client_Handle_GAME_ACTION(NetworkConnection& connection, NetworkPa
 
 void Network::Server_Handle_GAME_ACTION(NetworkConnection& connection, NetworkPacket& packet)
 {
-    uint32 tick;
-    uint32 type;
-
     if (!connection.Player) {
         return;
     }
 
-    packet >> tick >> type;
+    uint32 tick = NetworkGameCommand::ReadTick(packet, connection.ReceivedCommandTicks);
+    uint32 type = packet.ReadVarUInt();
 
     //tick count is different by time last_action_time is set, keep same value
     // Check if player's group permission allows command to run
@@ -2284,8 +2614,7 @@ void Network::Server_Handle_GAME_ACTION(NetworkConnection& connection, NetworkPa
 
 void Network::Server_Handle_GAMECMD(NetworkConnection& connection, NetworkPacket& packet)
 {
-    uint32 tick;
-    uint32 args[7];
+    uint32 args[NetworkGameCommand::NUM_ARGS];
     uint8 playerid;
     uint8 callback;
 
@@ -2295,7 +2624,9 @@ void Network::Server_Handle_GAMECMD(NetworkConnection& connection, NetworkPacket
 
     playerid = connection.Player->Id;
 
-    packet >> tick >> args[0] >> args[1] >> args[2] >> args[3] >> args[4] >> args[5] >> args[6] >> callback;
+    uint32 tick = NetworkGameCommand::ReadTick(packet, connection.ReceivedCommandTicks);
+    NetworkGameCommand::ReadArgs(packet, args);
+    packet >> callback;
 
     sint32 commandCommand = args[4];
 
@@ -2347,12 +2678,23 @@ void Network::Server_Handle_GAMECMD(NetworkConnection& connection, NetworkPacket
 
 void Network::Client_Handle_TICK(NetworkConnection& connection, NetworkPacket& packet)
 {
+    if (_relay != nullptr) {
+        _relay->RelayPacket(packet);
+    }
     uint32 srand0;
     uint32 flags;
     // Note: older server version may not advertise flags at all.
     // NetworkPacket will return 0, if trying to read past end of buffer,
     // so flags == 0 is expected in such cases.
     packet >> server_tick >> srand0 >> flags;
+    if (flags & NETWORK_TICK_FLAG_DIGEST) {
+        StateDigest digest;
+        digest.Tick = server_tick;
+        for (uint32 &hash : digest.Hashes) {
+            packet >> hash;
+        }
+        _serverStateDigests.Add(digest);
+    }
     if (server_srand0_tick == 0) {
         server_srand0 = srand0;
         server_srand0_tick = server_tick;
@@ -2397,6 +2739,10 @@ void Network::Client_Handle_PLAYERLIST(NetworkConnection& connection, NetworkPac
             it++;
         }
     }
+
+    if (_relay != nullptr) {
+        _relay->RelayPlayerList();
+    }
 }
 
 void Network::Client_Handle_PING(NetworkConnection& connection, NetworkPacket& packet)
@@ -2410,6 +2756,7 @@ void Network::Server_Handle_PING(NetworkConnection& connection, NetworkPacket& p
     if (ping < 0) {
         ping = 0;
     }
+    connection.Stats.RecordRoundTrip(ping);
     if (connection.Player) {
         connection.Player->Ping = ping;
         window_invalidate_by_number(WC_PLAYER, connection.Player->Id);
@@ -2418,6 +2765,9 @@ void Network::Server_Handle_PING(NetworkConnection& connection, NetworkPacket& p
 
 void Network::Client_Handle_PINGLIST(NetworkConnection& connection, NetworkPacket& packet)
 {
+    if (_relay != nullptr) {
+        _relay->RelayPacket(packet);
+    }
     uint8 size;
     packet >> size;
     for (uint32 i = 0; i < size; i++) {
@@ -2469,6 +2819,9 @@ void Network::Client_Handle_GROUPLIST(NetworkConnection& connection, NetworkPack
 
 void Network::Client_Handle_EVENT(NetworkConnection& connection, NetworkPacket& packet)
 {
+    if (_relay != nullptr) {
+        _relay->RelayPacket(packet);
+    }
     char text[256];
     uint16 eventType;
     packet >> eventType;
@@ -2512,6 +2865,9 @@ static std::string json_stdstring_value(const json_t * string)
 
 void Network::Client_Handle_GAMEINFO(NetworkConnection& connection, NetworkPacket& packet)
 {
+    if (_relay != nullptr) {
+        _relay->SetGameInfo(packet);
+    }
     const char * jsonString = packet.ReadString();
 
     json_error_t error;
@@ -2557,6 +2913,11 @@ sint32 network_begin_server(sint32 port, const char* address)
     return gNetwork.BeginServer(port, address);
 }
 
+sint32 network_begin_relay(const char *host, sint32 port, sint32 relayPort, const char* relayAddress)
+{
+    return gNetwork.BeginRelay(host, port, relayPort, relayAddress);
+}
+
 void network_update()
 {
     gNetwork.Update();
@@ -2597,6 +2958,16 @@ sint32 network_get_authstatus()
     return gNetwork.GetAuthStatus();
 }
 
+bool network_load_map(const uint8 * data, size_t size)
+{
+    return gNetwork.LoadMapData(data, size);
+}
+
+bool network_save_map(std::vector<uint8> &data)
+{
+    return gNetwork.SaveMapData(data);
+}
+
 uint32 network_get_server_tick()
 {
     return gNetwork.GetServerTick();
@@ -3125,6 +3496,11 @@ sint32 network_get_current_player_group_index()
     return -1;
 }
 
+std::vector<std::string> network_get_stats_summary()
+{
+    return gNetwork.GetStatsSummary();
+}
+
 void network_send_map()
 {
     gNetwork.Server_Send_MAP();
@@ -3254,6 +3630,8 @@ sint32 network_get_mode() { return NETWORK_MODE_NONE; }
 sint32 network_get_status() { return NETWORK_STATUS_NONE; }
 sint32 network_get_authstatus() { return NETWORK_AUTH_NONE; }
 uint32 network_get_server_tick() { return gCurrentTicks; }
+bool network_load_map(const uint8 * data, size_t size) { return false; }
+bool network_save_map(std::vector<uint8> &data) { return false; }
 void network_flush() {}
 void network_send_tick() {}
 void network_check_desynchronization() {}
@@ -3265,6 +3643,7 @@ void network_update() {}
 void network_process_game_commands() {}
 sint32 network_begin_client(const char *host, sint32 port) { return 1; }
 sint32 network_begin_server(sint32 port, const char * address) { return 1; }
+sint32 network_begin_relay(const char *host, sint32 port, sint32 relayPort, const char * relayAddress) { return 1; }
 sint32 network_get_num_players() { return 1; }
 const char* network_get_player_name(uint32 index) { return "local (OpenRCT2 compiled without MP)"; }
 uint32 network_get_player_flags(uint32 index) { return 0; }
@@ -3313,4 +3692,5 @@ const utf8 * network_get_server_provider_name() { return nullptr; }
 const utf8 * network_get_server_provider_email() { return nullptr; }
 const utf8 * network_get_server_provider_website() { return nullptr; }
 std::string network_get_version() { return "Multiplayer disabled"; }
+std::vector<std::string> network_get_stats_summary() { return {}; }
 #endif /* DISABLE_NETWORK */
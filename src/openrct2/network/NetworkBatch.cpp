@@ -0,0 +1,210 @@
+#pragma region Copyright (c) 2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#ifndef DISABLE_NETWORK
+
+#include <algorithm>
+#include "NetworkBatch.h"
+#include "TcpSocket.h"
+#include "zlib.h"
+
+// Largest amount of packet data in one batch, leaving room for the batch header within a packet
+constexpr size_t NETWORK_BATCH_MAX_LENGTH = 32 * 1024;
+// Batches smaller than this are not worth deflating
+constexpr size_t NETWORK_BATCH_COMPRESSION_THRESHOLD = 512;
+// Limit for the inflated length of a received batch
+constexpr size_t NETWORK_BATCH_MAX_INFLATED_LENGTH = 1024 * 1024;
+
+enum NETWORK_BATCH_FLAG : uint8
+{
+    NETWORK_BATCH_FLAG_DEFLATED = 1 << 0,
+};
+
+bool NetworkBatchWriter::TryAdd(std::shared_ptr<const NetworkPacket> packet)
+{
+    size_t length = sizeof(uint16) + packet->Data.size();
+    if (_length + length > NETWORK_BATCH_MAX_LENGTH)
+    {
+        return false;
+    }
+    _packets.push_back(std::move(packet));
+    _length += length;
+    return true;
+}
+
+std::shared_ptr<const NetworkPacket> NetworkBatchWriter::Finish()
+{
+    std::shared_ptr<const NetworkPacket> result;
+    if (_packets.size() == 1)
+    {
+        result = std::move(_packets[0]);
+    }
+    else
+    {
+        // Layout: command (u32), flags (u8), [inflated length (u32)], then per packet its size (u16) and data
+        std::vector<uint8> payload;
+        payload.reserve(_length);
+        for (const auto &packet : _packets)
+        {
+            uint16 sizeBE = Convert::HostToNetwork((uint16)packet->Data.size());
+            payload.insert(payload.end(), (const uint8 *)&sizeBE, (const uint8 *)&sizeBE + sizeof(sizeBE));
+            payload.insert(payload.end(), packet->Data.begin(), packet->Data.end());
+        }
+
+        auto batch = NetworkPacket::Allocate();
+        *batch << (uint32)NETWORK_COMMAND_BATCH;
+        bool deflated = false;
+        if (payload.size() >= NETWORK_BATCH_COMPRESSION_THRESHOLD)
+        {
+            uLongf compressedLength = compressBound((uLong)payload.size());
+            std::vector<uint8> compressed(compressedLength);
+            if (compress2(compressed.data(), &compressedLength, payload.data(), (uLong)payload.size(), Z_BEST_SPEED) == Z_OK &&
+                compressedLength + sizeof(uint32) < payload.size())
+            {
+                *batch << (uint8)NETWORK_BATCH_FLAG_DEFLATED << (uint32)payload.size();
+                batch->Write(compressed.data(), compressedLength);
+                deflated = true;
+            }
+        }
+        if (!deflated)
+        {
+            *batch << (uint8)0;
+            batch->Write(payload.data(), payload.size());
+        }
+        batch->Size = (uint16)batch->Data.size();
+        result = std::move(batch);
+    }
+    _packets.clear();
+    _length = 0;
+    return result;
+}
+
+void NetworkBatchCache::Write(const std::vector<std::shared_ptr<const NetworkPacket>> &packets,
+                              std::vector<std::shared_ptr<const NetworkPacket>> &batches)
+{
+    for (const auto &entry : _entries)
+    {
+        if (entry.Packets.size() == packets.size() &&
+            std::equal(packets.begin(), packets.end(), entry.Packets.begin(),
+                       [](const std::shared_ptr<const NetworkPacket> &a, const NetworkPacket * b) { return a.get() == b; }))
+        {
+            batches.insert(batches.end(), entry.Batches.begin(), entry.Batches.end());
+            return;
+        }
+    }
+
+    Entry entry;
+    for (const auto &packet : packets)
+    {
+        entry.Packets.push_back(packet.get());
+    }
+    NetworkBatch::Write(packets, entry.Batches);
+    batches.insert(batches.end(), entry.Batches.begin(), entry.Batches.end());
+    _entries.push_back(std::move(entry));
+}
+
+void NetworkBatch::Write(const std::vector<std::shared_ptr<const NetworkPacket>> &packets,
+                         std::vector<std::shared_ptr<const NetworkPacket>> &batches)
+{
+    NetworkBatchWriter batchWriter;
+    for (const auto &packet : packets)
+    {
+        if (!batchWriter.TryAdd(packet))
+        {
+            if (!batchWriter.IsEmpty())
+            {
+                batches.push_back(batchWriter.Finish());
+            }
+            if (!batchWriter.TryAdd(packet))
+            {
+                // Too large to share a batch, e.g. map chunks
+                batches.push_back(packet);
+            }
+        }
+    }
+    if (!batchWriter.IsEmpty())
+    {
+        batches.push_back(batchWriter.Finish());
+    }
+}
+
+bool NetworkBatch::Read(NetworkPacket &batch, std::vector<NetworkPacket> &packets)
+{
+    uint8 flags;
+    batch >> flags;
+
+    std::vector<uint8> inflated;
+    const uint8 * payload;
+    size_t payloadLength;
+    if (flags & NETWORK_BATCH_FLAG_DEFLATED)
+    {
+        uint32 inflatedLength;
+        batch >> inflatedLength;
+        if (inflatedLength > NETWORK_BATCH_MAX_INFLATED_LENGTH || batch.BytesRead > batch.Size)
+        {
+            return false;
+        }
+        size_t compressedLength = batch.Size - batch.BytesRead;
+        const uint8 * compressed = batch.Read(compressedLength);
+        inflated.resize(inflatedLength);
+        uLongf length = inflatedLength;
+        if (compressed == nullptr ||
+            uncompress(inflated.data(), &length, compressed, (uLong)compressedLength) != Z_OK ||
+            length != inflatedLength)
+        {
+            return false;
+        }
+        payload = inflated.data();
+        payloadLength = inflated.size();
+    }
+    else
+    {
+        if (batch.BytesRead > batch.Size)
+        {
+            return false;
+        }
+        payloadLength = batch.Size - batch.BytesRead;
+        payload = batch.Read(payloadLength);
+        if (payload == nullptr)
+        {
+            return false;
+        }
+    }
+
+    size_t offset = 0;
+    while (offset < payloadLength)
+    {
+        if (offset + sizeof(uint16) > payloadLength)
+        {
+            return false;
+        }
+        uint16 size = ByteSwapBE(*(const uint16 *)&payload[offset]);
+        offset += sizeof(uint16);
+        if (size == 0 || offset + size > payloadLength)
+        {
+            return false;
+        }
+
+        NetworkPacket packet;
+        packet.Write(&payload[offset], size);
+        packet.Size = size;
+        packets.push_back(std::move(packet));
+        offset += size;
+    }
+    return true;
+}
+
+#endif // DISABLE_NETWORK
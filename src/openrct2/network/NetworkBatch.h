@@ -0,0 +1,90 @@
+#pragma region Copyright (c) 2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#pragma once
+
+#ifndef DISABLE_NETWORK
+
+#include <memory>
+#include <vector>
+#include "../common.h"
+#include "NetworkPacket.h"
+
+/**
+ * Coalesces the packets queued for a connection into NETWORK_COMMAND_BATCH packets so that a tick's
+ * worth of small packets goes out as one frame. Large batches are deflated.
+ */
+class NetworkBatchWriter final
+{
+private:
+    std::vector<std::shared_ptr<const NetworkPacket>>   _packets;
+    size_t                                              _length = 0;
+
+public:
+    bool IsEmpty() const { return _packets.empty(); }
+
+    /**
+     * Adds a packet to the batch.
+     * @returns false if the packet does not fit in what is left of the batch.
+     */
+    bool TryAdd(std::shared_ptr<const NetworkPacket> packet);
+
+    /**
+     * Builds the batch and starts a new one. A batch of one packet is returned as that packet.
+     */
+    std::shared_ptr<const NetworkPacket> Finish();
+};
+
+/**
+ * The batches built from runs of broadcast packets during one flush of every connection. Connections that
+ * queued the same run share its batches instead of each building and deflating their own.
+ */
+class NetworkBatchCache final
+{
+private:
+    struct Entry
+    {
+        std::vector<const NetworkPacket *>                  Packets;
+        std::vector<std::shared_ptr<const NetworkPacket>>   Batches;
+    };
+
+    std::vector<Entry> _entries;
+
+public:
+    /**
+     * Appends the batches for the given packets to batches, building them only if no other connection
+     * queued the same packets in the same order.
+     */
+    void Write(const std::vector<std::shared_ptr<const NetworkPacket>> &packets,
+               std::vector<std::shared_ptr<const NetworkPacket>> &batches);
+};
+
+namespace NetworkBatch
+{
+    /**
+     * Coalesces the packets into as few batches as they fit in, appending the batches to batches.
+     */
+    void Write(const std::vector<std::shared_ptr<const NetworkPacket>> &packets,
+               std::vector<std::shared_ptr<const NetworkPacket>> &batches);
+
+    /**
+     * Splits a NETWORK_COMMAND_BATCH packet, whose command has already been read, into the packets it holds.
+     * @returns false if the batch is malformed.
+     */
+    bool Read(NetworkPacket &batch, std::vector<NetworkPacket> &packets);
+}
+
+#endif // DISABLE_NETWORK
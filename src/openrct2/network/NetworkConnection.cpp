@@ -16,8 +16,12 @@
 
 #ifndef DISABLE_NETWORK
 
+#include <algorithm>
 #include "network.h"
+#include "NetworkBatch.h"
 #include "NetworkConnection.h"
+#include "NetworkIOThread.h"
+#include "TcpSocket.h"
 #include "../core/String.hpp"
 
 #include "../localisation/Localisation.h"
@@ -38,11 +42,52 @@ NetworkConnection::~NetworkConnection()
 
 sint32 NetworkConnection::ReadPacket()
 {
-    if (InboundPacket.BytesTransferred < sizeof(InboundPacket.Size))
+    if (_ioThread != nullptr)
+    {
+        if (ReadQueuedPacket())
+        {
+            return NETWORK_READPACKET_SUCCESS;
+        }
+        // The I/O thread queues everything it read before flagging the disconnect, so look once more
+        if (_ioDisconnected)
+        {
+            return ReadQueuedPacket() ? NETWORK_READPACKET_SUCCESS : NETWORK_READPACKET_DISCONNECTED;
+        }
+        return NETWORK_READPACKET_NO_DATA;
+    }
+
+    sint32 status = ReadPacket(InboundPacket);
+    if (status == NETWORK_READPACKET_SUCCESS)
+    {
+        _lastPacketTime = platform_get_ticks();
+    }
+    return status;
+}
+
+bool NetworkConnection::ReadQueuedPacket()
+{
+    std::unique_ptr<NetworkPacket> packet;
+    if (_inboundQueue->TryPop(packet))
+    {
+        InboundPacket = std::move(*packet);
+        _lastPacketTime = platform_get_ticks();
+        if (_ioReadPaused)
+        {
+            // There is room in the queue again, the I/O thread is not waiting on the socket meanwhile
+            _ioThread->Wake();
+        }
+        return true;
+    }
+    return false;
+}
+
+sint32 NetworkConnection::ReadPacket(NetworkPacket &packet)
+{
+    if (packet.BytesTransferred < sizeof(packet.Size))
     {
         // read packet size
-        void * buffer = &((char*)&InboundPacket.Size)[InboundPacket.BytesTransferred];
-        size_t bufferLength = sizeof(InboundPacket.Size) - InboundPacket.BytesTransferred;
+        void * buffer = &((char*)&packet.Size)[packet.BytesTransferred];
+        size_t bufferLength = sizeof(packet.Size) - packet.BytesTransferred;
         size_t readBytes;
         NETWORK_READPACKET status = Socket->ReceiveData(buffer, bufferLength, &readBytes);
         if (status != NETWORK_READPACKET_SUCCESS)
@@ -50,24 +95,24 @@ sint32 NetworkConnection::ReadPacket()
             return status;
         }
 
-        InboundPacket.BytesTransferred += readBytes;
-        if (InboundPacket.BytesTransferred == sizeof(InboundPacket.Size))
+        packet.BytesTransferred += readBytes;
+        if (packet.BytesTransferred == sizeof(packet.Size))
         {
-            InboundPacket.Size = Convert::NetworkToHost(InboundPacket.Size);
-            if (InboundPacket.Size == 0) // Can't have a size 0 packet
+            packet.Size = Convert::NetworkToHost(packet.Size);
+            if (packet.Size == 0) // Can't have a size 0 packet
             {
                 return NETWORK_READPACKET_DISCONNECTED;
             }
-            InboundPacket.Data.resize(InboundPacket.Size);
+            packet.Data.resize(packet.Size);
         }
     }
     else
     {
         // read packet data
-        if (InboundPacket.Data.capacity() > 0)
+        if (packet.Data.capacity() > 0)
         {
-            void * buffer = &InboundPacket.GetData()[InboundPacket.BytesTransferred - sizeof(InboundPacket.Size)];
-            size_t bufferLength = sizeof(InboundPacket.Size) + InboundPacket.Size - InboundPacket.BytesTransferred;
+            void * buffer = &packet.GetData()[packet.BytesTransferred - sizeof(packet.Size)];
+            size_t bufferLength = sizeof(packet.Size) + packet.Size - packet.BytesTransferred;
             size_t readBytes;
             NETWORK_READPACKET status = Socket->ReceiveData(buffer, bufferLength, &readBytes);
             if (status != NETWORK_READPACKET_SUCCESS)
@@ -75,67 +120,346 @@ sint32 NetworkConnection::ReadPacket()
                 return status;
             }
 
-            InboundPacket.BytesTransferred += readBytes;
+            packet.BytesTransferred += readBytes;
         }
-        if (InboundPacket.BytesTransferred == sizeof(InboundPacket.Size) + InboundPacket.Size)
+        if (packet.BytesTransferred == sizeof(packet.Size) + packet.Size)
         {
-            _lastPacketTime = platform_get_ticks();
+            Stats.RecordReceived(packet.GetCommand(), packet.BytesTransferred);
             return NETWORK_READPACKET_SUCCESS;
         }
     }
     return NETWORK_READPACKET_MORE_DATA;
 }
 
-bool NetworkConnection::SendPacket(NetworkPacket& packet)
+void NetworkConnection::QueuePacket(std::unique_ptr<NetworkPacket> packet, bool front)
 {
-    uint16 sizen = Convert::HostToNetwork(packet.Size);
-    std::vector<uint8> tosend;
-    tosend.reserve(sizeof(sizen) + packet.Size);
-    tosend.insert(tosend.end(), (uint8*)&sizen, (uint8*)&sizen + sizeof(sizen));
-    tosend.insert(tosend.end(), packet.Data.begin(), packet.Data.end());
+    packet->Size = (uint16)packet->Data.size();
+    QueueOutboundPacket(std::shared_ptr<const NetworkPacket>(std::move(packet)), front, false);
+}
 
-    const void * buffer = &tosend[packet.BytesTransferred];
-    size_t bufferSize = tosend.size() - packet.BytesTransferred;
-    size_t sent = Socket->SendData(buffer, bufferSize);
-    if (sent > 0)
-    {
-        packet.BytesTransferred += sent;
-    }
-    return packet.BytesTransferred == tosend.size();
+void NetworkConnection::QueuePacket(std::shared_ptr<const NetworkPacket> packet, bool front)
+{
+    QueueOutboundPacket(std::move(packet), front, true);
 }
 
-void NetworkConnection::QueuePacket(std::unique_ptr<NetworkPacket> packet, bool front)
+void NetworkConnection::QueueOutboundPacket(std::shared_ptr<const NetworkPacket> packet, bool front, bool shared)
 {
     if (AuthStatus == NETWORK_AUTH_OK || !packet->CommandRequiresAuth())
     {
-        packet->Size = (uint16)packet->Data.size();
+        OutboundPacket outboundPacket;
+        outboundPacket.SizeBE = Convert::HostToNetwork((uint16)packet->Data.size());
+        outboundPacket.Packet = std::move(packet);
+        outboundPacket.Shared = shared;
+        outboundPacket.Priority = front;
         if (front)
         {
-            // If the first packet was already partially sent add new packet to second position
-            if (!_outboundPackets.empty() && _outboundPackets.front()->BytesTransferred > 0)
+            PushFront(_outboundPackets, std::move(outboundPacket));
+        }
+        else
+        {
+            _outboundPackets.push_back(std::move(outboundPacket));
+        }
+    }
+}
+
+void NetworkConnection::PushFront(RingBuffer<OutboundPacket> &packets, OutboundPacket outboundPacket)
+{
+    // If the first packet was already partially sent add new packet to second position
+    if (!packets.empty() && packets.front().BytesTransferred > 0)
+    {
+        auto partiallySent = std::move(packets.front());
+        packets.pop_front();
+        packets.push_front(std::move(outboundPacket));
+        packets.push_front(std::move(partiallySent));
+    }
+    else
+    {
+        packets.push_front(std::move(outboundPacket));
+    }
+}
+
+void NetworkConnection::SendQueuedPackets(NetworkBatchCache * batchCache)
+{
+    if (BatchPackets && AuthStatus == NETWORK_AUTH_OK)
+    {
+        BatchQueuedPackets(batchCache);
+    }
+
+    if (_ioThread != nullptr)
+    {
+        // Packets queued at the front skip the packets the I/O thread already holds, unless too many are waiting
+        while (!_outboundPackets.empty() &&
+               _outboundPackets.front().Priority &&
+               _outboundPriorityQueue->TryPush(_outboundPackets.front().Packet))
+        {
+            _outboundPackets.pop_front();
+            _ioQueuedPackets++;
+        }
+        while (!_outboundPackets.empty() && _outboundQueue->TryPush(_outboundPackets.front().Packet))
+        {
+            _outboundPackets.pop_front();
+            _ioQueuedPackets++;
+        }
+        _ioThread->Wake();
+        Stats.SetQueueDepth(_outboundPackets.size() + _ioQueuedPackets);
+    }
+    else
+    {
+        SendPackets(_outboundPackets);
+        Stats.SetQueueDepth(_outboundPackets.size());
+    }
+}
+
+void NetworkConnection::BatchQueuedPackets(NetworkBatchCache * batchCache)
+{
+    // A packet that has started being sent must stay where it is
+    size_t numSending = (!_outboundPackets.empty() && _outboundPackets.front().BytesTransferred > 0) ? 1 : 0;
+    if (_outboundPackets.size() - numSending < 2)
+    {
+        return;
+    }
+
+    RingBuffer<OutboundPacket> batchedPackets;
+    if (numSending != 0)
+    {
+        batchedPackets.push_back(std::move(_outboundPackets.front()));
+        _outboundPackets.pop_front();
+    }
+
+    // Packets queued at the front are sent on their own so they keep their place
+    while (!_outboundPackets.empty() && _outboundPackets.front().Priority)
+    {
+        batchedPackets.push_back(std::move(_outboundPackets.front()));
+        _outboundPackets.pop_front();
+    }
+
+    // Runs of shared packets are batched apart from the packets queued for this connection alone, so that
+    // every connection that queued the same run can be sent the same batches
+    std::vector<std::shared_ptr<const NetworkPacket>> run;
+    std::vector<std::shared_ptr<const NetworkPacket>> batches;
+    while (!_outboundPackets.empty())
+    {
+        bool shared = _outboundPackets.front().Shared;
+        while (!_outboundPackets.empty() && _outboundPackets.front().Shared == shared)
+        {
+            run.push_back(std::move(_outboundPackets.front().Packet));
+            _outboundPackets.pop_front();
+        }
+
+        if (shared && batchCache != nullptr)
+        {
+            batchCache->Write(run, batches);
+        }
+        else
+        {
+            NetworkBatch::Write(run, batches);
+        }
+        RecordBatchedPackets(run, batches);
+        for (auto &batch : batches)
+        {
+            OutboundPacket outboundPacket;
+            outboundPacket.SizeBE = Convert::HostToNetwork((uint16)batch->Data.size());
+            outboundPacket.Packet = std::move(batch);
+            outboundPacket.Shared = shared;
+            batchedPackets.push_back(std::move(outboundPacket));
+        }
+        run.clear();
+        batches.clear();
+    }
+    _outboundPackets = std::move(batchedPackets);
+}
+
+void NetworkConnection::RecordBatchedPackets(const std::vector<std::shared_ptr<const NetworkPacket>> &packets,
+                                             const std::vector<std::shared_ptr<const NetworkPacket>> &batches)
+{
+    // Packets too large to batch, or alone in their batch, are sent as they are and counted when sent.
+    // Both lists are in queue order, so the search for each packet carries on from the last one found.
+    size_t next = 0;
+    for (const auto &packet : packets)
+    {
+        auto it = std::find(batches.begin() + next, batches.end(), packet);
+        if (it != batches.end())
+        {
+            next = (size_t)(it - batches.begin()) + 1;
+        }
+        else
+        {
+            Stats.RecordSentBatched(packet->GetCommand(), sizeof(uint16) + packet->Data.size());
+        }
+    }
+}
+
+bool NetworkConnection::SendPackets(RingBuffer<OutboundPacket> &packets)
+{
+    // Each packet is sent as its size followed by its data, gathered from the queue into a single write
+    constexpr size_t MAX_PACKETS_PER_WRITE = 64;
+    SocketBuffer buffers[MAX_PACKETS_PER_WRITE * 2];
+    while (!packets.empty())
+    {
+        size_t numBuffers = 0;
+        size_t numBytes = 0;
+        for (size_t i = 0; i < packets.size() && i < MAX_PACKETS_PER_WRITE; i++)
+        {
+            const auto &outboundPacket = packets[i];
+            const auto &data = outboundPacket.Packet->Data;
+            size_t offset = outboundPacket.BytesTransferred;
+            if (offset < sizeof(outboundPacket.SizeBE))
             {
-                auto it = _outboundPackets.begin();
-                it++; // Second position
-                _outboundPackets.insert(it, std::move(packet));
+                buffers[numBuffers++] = { (const uint8 *)&outboundPacket.SizeBE + offset, sizeof(outboundPacket.SizeBE) - offset };
+                offset = 0;
             }
             else
             {
-                _outboundPackets.push_front(std::move(packet));
+                offset -= sizeof(outboundPacket.SizeBE);
+            }
+            if (offset < data.size())
+            {
+                buffers[numBuffers++] = { data.data() + offset, data.size() - offset };
             }
         }
-        else
+        for (size_t i = 0; i < numBuffers; i++)
+        {
+            numBytes += buffers[i].Length;
+        }
+
+        size_t sent = Socket->SendData(buffers, numBuffers);
+        bool allSent = sent == numBytes;
+        while (sent > 0)
         {
-            _outboundPackets.push_back(std::move(packet));
+            auto &outboundPacket = packets.front();
+            size_t packetLength = sizeof(outboundPacket.SizeBE) + outboundPacket.Packet->Data.size();
+            size_t remaining = packetLength - outboundPacket.BytesTransferred;
+            if (sent < remaining)
+            {
+                outboundPacket.BytesTransferred += sent;
+                break;
+            }
+            sent -= remaining;
+            Stats.RecordSent(outboundPacket.Packet->GetCommand(), packetLength);
+            packets.pop_front();
+            if (&packets == &_ioOutboundPackets)
+            {
+                _ioQueuedPackets--;
+            }
         }
+        if (!allSent)
+        {
+            // The socket would block, try the rest on the next update
+            Stats.RecordSendStall();
+            return false;
+        }
+    }
+    return true;
+}
+
+void NetworkConnection::Disconnect()
+{
+    if (_ioThread != nullptr)
+    {
+        SendQueuedPackets();
+        _disconnectRequested = true;
+        _ioThread->Wake();
+    }
+    else
+    {
+        Socket->Disconnect();
     }
 }
 
-void NetworkConnection::SendQueuedPackets()
+void NetworkConnection::SetIOThread(NetworkIOThread * ioThread)
 {
-    while (!_outboundPackets.empty() && SendPacket(*_outboundPackets.front()))
+    _inboundQueue = std::make_unique<SpscQueue<std::unique_ptr<NetworkPacket>>>(1024);
+    _outboundQueue = std::make_unique<SpscQueue<std::shared_ptr<const NetworkPacket>>>(4096);
+    _outboundPriorityQueue = std::make_unique<SpscQueue<std::shared_ptr<const NetworkPacket>>>(64);
+    _ioThread = ioThread;
+}
+
+bool NetworkConnection::UpdateIO(ISocketSet &socketSet)
+{
+    if (_ioDisconnected)
+    {
+        return false;
+    }
+
+    if (_ioReadPaused && _inboundQueue->TryPush(_ioPendingInboundPacket))
+    {
+        _ioReadPaused = false;
+        socketSet.SetReading(Socket, true);
+    }
+
+    // Read until the socket runs out of data or the game thread falls behind
+    while (!_ioReadPaused && (_ioPendingInboundPacket == nullptr || _inboundQueue->TryPush(_ioPendingInboundPacket)))
+    {
+        sint32 status = ReadPacket(_ioInboundPacket);
+        if (status == NETWORK_READPACKET_SUCCESS)
+        {
+            _ioPendingInboundPacket = std::make_unique<NetworkPacket>(std::move(_ioInboundPacket));
+            _ioPendingInboundPacket->BytesTransferred = 0;
+            _ioInboundPacket = NetworkPacket();
+        }
+        else if (status == NETWORK_READPACKET_DISCONNECTED)
+        {
+            if (_ioPendingInboundPacket == nullptr || _inboundQueue->TryPush(_ioPendingInboundPacket))
+            {
+                _ioDisconnected = true;
+                return false;
+            }
+            // The disconnect is read again once the last packet fits in the queue
+            break;
+        }
+        else if (status == NETWORK_READPACKET_NO_DATA)
+        {
+            break;
+        }
+    }
+
+    if (_ioPendingInboundPacket != nullptr && !_ioReadPaused)
+    {
+        // Stop waking up for the socket until the game thread makes room, checking once more in case it
+        // already did before it could see the flag
+        _ioReadPaused = true;
+        if (_inboundQueue->TryPush(_ioPendingInboundPacket))
+        {
+            _ioReadPaused = false;
+        }
+        else
+        {
+            socketSet.SetReading(Socket, false);
+        }
+    }
+
+    // Priority packets go ahead of everything not yet started, in the order they were queued
+    std::shared_ptr<const NetworkPacket> packet;
+    std::vector<std::shared_ptr<const NetworkPacket>> priorityPackets;
+    while (_outboundPriorityQueue->TryPop(packet))
+    {
+        priorityPackets.push_back(std::move(packet));
+    }
+    for (auto it = priorityPackets.rbegin(); it != priorityPackets.rend(); it++)
+    {
+        OutboundPacket outboundPacket;
+        outboundPacket.SizeBE = Convert::HostToNetwork((uint16)(*it)->Data.size());
+        outboundPacket.Packet = std::move(*it);
+        outboundPacket.Priority = true;
+        PushFront(_ioOutboundPackets, std::move(outboundPacket));
+    }
+
+    while (_outboundQueue->TryPop(packet))
+    {
+        OutboundPacket outboundPacket;
+        outboundPacket.SizeBE = Convert::HostToNetwork((uint16)packet->Data.size());
+        outboundPacket.Packet = std::move(packet);
+        _ioOutboundPackets.push_back(std::move(outboundPacket));
+    }
+
+    bool allSent = SendPackets(_ioOutboundPackets);
+    if (allSent && _disconnectRequested && !_ioDisconnectSent &&
+        _outboundQueue->IsEmpty() && _outboundPriorityQueue->IsEmpty())
     {
-        _outboundPackets.remove(_outboundPackets.front());
+        Socket->Disconnect();
+        _ioDisconnectSent = true;
     }
+    return !allSent;
 }
 
 void NetworkConnection::ResetLastPacketTime()
@@ -17,17 +17,24 @@
 #pragma once
 
 #ifndef DISABLE_NETWORK
-#include <list>
+#include <atomic>
 #include <memory>
 #include <vector>
 
 #include "../common.h"
+#include "../core/RingBuffer.hpp"
+#include "../core/SpscQueue.hpp"
 
 #include "NetworkTypes.h"
+#include "NetworkGameCommand.h"
 #include "NetworkKey.h"
 #include "NetworkPacket.h"
+#include "NetworkStats.h"
 
+interface ISocketSet;
 interface ITcpSocket;
+class NetworkBatchCache;
+class NetworkIOThread;
 class NetworkPlayer;
 struct ObjectRepositoryItem;
 
@@ -42,26 +49,96 @@ public:
     NetworkKey                                  Key;
     std::vector<uint8>                          Challenge;
     std::vector<const ObjectRepositoryItem *>   RequestedObjects;
+    // Coalesce the packets queued between sends into batches once authenticated
+    bool                                        BatchPackets    = false;
+    // Command ticks sent directly on this connection and received from it
+    NetworkCommandTickState                     SentCommandTicks;
+    NetworkCommandTickState                     ReceivedCommandTicks;
+    NetworkConnectionStats                      Stats;
 
     NetworkConnection();
     ~NetworkConnection();
 
     sint32  ReadPacket();
     void QueuePacket(std::unique_ptr<NetworkPacket> packet, bool front = false);
-    void SendQueuedPackets();
+    /**
+     * Queues a packet that may also be queued on other connections. The packet must not be changed after
+     * it has been queued.
+     */
+    void QueuePacket(std::shared_ptr<const NetworkPacket> packet, bool front = false);
+    /**
+     * Sends the queued packets, or passes them to the I/O thread. Batches of shared packets are taken from
+     * batchCache, if given, so that connections flushed together build each of them only once.
+     */
+    void SendQueuedPackets(NetworkBatchCache * batchCache = nullptr);
     void ResetLastPacketTime();
     bool ReceivedPacketRecently();
 
+    /**
+     * Closes the connection once the packets queued so far have been sent.
+     */
+    void Disconnect();
+
+    /**
+     * Hands the socket over to an I/O thread. From then on ReadPacket returns packets read by that thread
+     * and SendQueuedPackets passes packets to it rather than sending them.
+     */
+    void SetIOThread(NetworkIOThread * ioThread);
+
+    /**
+     * Called on the I/O thread to read and send whatever the socket allows without blocking. While the game
+     * thread has not taken the packets already read, the socket is left out of the waits on socketSet.
+     * @returns true if there is data the socket would not take yet.
+     */
+    bool UpdateIO(ISocketSet &socketSet);
+
     const utf8 * GetLastDisconnectReason() const;
     void SetLastDisconnectReason(const utf8 * src);
     void SetLastDisconnectReason(const rct_string_id string_id, void * args = nullptr);
 
 private:
-    std::list<std::unique_ptr<NetworkPacket>>   _outboundPackets;
+    struct OutboundPacket
+    {
+        std::shared_ptr<const NetworkPacket>    Packet;
+        uint16                                  SizeBE              = 0;
+        size_t                                  BytesTransferred    = 0;
+        // Queued as a shared packet, may be on other connections' queues too
+        bool                                    Shared              = false;
+        // Queued at the front, sent ahead of the packets queued before it
+        bool                                    Priority            = false;
+    };
+
+    RingBuffer<OutboundPacket>                  _outboundPackets;
     uint32                                      _lastPacketTime;
     utf8 *                                      _lastDisconnectReason   = nullptr;
 
-    bool SendPacket(NetworkPacket &packet);
+    // Packets passed between the game thread and the I/O thread
+    NetworkIOThread *                                                   _ioThread = nullptr;
+    std::unique_ptr<SpscQueue<std::unique_ptr<NetworkPacket>>>          _inboundQueue;
+    std::unique_ptr<SpscQueue<std::shared_ptr<const NetworkPacket>>>    _outboundQueue;
+    // Packets queued at the front, which the I/O thread sends before anything it already holds
+    std::unique_ptr<SpscQueue<std::shared_ptr<const NetworkPacket>>>    _outboundPriorityQueue;
+    std::atomic_bool                                                    _ioDisconnected         = { false };
+    std::atomic_bool                                                    _disconnectRequested    = { false };
+    // Packets passed to the I/O thread and not yet fully sent, for the queue depth
+    std::atomic<uint32>                                                 _ioQueuedPackets        = { 0 };
+    // Set by the I/O thread when it stopped reading because the inbound queue is full
+    std::atomic_bool                                                    _ioReadPaused           = { false };
+
+    // Only used by the I/O thread
+    NetworkPacket                               _ioInboundPacket;
+    std::unique_ptr<NetworkPacket>              _ioPendingInboundPacket;
+    RingBuffer<OutboundPacket>                  _ioOutboundPackets;
+    bool                                        _ioDisconnectSent = false;
+
+    void QueueOutboundPacket(std::shared_ptr<const NetworkPacket> packet, bool front, bool shared);
+    static void PushFront(RingBuffer<OutboundPacket> &packets, OutboundPacket outboundPacket);
+    void BatchQueuedPackets(NetworkBatchCache * batchCache);
+    void RecordBatchedPackets(const std::vector<std::shared_ptr<const NetworkPacket>> &packets,
+                              const std::vector<std::shared_ptr<const NetworkPacket>> &batches);
+    sint32 ReadPacket(NetworkPacket &packet);
+    bool SendPackets(RingBuffer<OutboundPacket> &packets);
+    bool ReadQueuedPacket();
 };
 
 #endif // DISABLE_NETWORK
@@ -0,0 +1,223 @@
+#pragma region Copyright (c) 2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#ifndef DISABLE_NETWORK
+
+#include <initializer_list>
+#include "../core/VarInt.hpp"
+#include "../Game.h"
+#include "NetworkGameCommand.h"
+#include "NetworkPacket.h"
+
+enum
+{
+    ARG_EAX,
+    ARG_EBX,
+    ARG_ECX,
+    ARG_EDX,
+    ARG_ESI,
+    ARG_EDI,
+    ARG_EBP,
+};
+
+enum GAMECMD_FIELD : uint8
+{
+    GAMECMD_FIELD_UNSIGNED,     // Plain varint
+    GAMECMD_FIELD_SIGNED,       // Zigzag varint, for values that may be negative
+    GAMECMD_FIELD_DELTA_EAX,    // Signed difference from eax, e.g. the far x of an area
+    GAMECMD_FIELD_DELTA_ECX,    // Signed difference from ecx, e.g. the far y of an area
+    GAMECMD_FIELD_RANGE16,      // Low 16 bits, then the high 16 bits as a signed difference from them
+};
+
+struct GameCommandSchema
+{
+    GAMECMD_FIELD Fields[NetworkGameCommand::NUM_ARGS];
+};
+
+static constexpr GameCommandSchema DefaultSchema = { {
+    GAMECMD_FIELD_UNSIGNED, GAMECMD_FIELD_UNSIGNED, GAMECMD_FIELD_UNSIGNED, GAMECMD_FIELD_UNSIGNED,
+    GAMECMD_FIELD_UNSIGNED, GAMECMD_FIELD_UNSIGNED, GAMECMD_FIELD_UNSIGNED } };
+
+// Area tools: (eax, ecx) to (edi, ebp)
+static constexpr GameCommandSchema AreaSchema = { {
+    GAMECMD_FIELD_UNSIGNED, GAMECMD_FIELD_UNSIGNED, GAMECMD_FIELD_UNSIGNED, GAMECMD_FIELD_UNSIGNED,
+    GAMECMD_FIELD_UNSIGNED, GAMECMD_FIELD_DELTA_EAX, GAMECMD_FIELD_DELTA_ECX } };
+
+// Land tools: centre in (eax, ecx), x bounds packed in edx and y bounds packed in ebp
+static constexpr GameCommandSchema LandSchema = { {
+    GAMECMD_FIELD_UNSIGNED, GAMECMD_FIELD_UNSIGNED, GAMECMD_FIELD_UNSIGNED, GAMECMD_FIELD_RANGE16,
+    GAMECMD_FIELD_UNSIGNED, GAMECMD_FIELD_UNSIGNED, GAMECMD_FIELD_RANGE16 } };
+
+// Cheats pass amounts such as money in edx
+static constexpr GameCommandSchema CheatSchema = { {
+    GAMECMD_FIELD_UNSIGNED, GAMECMD_FIELD_UNSIGNED, GAMECMD_FIELD_UNSIGNED, GAMECMD_FIELD_SIGNED,
+    GAMECMD_FIELD_UNSIGNED, GAMECMD_FIELD_UNSIGNED, GAMECMD_FIELD_UNSIGNED } };
+
+static const GameCommandSchema * GetSchema(uint32 command)
+{
+    switch (command) {
+    case GAME_COMMAND_CLEAR_SCENERY:
+    case GAME_COMMAND_CHANGE_SURFACE_STYLE:
+    case GAME_COMMAND_RAISE_WATER:
+    case GAME_COMMAND_LOWER_WATER:
+    case GAME_COMMAND_BUY_LAND_RIGHTS:
+        return &AreaSchema;
+    case GAME_COMMAND_RAISE_LAND:
+    case GAME_COMMAND_LOWER_LAND:
+    case GAME_COMMAND_EDIT_LAND_SMOOTH:
+        return &LandSchema;
+    case GAME_COMMAND_CHEAT:
+        return &CheatSchema;
+    default:
+        return &DefaultSchema;
+    }
+}
+
+static uint32 EncodeField(GAMECMD_FIELD field, uint32 value, const uint32 args[NetworkGameCommand::NUM_ARGS])
+{
+    switch (field) {
+    case GAMECMD_FIELD_SIGNED:
+        return VarInt::ZigZagEncode((sint32)value);
+    case GAMECMD_FIELD_DELTA_EAX:
+        return VarInt::ZigZagEncode((sint32)(value - args[ARG_EAX]));
+    case GAMECMD_FIELD_DELTA_ECX:
+        return VarInt::ZigZagEncode((sint32)(value - args[ARG_ECX]));
+    case GAMECMD_FIELD_RANGE16:
+    {
+        uint16 low = value & 0xFFFF;
+        uint16 high = value >> 16;
+        return low | (VarInt::ZigZagEncode((sint16)(high - low)) << 16);
+    }
+    default:
+        return value;
+    }
+}
+
+static uint32 DecodeField(GAMECMD_FIELD field, uint32 value, const uint32 args[NetworkGameCommand::NUM_ARGS])
+{
+    switch (field) {
+    case GAMECMD_FIELD_SIGNED:
+        return (uint32)VarInt::ZigZagDecode(value);
+    case GAMECMD_FIELD_DELTA_EAX:
+        return args[ARG_EAX] + (uint32)VarInt::ZigZagDecode(value);
+    case GAMECMD_FIELD_DELTA_ECX:
+        return args[ARG_ECX] + (uint32)VarInt::ZigZagDecode(value);
+    case GAMECMD_FIELD_RANGE16:
+    {
+        uint16 low = value & 0xFFFF;
+        uint16 high = (uint16)(low + VarInt::ZigZagDecode(value >> 16));
+        return low | (high << 16);
+    }
+    default:
+        return value;
+    }
+}
+
+void NetworkGameCommand::WriteTick(NetworkPacket& packet, NetworkCommandTickState& state, uint32 tick)
+{
+    // The lowest bit tells whether the rest is the tick itself or a signed delta from the last one
+    if (state.Valid)
+    {
+        packet.WriteVarUInt(VarInt::ZigZagEncode((sint32)(tick - state.LastTick)) << 1);
+    }
+    else
+    {
+        packet.WriteVarUInt(1);
+        packet.WriteVarUInt(tick);
+    }
+    state.LastTick = tick;
+    state.Valid = true;
+}
+
+uint32 NetworkGameCommand::ReadTick(NetworkPacket& packet, NetworkCommandTickState& state)
+{
+    uint32 value = packet.ReadVarUInt();
+    uint32 tick;
+    if (value & 1)
+    {
+        tick = packet.ReadVarUInt();
+    }
+    else
+    {
+        tick = state.LastTick + (uint32)VarInt::ZigZagDecode(value >> 1);
+    }
+    state.LastTick = tick;
+    state.Valid = true;
+    return tick;
+}
+
+void NetworkGameCommand::WriteArgs(NetworkPacket& packet, const uint32 args[NUM_ARGS])
+{
+    // The command comes first as it selects the schema for the other registers
+    uint32 command = args[ARG_ESI];
+    const GameCommandSchema * schema = GetSchema(command);
+
+    uint32 encoded[NUM_ARGS];
+    uint8 presentMask = 0;
+    for (size_t i = 0; i < NUM_ARGS; i++)
+    {
+        uint32 value = args[i];
+        if (i == ARG_EBX)
+        {
+            value &= ~GAME_COMMAND_FLAG_NETWORKED;
+        }
+        encoded[i] = EncodeField(schema->Fields[i], value, args);
+        if (encoded[i] != 0)
+        {
+            presentMask |= 1 << i;
+        }
+    }
+
+    packet.WriteVarUInt(command);
+    packet << (uint8)(presentMask & ~(1 << ARG_ESI));
+    for (size_t i = 0; i < NUM_ARGS; i++)
+    {
+        if (i != ARG_ESI && (presentMask & (1 << i)))
+        {
+            packet.WriteVarUInt(encoded[i]);
+        }
+    }
+}
+
+void NetworkGameCommand::ReadArgs(NetworkPacket& packet, uint32 args[NUM_ARGS])
+{
+    uint32 command = packet.ReadVarUInt();
+    const GameCommandSchema * schema = GetSchema(command);
+
+    uint8 presentMask;
+    packet >> presentMask;
+
+    uint32 encoded[NUM_ARGS] = {};
+    for (size_t i = 0; i < NUM_ARGS; i++)
+    {
+        if (i != ARG_ESI && (presentMask & (1 << i)))
+        {
+            encoded[i] = packet.ReadVarUInt();
+        }
+    }
+
+    // eax and ecx are plain in every schema, so decode them before the registers that are relative to them
+    args[ARG_ESI] = command;
+    args[ARG_EAX] = DecodeField(schema->Fields[ARG_EAX], encoded[ARG_EAX], args);
+    args[ARG_ECX] = DecodeField(schema->Fields[ARG_ECX], encoded[ARG_ECX], args);
+    for (size_t i : { ARG_EBX, ARG_EDX, ARG_EDI, ARG_EBP })
+    {
+        args[i] = DecodeField(schema->Fields[i], encoded[i], args);
+    }
+    args[ARG_EBX] |= GAME_COMMAND_FLAG_NETWORKED;
+}
+
+#endif
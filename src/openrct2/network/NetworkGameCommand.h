@@ -0,0 +1,55 @@
+#pragma region Copyright (c) 2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#pragma once
+
+#include "../common.h"
+
+class NetworkPacket;
+
+/**
+ * The tick of the last command sent or received on one packet stream. Command ticks are written as a delta
+ * from the previous command in the same stream, so both ends of the stream must see every command.
+ */
+struct NetworkCommandTickState
+{
+    uint32  LastTick = 0;
+    bool    Valid = false;
+
+    void Reset()
+    {
+        Valid = false;
+    }
+};
+
+/**
+ * Compact encoding of game command registers and ticks. Registers that encode to zero are omitted and the
+ * rest are written as varints, using a per-command schema to turn coordinates into small deltas.
+ */
+namespace NetworkGameCommand
+{
+    constexpr size_t NUM_ARGS = 7;
+
+    void   WriteTick(NetworkPacket& packet, NetworkCommandTickState& state, uint32 tick);
+    uint32 ReadTick(NetworkPacket& packet, NetworkCommandTickState& state);
+
+    /**
+     * Writes the registers eax, ebx, ecx, edx, esi, edi and ebp, in that order. The networked flag is
+     * dropped from ebx and set again when read.
+     */
+    void WriteArgs(NetworkPacket& packet, const uint32 args[NUM_ARGS]);
+    void ReadArgs(NetworkPacket& packet, uint32 args[NUM_ARGS]);
+}
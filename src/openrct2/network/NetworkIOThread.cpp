@@ -0,0 +1,86 @@
+#pragma region Copyright (c) 2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#ifndef DISABLE_NETWORK
+
+#include <algorithm>
+#include "network.h"
+#include "NetworkConnection.h"
+#include "NetworkIOThread.h"
+#include "TcpSocket.h"
+
+// How long the thread waits for data when it has nothing left to send
+constexpr uint32 NETWORK_IO_IDLE_TIMEOUT = 100;
+// How long the thread waits before retrying when a socket would not take all of its pending data
+constexpr uint32 NETWORK_IO_BUSY_TIMEOUT = 1;
+
+NetworkIOThread::NetworkIOThread()
+    : _socketSet(CreateSocketSet())
+{
+    _thread = std::thread(&NetworkIOThread::Run, this);
+}
+
+NetworkIOThread::~NetworkIOThread()
+{
+    _shouldStop = true;
+    _socketSet->Wake();
+    _thread.join();
+}
+
+void NetworkIOThread::AddConnection(NetworkConnection * connection)
+{
+    std::lock_guard<std::mutex> lock(_connectionsMutex);
+    _connections.push_back(connection);
+    _socketSet->Add(connection->Socket);
+    connection->SetIOThread(this);
+}
+
+void NetworkIOThread::RemoveConnection(NetworkConnection * connection)
+{
+    std::lock_guard<std::mutex> lock(_connectionsMutex);
+    auto it = std::find(_connections.begin(), _connections.end(), connection);
+    if (it != _connections.end())
+    {
+        _connections.erase(it);
+        _socketSet->Remove(connection->Socket);
+    }
+}
+
+void NetworkIOThread::Wake()
+{
+    _socketSet->Wake();
+}
+
+void NetworkIOThread::Run()
+{
+    while (!_shouldStop)
+    {
+        bool isBusy = false;
+        {
+            std::lock_guard<std::mutex> lock(_connectionsMutex);
+            for (auto connection : _connections)
+            {
+                if (connection->UpdateIO(*_socketSet))
+                {
+                    isBusy = true;
+                }
+            }
+        }
+        _socketSet->Wait(isBusy ? NETWORK_IO_BUSY_TIMEOUT : NETWORK_IO_IDLE_TIMEOUT);
+    }
+}
+
+#endif // DISABLE_NETWORK
@@ -0,0 +1,64 @@
+#pragma region Copyright (c) 2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#pragma once
+
+#ifndef DISABLE_NETWORK
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../common.h"
+
+interface ISocketSet;
+class NetworkConnection;
+
+/**
+ * Owns the sockets of the server's client connections. Reads, packet framing and writes all happen on
+ * this thread so that the game thread only handles complete packets and never waits on a socket.
+ */
+class NetworkIOThread final
+{
+private:
+    std::unique_ptr<ISocketSet>         _socketSet;
+    std::vector<NetworkConnection *>    _connections;
+    std::mutex                          _connectionsMutex;
+    std::atomic_bool                    _shouldStop = { false };
+    std::thread                         _thread;
+
+public:
+    NetworkIOThread();
+    ~NetworkIOThread();
+
+    void AddConnection(NetworkConnection * connection);
+
+    /**
+     * Stops servicing the connection. Once this returns the thread will no longer touch it.
+     */
+    void RemoveConnection(NetworkConnection * connection);
+
+    /**
+     * Wakes the thread up to send packets that have just been handed to it.
+     */
+    void Wake();
+
+private:
+    void Run();
+};
+
+#endif // DISABLE_NETWORK
@@ -18,6 +18,7 @@
 
 #include "NetworkTypes.h"
 #include "NetworkPacket.h"
+#include "../core/VarInt.hpp"
 
 
 uint8 * NetworkPacket::GetData()
@@ -25,11 +26,11 @@ uint8 * NetworkPacket::GetData()
     return Data.data();
 }
 
-uint32 NetworkPacket::GetCommand()
+uint32 NetworkPacket::GetCommand() const
 {
     if (Data.size() >= sizeof(uint32))
     {
-        return ByteSwapBE(*(uint32 *)(Data.data()));
+        return ByteSwapBE(*(const uint32 *)(Data.data()));
     }
     else
     {
@@ -44,7 +45,7 @@ void NetworkPacket::Clear()
     Data.clear();
 }
 
-bool NetworkPacket::CommandRequiresAuth()
+bool NetworkPacket::CommandRequiresAuth() const
 {
     switch (GetCommand()) {
     case NETWORK_COMMAND_PING:
@@ -68,6 +69,17 @@ void NetworkPacket::WriteString(const utf8 * string)
     Write((uint8 *)string, strlen(string) + 1);
 }
 
+void NetworkPacket::WriteVarUInt(uint32 value)
+{
+    uint8 buffer[VarInt::MAX_LENGTH];
+    Write(buffer, VarInt::Encode(value, buffer));
+}
+
+void NetworkPacket::WriteVarSInt(sint32 value)
+{
+    WriteVarUInt(VarInt::ZigZagEncode(value));
+}
+
 const uint8 * NetworkPacket::Read(size_t size)
 {
     if (BytesRead + size > NetworkPacket::Size)
@@ -99,4 +111,27 @@ const utf8 * NetworkPacket::ReadString()
     return str;
 }
 
+uint32 NetworkPacket::ReadVarUInt()
+{
+    uint32 value = 0;
+    size_t length = 0;
+    if (BytesRead < Size)
+    {
+        length = VarInt::Decode(&GetData()[BytesRead], Size - BytesRead, &value);
+    }
+    if (length == 0)
+    {
+        // Consume the rest so that following reads also fail
+        BytesRead = Size;
+        return 0;
+    }
+    BytesRead += length;
+    return value;
+}
+
+sint32 NetworkPacket::ReadVarSInt()
+{
+    return VarInt::ZigZagDecode(ReadVarUInt());
+}
+
 #endif
@@ -35,22 +35,22 @@ public:
         return std::make_unique<NetworkPacket>(); // change to make_unique in c++14
     }
 
-    inline static std::unique_ptr<NetworkPacket> Duplicate(NetworkPacket &packet)
-    {
-        return std::make_unique<NetworkPacket>(packet); // change to make_unique in c++14
-    }
-
     uint8 * GetData();
-    uint32  GetCommand();
+    uint32  GetCommand() const;
 
     void Clear();
-    bool CommandRequiresAuth();
+    bool CommandRequiresAuth() const;
 
     const uint8 * Read(size_t size);
     const utf8 *  ReadString();
+    // Varints read as 0 when truncated, like the fixed width reads below
+    uint32        ReadVarUInt();
+    sint32        ReadVarSInt();
 
     void Write(const uint8 * bytes, size_t size);
     void WriteString(const utf8 * string);
+    void WriteVarUInt(uint32 value);
+    void WriteVarSInt(sint32 value);
 
     template <typename T>
     NetworkPacket & operator >>(T &value)
@@ -0,0 +1,425 @@
+#pragma region Copyright (c) 2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#ifndef DISABLE_NETWORK
+
+#include <algorithm>
+#include "network.h"
+#include "NetworkBatch.h"
+#include "NetworkConnection.h"
+#include "NetworkIOThread.h"
+#include "NetworkRelay.h"
+#include "TcpSocket.h"
+
+#include "../core/Console.hpp"
+#include "../object/ObjectManager.h"
+#include "../platform/platform.h"
+
+// Spectators all share one player and group id, which servers never assign
+constexpr uint8 RELAY_SPECTATOR_ID = 255;
+constexpr size_t RELAY_MAX_SPECTATORS = 1024;
+constexpr uint32 RELAY_PING_INTERVAL = 3000;
+// Beyond these a new snapshot is taken for the next spectator to join
+constexpr uint32 RELAY_SNAPSHOT_MAX_AGE = 60000;
+constexpr size_t RELAY_BACKLOG_MAX_SIZE = 4 * 1024 * 1024;
+
+NetworkRelay::NetworkRelay(Network &network)
+    : _network(network)
+{
+}
+
+NetworkRelay::~NetworkRelay()
+{
+    // Stop the I/O thread before the connections it services are deleted
+    _ioThread = nullptr;
+    _spectators.clear();
+}
+
+bool NetworkRelay::Begin(uint16 port, const char * address)
+{
+    if (address != nullptr && address[0] == '\0')
+    {
+        address = nullptr;
+    }
+
+    _listeningSocket = std::unique_ptr<ITcpSocket>(CreateTcpSocket());
+    try
+    {
+        _listeningSocket->Listen(address, port);
+    }
+    catch (const std::exception &ex)
+    {
+        Console::Error::WriteLine(ex.what());
+        return false;
+    }
+
+    _ioThread = std::make_unique<NetworkIOThread>();
+    log_info("Relaying to spectators on port %u", port);
+    return true;
+}
+
+void NetworkRelay::Update()
+{
+    ITcpSocket * socket = _listeningSocket->Accept();
+    if (socket != nullptr)
+    {
+        AddSpectator(socket);
+    }
+
+    auto it = _spectators.begin();
+    while (it != _spectators.end())
+    {
+        if (!ProcessSpectator(**it))
+        {
+            _ioThread->RemoveConnection((*it)->Connection.get());
+            it = _spectators.erase(it);
+        }
+        else
+        {
+            it++;
+        }
+    }
+
+    bool anyJoining = std::any_of(_spectators.begin(), _spectators.end(), [](const std::unique_ptr<Spectator> &spectator) {
+        return spectator->Joining;
+    });
+    if (anyJoining)
+    {
+        // If a new snapshot can't be taken yet, an older one and its longer backlog still work
+        if (IsSnapshotStale())
+        {
+            TakeSnapshot();
+        }
+        if (!_snapshot.empty())
+        {
+            for (auto &spectator : _spectators)
+            {
+                if (spectator->Joining)
+                {
+                    SendSnapshot(*spectator);
+                }
+            }
+        }
+    }
+    else if (!_snapshot.empty() && IsSnapshotStale())
+    {
+        // Nobody would join from it, so stop growing the backlog
+        ClearSnapshot();
+    }
+
+    uint32 ticks = platform_get_ticks();
+    if (ticks > _lastPingTime + RELAY_PING_INTERVAL)
+    {
+        _lastPingTime = ticks;
+        std::unique_ptr<NetworkPacket> packet(NetworkPacket::Allocate());
+        *packet << (uint32)NETWORK_COMMAND_PING;
+        Broadcast(std::move(packet), false);
+    }
+
+    NetworkBatchCache batchCache;
+    for (auto &spectator : _spectators)
+    {
+        spectator->Connection->SendQueuedPackets(&batchCache);
+    }
+}
+
+size_t NetworkRelay::GetSpectatorCount() const
+{
+    return _spectators.size();
+}
+
+void NetworkRelay::SetGameInfo(const NetworkPacket &packet)
+{
+    std::unique_ptr<NetworkPacket> copy(NetworkPacket::Allocate());
+    copy->Write(packet.Data.data(), packet.Size);
+    copy->Size = packet.Size;
+    _gameInfo = std::move(copy);
+}
+
+void NetworkRelay::RelayPacket(const NetworkPacket &packet)
+{
+    std::unique_ptr<NetworkPacket> copy(NetworkPacket::Allocate());
+    copy->Write(packet.Data.data(), packet.Size);
+    Broadcast(std::move(copy));
+}
+
+void NetworkRelay::RelayGameCommand(uint32 tick, const uint32 args[NetworkGameCommand::NUM_ARGS], uint8 playerId, uint8 callback)
+{
+    // Commands are encoded again as their ticks are deltas within the stream they are sent on
+    std::unique_ptr<NetworkPacket> packet(NetworkPacket::Allocate());
+    *packet << (uint32)NETWORK_COMMAND_GAMECMD;
+    NetworkGameCommand::WriteTick(*packet, _commandTicks, tick);
+    NetworkGameCommand::WriteArgs(*packet, args);
+    *packet << playerId << callback;
+    Broadcast(std::move(packet));
+}
+
+void NetworkRelay::RelayGameAction(uint32 tick, uint32 type, const uint8 * data, size_t size)
+{
+    std::unique_ptr<NetworkPacket> packet(NetworkPacket::Allocate());
+    *packet << (uint32)NETWORK_COMMAND_GAME_ACTION;
+    NetworkGameCommand::WriteTick(*packet, _commandTicks, tick);
+    packet->WriteVarUInt(type);
+    packet->Write(data, size);
+    Broadcast(std::move(packet));
+}
+
+void NetworkRelay::RelayPlayerList()
+{
+    Broadcast(CreatePlayerListPacket());
+}
+
+void NetworkRelay::OnMapLoaded()
+{
+    _mapLoaded = true;
+    ClearSnapshot();
+
+    // Spectators already watching need the new park as well
+    for (auto &spectator : _spectators)
+    {
+        if (spectator->Joined)
+        {
+            spectator->Joined = false;
+            spectator->Joining = true;
+        }
+    }
+}
+
+void NetworkRelay::AddSpectator(ITcpSocket * socket)
+{
+    auto spectator = std::make_unique<Spectator>();
+    spectator->Connection = std::make_unique<NetworkConnection>();
+    spectator->Connection->Socket = socket;
+    spectator->Connection->BatchPackets = true;
+    _network.AppendServerLog(std::string("Spectator connected from ") + socket->GetHostName());
+    _ioThread->AddConnection(spectator->Connection.get());
+    _spectators.push_back(std::move(spectator));
+}
+
+bool NetworkRelay::ProcessSpectator(Spectator &spectator)
+{
+    NetworkConnection &connection = *spectator.Connection;
+    sint32 packetStatus;
+    do {
+        packetStatus = connection.ReadPacket();
+        switch (packetStatus) {
+        case NETWORK_READPACKET_DISCONNECTED:
+            return false;
+        case NETWORK_READPACKET_SUCCESS:
+            ProcessPacket(spectator, connection.InboundPacket);
+            if (connection.Socket == nullptr) {
+                return false;
+            }
+            break;
+        }
+    } while (packetStatus == NETWORK_READPACKET_MORE_DATA || packetStatus == NETWORK_READPACKET_SUCCESS);
+    return connection.ReceivedPacketRecently();
+}
+
+void NetworkRelay::ProcessPacket(Spectator &spectator, NetworkPacket &packet)
+{
+    NetworkConnection &connection = *spectator.Connection;
+    uint32 command;
+    packet >> command;
+    switch (command) {
+    case NETWORK_COMMAND_GAMEINFO:
+        if (_gameInfo != nullptr) {
+            connection.QueuePacket(_gameInfo);
+        }
+        break;
+    case NETWORK_COMMAND_TOKEN:
+    {
+        // Spectators cannot change the game, so the signed challenge is never checked
+        uint8 tokenSize = 10 + (rand() & 0x7f);
+        std::unique_ptr<NetworkPacket> reply(NetworkPacket::Allocate());
+        *reply << (uint32)NETWORK_COMMAND_TOKEN << (uint32)tokenSize;
+        for (uint8 i = 0; i < tokenSize; i++) {
+            *reply << (uint8)(rand() & 0xff);
+        }
+        connection.QueuePacket(std::move(reply));
+        break;
+    }
+    case NETWORK_COMMAND_AUTH:
+        HandleAuth(spectator, packet);
+        break;
+    case NETWORK_COMMAND_OBJECTS:
+        // Sent in reply to the empty object list, the snapshot carries every object the park needs
+        if (connection.AuthStatus == NETWORK_AUTH_OK && !spectator.Joined) {
+            spectator.Joining = true;
+        }
+        break;
+    case NETWORK_COMMAND_GAMECMD:
+    case NETWORK_COMMAND_GAME_ACTION:
+        if (connection.AuthStatus == NETWORK_AUTH_OK) {
+            std::unique_ptr<NetworkPacket> reply(NetworkPacket::Allocate());
+            *reply << (uint32)NETWORK_COMMAND_SHOWERROR << (rct_string_id)STR_CANT_DO_THIS << (rct_string_id)STR_PERMISSION_DENIED;
+            connection.QueuePacket(std::move(reply));
+        }
+        break;
+    default:
+        // Pings only keep the connection alive and chat is not passed upstream
+        break;
+    }
+    packet.Clear();
+}
+
+void NetworkRelay::HandleAuth(Spectator &spectator, NetworkPacket &packet)
+{
+    NetworkConnection &connection = *spectator.Connection;
+    if (connection.AuthStatus == NETWORK_AUTH_OK) {
+        return;
+    }
+
+    const char * gameversion = packet.ReadString();
+    const char * name = packet.ReadString();
+    if (!gameversion || network_get_version() != gameversion) {
+        connection.AuthStatus = NETWORK_AUTH_BADVERSION;
+    } else if (!name) {
+        connection.AuthStatus = NETWORK_AUTH_BADNAME;
+    } else if (_spectators.size() > RELAY_MAX_SPECTATORS) {
+        connection.AuthStatus = NETWORK_AUTH_FULL;
+    } else {
+        connection.AuthStatus = NETWORK_AUTH_OK;
+    }
+
+    std::unique_ptr<NetworkPacket> reply(NetworkPacket::Allocate());
+    *reply << (uint32)NETWORK_COMMAND_AUTH << (uint32)connection.AuthStatus << RELAY_SPECTATOR_ID;
+    if (connection.AuthStatus == NETWORK_AUTH_BADVERSION) {
+        reply->WriteString(network_get_version().c_str());
+    }
+    connection.QueuePacket(std::move(reply));
+
+    if (connection.AuthStatus == NETWORK_AUTH_OK) {
+        std::unique_ptr<NetworkPacket> objects(NetworkPacket::Allocate());
+        *objects << (uint32)NETWORK_COMMAND_OBJECTS << (uint32)0;
+        connection.QueuePacket(std::move(objects));
+        _network.AppendServerLog(std::string("Spectator ") + name + " joined");
+    } else {
+        connection.SendQueuedPackets();
+        connection.Disconnect();
+    }
+}
+
+bool NetworkRelay::IsSnapshotStale() const
+{
+    return _snapshot.empty() ||
+           platform_get_ticks() > _snapshotTime + RELAY_SNAPSHOT_MAX_AGE ||
+           _backlogSize > RELAY_BACKLOG_MAX_SIZE;
+}
+
+bool NetworkRelay::TakeSnapshot()
+{
+    // Queued commands are already gone from the backlog but not yet part of the park
+    if (!_mapLoaded || !_network.game_command_queue.empty()) {
+        return false;
+    }
+
+    IObjectManager * objManager = GetObjectManager();
+    size_t size;
+    uint8 * data = _network.save_for_network(size, objManager->GetPackableObjects());
+    if (data == nullptr) {
+        return false;
+    }
+
+    ClearSnapshot();
+    size_t chunksize = 65000;
+    for (size_t i = 0; i < size; i += chunksize) {
+        size_t datasize = std::min(chunksize, size - i);
+        std::unique_ptr<NetworkPacket> packet(NetworkPacket::Allocate());
+        *packet << (uint32)NETWORK_COMMAND_MAP << (uint32)size << (uint32)i;
+        packet->Write(&data[i], datasize);
+        packet->Size = (uint16)packet->Data.size();
+        _snapshot.push_back(std::move(packet));
+    }
+    free(data);
+
+    _snapshotTime = platform_get_ticks();
+    // The first command after the snapshot has to carry a full tick for spectators joining from it
+    _commandTicks.Reset();
+    log_verbose("Relay took a snapshot of %u bytes", (uint32)size);
+    return true;
+}
+
+void NetworkRelay::ClearSnapshot()
+{
+    _snapshot.clear();
+    _backlog.clear();
+    _backlogSize = 0;
+}
+
+void NetworkRelay::SendSnapshot(Spectator &spectator)
+{
+    NetworkConnection &connection = *spectator.Connection;
+    connection.QueuePacket(CreateGroupListPacket());
+    for (const auto &packet : _snapshot) {
+        connection.QueuePacket(packet);
+    }
+    for (const auto &packet : _backlog) {
+        connection.QueuePacket(packet);
+    }
+    connection.QueuePacket(CreatePlayerListPacket());
+    spectator.Joining = false;
+    spectator.Joined = true;
+}
+
+void NetworkRelay::Broadcast(std::unique_ptr<NetworkPacket> packet, bool keepInBacklog)
+{
+    packet->Size = (uint16)packet->Data.size();
+    std::shared_ptr<const NetworkPacket> sharedPacket = std::move(packet);
+    for (auto &spectator : _spectators) {
+        if (spectator->Joined) {
+            spectator->Connection->QueuePacket(sharedPacket);
+        }
+    }
+    if (keepInBacklog && !_snapshot.empty()) {
+        _backlogSize += sharedPacket->Size;
+        _backlog.push_back(std::move(sharedPacket));
+    }
+}
+
+std::unique_ptr<NetworkPacket> NetworkRelay::CreatePlayerListPacket() const
+{
+    // Each spectator sees itself as one extra player in a group without any permissions
+    size_t count = std::min<size_t>(_network.player_list.size(), 254);
+    std::unique_ptr<NetworkPacket> packet(NetworkPacket::Allocate());
+    *packet << (uint32)NETWORK_COMMAND_PLAYERLIST << (uint8)(count + 1);
+    for (size_t i = 0; i < count; i++) {
+        _network.player_list[i]->Write(*packet);
+    }
+    NetworkPlayer spectator;
+    spectator.Id = RELAY_SPECTATOR_ID;
+    spectator.Group = RELAY_SPECTATOR_ID;
+    spectator.SetName("Spectator");
+    spectator.Write(*packet);
+    return packet;
+}
+
+std::unique_ptr<NetworkPacket> NetworkRelay::CreateGroupListPacket() const
+{
+    size_t count = std::min<size_t>(_network.group_list.size(), 254);
+    std::unique_ptr<NetworkPacket> packet(NetworkPacket::Allocate());
+    *packet << (uint32)NETWORK_COMMAND_GROUPLIST << (uint8)(count + 1) << _network.default_group;
+    for (size_t i = 0; i < count; i++) {
+        _network.group_list[i]->Write(*packet);
+    }
+    NetworkGroup spectators;
+    spectators.Id = RELAY_SPECTATOR_ID;
+    spectators.SetName("Spectators");
+    spectators.Write(*packet);
+    return packet;
+}
+
+#endif // DISABLE_NETWORK
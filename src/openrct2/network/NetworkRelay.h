@@ -0,0 +1,94 @@
+#pragma region Copyright (c) 2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#pragma once
+
+#ifndef DISABLE_NETWORK
+
+#include <list>
+#include <memory>
+#include <vector>
+#include "../common.h"
+#include "NetworkGameCommand.h"
+
+interface ITcpSocket;
+class Network;
+class NetworkConnection;
+class NetworkIOThread;
+class NetworkPacket;
+
+/**
+ * Re-serves the game a client receives from its upstream server to read-only spectators, so that large
+ * audiences do not each need a connection to the authoritative server. Spectators joining are sent a cached
+ * snapshot of the park followed by the packets relayed since the snapshot was taken.
+ */
+class NetworkRelay final
+{
+private:
+    struct Spectator
+    {
+        std::unique_ptr<NetworkConnection>  Connection;
+        // Waiting for a snapshot of the park to be sent
+        bool                                Joining     = false;
+        bool                                Joined      = false;
+    };
+
+    Network &                                           _network;
+    std::unique_ptr<ITcpSocket>                         _listeningSocket;
+    std::list<std::unique_ptr<Spectator>>               _spectators;
+    std::unique_ptr<NetworkIOThread>                    _ioThread;
+    std::shared_ptr<const NetworkPacket>                _gameInfo;
+    std::vector<std::shared_ptr<const NetworkPacket>>   _snapshot;
+    std::vector<std::shared_ptr<const NetworkPacket>>   _backlog;
+    size_t                                              _backlogSize    = 0;
+    uint32                                              _snapshotTime   = 0;
+    uint32                                              _lastPingTime   = 0;
+    bool                                                _mapLoaded      = false;
+    NetworkCommandTickState                             _commandTicks;
+
+public:
+    explicit NetworkRelay(Network &network);
+    ~NetworkRelay();
+
+    bool Begin(uint16 port, const char * address);
+    void Update();
+    size_t GetSpectatorCount() const;
+
+    // Called by the client as it handles packets from the upstream server
+    void SetGameInfo(const NetworkPacket &packet);
+    void RelayPacket(const NetworkPacket &packet);
+    void RelayGameCommand(uint32 tick, const uint32 args[NetworkGameCommand::NUM_ARGS], uint8 playerId, uint8 callback);
+    void RelayGameAction(uint32 tick, uint32 type, const uint8 * data, size_t size);
+    void RelayPlayerList();
+    void OnMapLoaded();
+
+private:
+    void AddSpectator(ITcpSocket * socket);
+    bool ProcessSpectator(Spectator &spectator);
+    void ProcessPacket(Spectator &spectator, NetworkPacket &packet);
+    void HandleAuth(Spectator &spectator, NetworkPacket &packet);
+
+    bool IsSnapshotStale() const;
+    bool TakeSnapshot();
+    void ClearSnapshot();
+    void SendSnapshot(Spectator &spectator);
+    void Broadcast(std::unique_ptr<NetworkPacket> packet, bool keepInBacklog = true);
+
+    std::unique_ptr<NetworkPacket> CreatePlayerListPacket() const;
+    std::unique_ptr<NetworkPacket> CreateGroupListPacket() const;
+};
+
+#endif // DISABLE_NETWORK
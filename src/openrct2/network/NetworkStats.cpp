@@ -0,0 +1,316 @@
+#pragma region Copyright (c) 2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#ifndef DISABLE_NETWORK
+
+#include <algorithm>
+#include "NetworkStats.h"
+#include "TcpSocket.h"
+
+#include "../core/Console.hpp"
+#include "../core/Util.hpp"
+#include "../platform/platform.h"
+
+constexpr uint32 NetworkConnectionStats::RTT_BUCKET_LIMITS[];
+
+// Requests that have not been answered by then are dropped
+constexpr uint32 STATS_REQUEST_TIMEOUT = 5000;
+constexpr size_t STATS_MAX_REQUESTS = 16;
+constexpr size_t STATS_MAX_REQUEST_SIZE = 8192;
+
+static const char * NetworkCommandNames[] =
+{
+    "auth",
+    "map",
+    "chat",
+    "gamecmd",
+    "tick",
+    "playerlist",
+    "ping",
+    "pinglist",
+    "setdisconnectmsg",
+    "gameinfo",
+    "showerror",
+    "grouplist",
+    "event",
+    "token",
+    "objects",
+    "game_action",
+    "batch",
+};
+
+const char * network_get_command_name(uint32 command)
+{
+    static_assert(Util::CountOf(NetworkCommandNames) == NETWORK_COMMAND_MAX, "Missing network command names");
+    return command < NETWORK_COMMAND_MAX ? NetworkCommandNames[command] : "invalid";
+}
+
+NetworkConnectionStats::NetworkConnectionStats()
+{
+    ConnectTime = platform_get_ticks();
+}
+
+void NetworkConnectionStats::RecordReceived(uint32 command, size_t bytes)
+{
+    auto &counters = Received[std::min<uint32>(command, NETWORK_COMMAND_MAX)];
+    counters.Bytes.fetch_add(bytes, std::memory_order_relaxed);
+    counters.Packets.fetch_add(1, std::memory_order_relaxed);
+}
+
+void NetworkConnectionStats::RecordSent(uint32 command, size_t bytes)
+{
+    auto &counters = Sent[std::min<uint32>(command, NETWORK_COMMAND_MAX)];
+    counters.Bytes.fetch_add(bytes, std::memory_order_relaxed);
+    counters.Packets.fetch_add(1, std::memory_order_relaxed);
+}
+
+void NetworkConnectionStats::RecordReceivedBatched(uint32 command, size_t bytes)
+{
+    auto &counters = ReceivedBatched[std::min<uint32>(command, NETWORK_COMMAND_MAX)];
+    counters.Bytes.fetch_add(bytes, std::memory_order_relaxed);
+    counters.Packets.fetch_add(1, std::memory_order_relaxed);
+}
+
+void NetworkConnectionStats::RecordSentBatched(uint32 command, size_t bytes)
+{
+    auto &counters = SentBatched[std::min<uint32>(command, NETWORK_COMMAND_MAX)];
+    counters.Bytes.fetch_add(bytes, std::memory_order_relaxed);
+    counters.Packets.fetch_add(1, std::memory_order_relaxed);
+}
+
+void NetworkConnectionStats::RecordSendStall()
+{
+    SendStalls.fetch_add(1, std::memory_order_relaxed);
+}
+
+void NetworkConnectionStats::SetQueueDepth(size_t depth)
+{
+    QueueDepth = (uint32)depth;
+    MaxQueueDepth = std::max(MaxQueueDepth, QueueDepth);
+}
+
+void NetworkConnectionStats::BeginMapTransfer(size_t size)
+{
+    MapTransferSize = (uint32)size;
+    MapTransferStart = Sent[NETWORK_COMMAND_MAP].Bytes;
+}
+
+void NetworkConnectionStats::RecordRoundTrip(uint32 ms)
+{
+    size_t bucket = 0;
+    while (bucket < Util::CountOf(RTT_BUCKET_LIMITS) && ms >= RTT_BUCKET_LIMITS[bucket])
+    {
+        bucket++;
+    }
+    RoundTrips[bucket]++;
+    LastRoundTrip = ms;
+}
+
+uint64 NetworkConnectionStats::GetTotalReceived() const
+{
+    uint64 total = 0;
+    for (const auto &counters : Received)
+    {
+        total += counters.Bytes;
+    }
+    return total;
+}
+
+uint64 NetworkConnectionStats::GetTotalSent() const
+{
+    uint64 total = 0;
+    for (const auto &counters : Sent)
+    {
+        total += counters.Bytes;
+    }
+    return total;
+}
+
+uint32 NetworkConnectionStats::GetMapTransferred() const
+{
+    // Counts the chunk headers too, close enough for a progress figure
+    uint64 transferred = Sent[NETWORK_COMMAND_MAP].Bytes - MapTransferStart;
+    return (uint32)std::min<uint64>(transferred, MapTransferSize);
+}
+
+json_t * NetworkConnectionStats::ToJson() const
+{
+    json_t * jsonCommands = json_object();
+    for (uint32 i = 0; i <= NETWORK_COMMAND_MAX; i++)
+    {
+        if (Received[i].Packets == 0 && Sent[i].Packets == 0 &&
+            ReceivedBatched[i].Packets == 0 && SentBatched[i].Packets == 0)
+        {
+            continue;
+        }
+        json_t * jsonCommand = json_object();
+        json_object_set_new(jsonCommand, "bytes_in", json_integer(Received[i].Bytes));
+        json_object_set_new(jsonCommand, "packets_in", json_integer(Received[i].Packets));
+        json_object_set_new(jsonCommand, "bytes_out", json_integer(Sent[i].Bytes));
+        json_object_set_new(jsonCommand, "packets_out", json_integer(Sent[i].Packets));
+        json_object_set_new(jsonCommand, "batched_bytes_in", json_integer(ReceivedBatched[i].Bytes));
+        json_object_set_new(jsonCommand, "batched_packets_in", json_integer(ReceivedBatched[i].Packets));
+        json_object_set_new(jsonCommand, "batched_bytes_out", json_integer(SentBatched[i].Bytes));
+        json_object_set_new(jsonCommand, "batched_packets_out", json_integer(SentBatched[i].Packets));
+        json_object_set_new(jsonCommands, network_get_command_name(i), jsonCommand);
+    }
+
+    json_t * jsonRoundTrips = json_array();
+    for (size_t i = 0; i < RTT_BUCKET_COUNT; i++)
+    {
+        json_t * jsonBucket = json_object();
+        if (i < Util::CountOf(RTT_BUCKET_LIMITS))
+        {
+            json_object_set_new(jsonBucket, "below_ms", json_integer(RTT_BUCKET_LIMITS[i]));
+        }
+        json_object_set_new(jsonBucket, "count", json_integer(RoundTrips[i]));
+        json_array_append_new(jsonRoundTrips, jsonBucket);
+    }
+
+    json_t * jsonStats = json_object();
+    json_object_set_new(jsonStats, "connected_ms", json_integer(platform_get_ticks() - ConnectTime));
+    json_object_set_new(jsonStats, "bytes_in", json_integer(GetTotalReceived()));
+    json_object_set_new(jsonStats, "bytes_out", json_integer(GetTotalSent()));
+    json_object_set_new(jsonStats, "queue_depth", json_integer(QueueDepth));
+    json_object_set_new(jsonStats, "max_queue_depth", json_integer(MaxQueueDepth));
+    json_object_set_new(jsonStats, "send_stalls", json_integer(SendStalls));
+    json_object_set_new(jsonStats, "map_transferred", json_integer(GetMapTransferred()));
+    json_object_set_new(jsonStats, "map_size", json_integer(MapTransferSize));
+    json_object_set_new(jsonStats, "rtt_ms", json_integer(LastRoundTrip));
+    json_object_set_new(jsonStats, "rtt_histogram", jsonRoundTrips);
+    json_object_set_new(jsonStats, "commands", jsonCommands);
+    return jsonStats;
+}
+
+NetworkStatsEndpoint::NetworkStatsEndpoint()
+{
+}
+
+NetworkStatsEndpoint::~NetworkStatsEndpoint()
+{
+}
+
+bool NetworkStatsEndpoint::Begin(uint16 port)
+{
+    _listeningSocket = std::unique_ptr<ITcpSocket>(CreateTcpSocket());
+    try
+    {
+        _listeningSocket->Listen("127.0.0.1", port);
+    }
+    catch (const std::exception &ex)
+    {
+        Console::Error::WriteLine(ex.what());
+        _listeningSocket = nullptr;
+        return false;
+    }
+    log_info("Serving network statistics on http://127.0.0.1:%u/", port);
+    return true;
+}
+
+void NetworkStatsEndpoint::Update(const std::function<std::string()> &getStats)
+{
+    if (_listeningSocket == nullptr)
+    {
+        return;
+    }
+
+    ITcpSocket * socket = _listeningSocket->Accept();
+    if (socket != nullptr)
+    {
+        if (_requests.size() >= STATS_MAX_REQUESTS)
+        {
+            delete socket;
+        }
+        else
+        {
+            Request request;
+            request.Socket = std::unique_ptr<ITcpSocket>(socket);
+            request.AcceptTime = platform_get_ticks();
+            _requests.push_back(std::move(request));
+        }
+    }
+
+    auto it = _requests.begin();
+    while (it != _requests.end())
+    {
+        if (!ProcessRequest(*it, getStats))
+        {
+            it = _requests.erase(it);
+        }
+        else
+        {
+            it++;
+        }
+    }
+}
+
+bool NetworkStatsEndpoint::ProcessRequest(Request &request, const std::function<std::string()> &getStats)
+{
+    if (platform_get_ticks() - request.AcceptTime > STATS_REQUEST_TIMEOUT)
+    {
+        return false;
+    }
+
+    if (request.Response.empty())
+    {
+        char buffer[1024];
+        size_t readBytes;
+        NETWORK_READPACKET status = request.Socket->ReceiveData(buffer, sizeof(buffer), &readBytes);
+        if (status == NETWORK_READPACKET_DISCONNECTED)
+        {
+            return false;
+        }
+        request.Received.append(buffer, readBytes);
+        if (request.Received.size() > STATS_MAX_REQUEST_SIZE)
+        {
+            return false;
+        }
+
+        // Whatever was asked for, the answer is the same once the request headers are complete
+        if (request.Received.find("\r\n\r\n") == std::string::npos)
+        {
+            return true;
+        }
+        std::string body;
+        std::string statusLine;
+        if (request.Received.compare(0, 4, "GET ") == 0)
+        {
+            body = getStats();
+            statusLine = "200 OK";
+        }
+        else
+        {
+            body = "{}";
+            statusLine = "405 Method Not Allowed";
+        }
+        request.Response = "HTTP/1.1 " + statusLine + "\r\n"
+            "Content-Type: application/json\r\n"
+            "Content-Length: " + std::to_string(body.size()) + "\r\n"
+            "Connection: close\r\n"
+            "\r\n" + body;
+    }
+
+    const char * data = request.Response.data() + request.ResponseSent;
+    request.ResponseSent += request.Socket->SendData(data, request.Response.size() - request.ResponseSent);
+    if (request.ResponseSent < request.Response.size())
+    {
+        return true;
+    }
+    request.Socket->Disconnect();
+    return false;
+}
+
+#endif // DISABLE_NETWORK
@@ -0,0 +1,115 @@
+#pragma region Copyright (c) 2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#pragma once
+
+#ifndef DISABLE_NETWORK
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <jansson.h>
+#include "../common.h"
+#include "NetworkTypes.h"
+
+interface ITcpSocket;
+
+/**
+ * Traffic counters for a single connection. The byte and packet counters are updated by whichever thread
+ * reads from or writes to the socket, the rest only on the game thread.
+ */
+class NetworkConnectionStats final
+{
+public:
+    // Upper bounds in milliseconds of each round trip histogram bucket, the last one is open ended
+    static constexpr uint32 RTT_BUCKET_LIMITS[] = { 25, 50, 100, 200, 400, 800 };
+    static constexpr size_t RTT_BUCKET_COUNT = sizeof(RTT_BUCKET_LIMITS) / sizeof(RTT_BUCKET_LIMITS[0]) + 1;
+
+    struct CommandCounters
+    {
+        std::atomic<uint64> Bytes   = { 0 };
+        std::atomic<uint64> Packets = { 0 };
+    };
+
+    std::array<CommandCounters, NETWORK_COMMAND_MAX + 1>    Received;
+    std::array<CommandCounters, NETWORK_COMMAND_MAX + 1>    Sent;
+    // Packets carried inside batches, by their own size. The batches themselves count towards
+    // NETWORK_COMMAND_BATCH above, so these are not part of the totals
+    std::array<CommandCounters, NETWORK_COMMAND_MAX + 1>    ReceivedBatched;
+    std::array<CommandCounters, NETWORK_COMMAND_MAX + 1>    SentBatched;
+    std::atomic<uint64>                                     SendStalls          = { 0 };
+    uint32                                                  QueueDepth          = 0;
+    uint32                                                  MaxQueueDepth       = 0;
+    uint32                                                  MapTransferSize     = 0;
+    uint64                                                  MapTransferStart    = 0;
+    std::array<uint32, RTT_BUCKET_COUNT>                    RoundTrips          = {};
+    uint32                                                  LastRoundTrip       = 0;
+    uint32                                                  ConnectTime;
+
+    NetworkConnectionStats();
+
+    void RecordReceived(uint32 command, size_t bytes);
+    void RecordSent(uint32 command, size_t bytes);
+    void RecordReceivedBatched(uint32 command, size_t bytes);
+    void RecordSentBatched(uint32 command, size_t bytes);
+    void RecordSendStall();
+    void SetQueueDepth(size_t depth);
+    void BeginMapTransfer(size_t size);
+    void RecordRoundTrip(uint32 ms);
+
+    uint64 GetTotalReceived() const;
+    uint64 GetTotalSent() const;
+    uint32 GetMapTransferred() const;
+
+    json_t * ToJson() const;
+};
+
+/**
+ * Serves the statistics of every connection as JSON to plain HTTP GET requests, meant to be bound to
+ * the loopback address for monitoring tools on the same host.
+ */
+class NetworkStatsEndpoint final
+{
+private:
+    struct Request
+    {
+        std::unique_ptr<ITcpSocket> Socket;
+        std::string                 Received;
+        std::string                 Response;
+        size_t                      ResponseSent    = 0;
+        uint32                      AcceptTime      = 0;
+    };
+
+    std::unique_ptr<ITcpSocket> _listeningSocket;
+    std::list<Request>          _requests;
+
+public:
+    NetworkStatsEndpoint();
+    ~NetworkStatsEndpoint();
+
+    bool Begin(uint16 port);
+    void Update(const std::function<std::string()> &getStats);
+
+private:
+    bool ProcessRequest(Request &request, const std::function<std::string()> &getStats);
+};
+
+const char * network_get_command_name(uint32 command);
+
+#endif // DISABLE_NETWORK
@@ -52,6 +52,7 @@ enum NETWORK_COMMAND
     NETWORK_COMMAND_TOKEN,
     NETWORK_COMMAND_OBJECTS,
     NETWORK_COMMAND_GAME_ACTION,
+    NETWORK_COMMAND_BATCH,
     NETWORK_COMMAND_MAX,
     NETWORK_COMMAND_INVALID = -1
 };
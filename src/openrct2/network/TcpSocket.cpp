@@ -16,11 +16,15 @@
 
 #ifndef DISABLE_NETWORK
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <chrono>
-#include <future>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 // clang-format off
 #ifdef _WIN32
@@ -45,6 +49,8 @@
     #include <netinet/tcp.h>
     #include <netinet/in.h>
     #include <sys/socket.h>
+    #include <sys/uio.h>
+    #include <climits>
     #include <fcntl.h>
     #include "../common.h"
     using SOCKET = sint32;
@@ -55,15 +61,25 @@
     #define ioctlsocket ioctl
     #if defined(__linux__)
         #define FLAG_NO_PIPE MSG_NOSIGNAL
+        #define SOCKET_SET_USE_EPOLL
+        #include <sys/epoll.h>
+        #include <sys/eventfd.h>
+        #include <unistd.h>
     #else
         #define FLAG_NO_PIPE 0
     #endif // defined(__linux__)
 #endif // _WIN32
 // clang-format on
 
+#include "../core/JobPool.hpp"
+#include "../core/Util.hpp"
 #include "TcpSocket.h"
 
+constexpr auto RESOLVE_TIMEOUT = std::chrono::milliseconds(5000);
 constexpr auto CONNECT_TIMEOUT = std::chrono::milliseconds(3000);
+// Time to wait for an attempt before racing the next address (RFC 8305)
+constexpr auto CONNECT_ATTEMPT_DELAY = std::chrono::milliseconds(250);
+constexpr size_t RESOLVER_THREADS = 4;
 
 #ifdef _WIN32
     static bool _wsaInitialised = false;
@@ -230,6 +246,24 @@ int custom_getnameinfo(const struct sockaddr *sa, socklen_t salen,
 }
 class TcpSocket;
 
+struct ResolvedAddress
+{
+    sockaddr_storage    Address;
+    sint32              Length;
+};
+
+/**
+ * A host name lookup owned by a connecting socket. The resolver pool only holds it weakly, so the
+ * socket can give up on it without waiting for getaddrinfo to return.
+ */
+struct ResolveRequest
+{
+    std::string                  Address;
+    uint16                       Port = 0;
+    std::vector<ResolvedAddress> Addresses;
+    std::atomic_bool             Completed = { false };
+};
+
 class SocketException : public std::runtime_error
 {
 public:
@@ -244,9 +278,17 @@ private:
     SOCKET          _socket         = INVALID_SOCKET;
 
     std::string         _hostName;
-    std::future<void>   _connectFuture;
     std::string         _error;
 
+    // Outgoing connection, advanced each time the status is polled
+    std::shared_ptr<ResolveRequest>         _resolveRequest;
+    std::vector<ResolvedAddress>            _connectAddresses;
+    size_t                                  _nextConnectAddress = 0;
+    std::vector<SOCKET>                     _connectAttempts;
+    std::chrono::steady_clock::time_point   _resolveStartTime;
+    std::chrono::steady_clock::time_point   _connectStartTime;
+    std::chrono::steady_clock::time_point   _lastAttemptTime;
+
 public:
     TcpSocket()
     {
@@ -254,15 +296,23 @@ public:
 
     ~TcpSocket() override
     {
-        if (_connectFuture.valid())
-        {
-            _connectFuture.wait();
-        }
         CloseSocket();
     }
 
     SOCKET_STATUS GetStatus() override
     {
+        if (_status == SOCKET_STATUS_RESOLVING || _status == SOCKET_STATUS_CONNECTING)
+        {
+            try
+            {
+                UpdateConnect();
+            }
+            catch (const std::exception &ex)
+            {
+                _error = std::string(ex.what());
+                CloseSocket();
+            }
+        }
         return _status;
     }
 
@@ -389,97 +439,21 @@ public:
 
     void Connect(const char * address, uint16 port) override
     {
-        if (_status != SOCKET_STATUS_CLOSED)
-        {
-            throw std::runtime_error("Socket not closed.");
-        }
-
-        try
+        ConnectAsync(address, port);
+        while (GetStatus() == SOCKET_STATUS_RESOLVING || GetStatus() == SOCKET_STATUS_CONNECTING)
         {
-            // Resolve address
-            _status = SOCKET_STATUS_RESOLVING;
-
-            sockaddr_storage ss;
-            sint32 ss_len = 0;
-            if (!ResolveAddress(address, port, &ss, &ss_len))
-            {
-                throw SocketException("Unable to resolve address.");
-            }
-
-            _status = SOCKET_STATUS_CONNECTING;
-            _socket = socket(ss.ss_family, SOCK_STREAM, IPPROTO_TCP);
-            if (_socket == INVALID_SOCKET)
-            {
-                throw SocketException("Unable to create socket.");
-            }
-
-            SetTCPNoDelay(_socket, true);
-            if (!SetNonBlocking(_socket, true))
-            {
-                throw SocketException("Failed to set non-blocking mode.");
-            }
-
-            // Connect
-            sint32 connectResult = connect(_socket, (sockaddr *)&ss, ss_len);
-            if (connectResult != SOCKET_ERROR || (LAST_SOCKET_ERROR() != EINPROGRESS &&
-                                                  LAST_SOCKET_ERROR() != EWOULDBLOCK))
-            {
-                throw SocketException("Failed to connect.");
-            }
-
-            auto connectStartTime = std::chrono::system_clock::now();
-
-            sint32 error = 0;
-            socklen_t len = sizeof(error);
-            if (getsockopt(_socket, SOL_SOCKET, SO_ERROR, (char *)&error, &len) != 0)
-            {
-                throw SocketException("getsockopt failed with error: " + std::to_string(LAST_SOCKET_ERROR()));
-            }
-            if (error != 0)
-            {
-                throw SocketException("Connection failed: " + std::to_string(error));
-            }
-
-            do
-            {
-                // Sleep for a bit
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
-
-                fd_set writeFD;
-                FD_ZERO(&writeFD);
-#pragma warning(push)
-#pragma warning(disable : 4548) // expression before comma has no effect; expected expression with side-effect
-                FD_SET(_socket, &writeFD);
-#pragma warning(pop)
-                timeval timeout;
-                timeout.tv_sec = 0;
-                timeout.tv_usec = 0;
-                if (select((sint32)(_socket + 1), nullptr, &writeFD, nullptr, &timeout) > 0)
-                {
-                    error = 0;
-                    len = sizeof(error);
-                    if (getsockopt(_socket, SOL_SOCKET, SO_ERROR, (char*)&error, &len) != 0)
-                    {
-                        throw SocketException("getsockopt failed with error: " + std::to_string(LAST_SOCKET_ERROR()));
-                    }
-                    if (error == 0)
-                    {
-                        _status = SOCKET_STATUS_CONNECTED;
-                        return;
-                    }
-                }
-            } while ((std::chrono::system_clock::now() - connectStartTime) < CONNECT_TIMEOUT);
-
-            // Connection request timed out
-            throw SocketException("Connection timed out.");
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
         }
-        catch (const std::exception &)
+        if (_status != SOCKET_STATUS_CONNECTED)
         {
-            CloseSocket();
-            throw;
+            throw SocketException(_error.empty() ? "Failed to connect." : _error);
         }
     }
 
+    /**
+     * Starts connecting without blocking. Host names are looked up on a small shared resolver pool
+     * and the connection attempts are driven by GetStatus, so no thread is spent per connection.
+     */
     void ConnectAsync(const char * address, uint16 port) override
     {
         if (_status != SOCKET_STATUS_CLOSED)
@@ -487,22 +461,49 @@ public:
             throw std::runtime_error("Socket not closed.");
         }
 
-        auto saddress = std::string(address);
-        std::promise<void> barrier;
-        _connectFuture = barrier.get_future();
-        auto thread = std::thread([this, saddress, port](std::promise<void> barrier2) -> void
+        _error.clear();
+        auto request = std::make_shared<ResolveRequest>();
+        request->Address = std::string(address);
+        request->Port = port;
+        _resolveRequest = request;
+        _resolveStartTime = std::chrono::steady_clock::now();
+        _status = SOCKET_STATUS_RESOLVING;
+
+        // Numeric addresses need no lookup
+        if (ResolveAddresses(address, port, true, &request->Addresses))
         {
-            try
-            {
-                Connect(saddress.c_str(), port);
-            }
-            catch (const std::exception &ex)
+            request->Completed = true;
+        }
+        else
+        {
+            // The task only holds the request while it reads or fills it in, a socket that gave up while the
+            // task was still queued behind other lookups releases it and the lookup is skipped
+            std::weak_ptr<ResolveRequest> weakRequest = request;
+            GetResolverPool()->AddTask([weakRequest]() -> void
             {
-                _error = std::string(ex.what());
-            }
-            barrier2.set_value();
-        }, std::move(barrier));
-        thread.detach();
+                std::string hostName;
+                uint16 hostPort;
+                {
+                    auto pendingRequest = weakRequest.lock();
+                    if (pendingRequest == nullptr)
+                    {
+                        return;
+                    }
+                    hostName = pendingRequest->Address;
+                    hostPort = pendingRequest->Port;
+                }
+
+                std::vector<ResolvedAddress> addresses;
+                ResolveAddresses(hostName.c_str(), hostPort, false, &addresses);
+
+                auto pendingRequest = weakRequest.lock();
+                if (pendingRequest != nullptr)
+                {
+                    pendingRequest->Addresses = std::move(addresses);
+                    pendingRequest->Completed = true;
+                }
+            });
+        }
     }
 
     void Disconnect() override
@@ -535,6 +536,56 @@ public:
         return totalSent;
     }
 
+    size_t SendData(const SocketBuffer * buffers, size_t count) override
+    {
+        if (_status != SOCKET_STATUS_CONNECTED)
+        {
+            throw std::runtime_error("Socket not connected.");
+        }
+
+        // Unlike the single buffer variant, this makes one attempt and returns however much the socket accepted
+        size_t totalSent = 0;
+#if defined(_WIN32)
+        std::vector<WSABUF> wsaBuffers(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            wsaBuffers[i].buf = (CHAR *)buffers[i].Data;
+            wsaBuffers[i].len = (ULONG)buffers[i].Length;
+        }
+        DWORD sentBytes = 0;
+        if (WSASend(_socket, wsaBuffers.data(), (DWORD)count, &sentBytes, 0, nullptr, nullptr) == 0)
+        {
+            totalSent = sentBytes;
+        }
+#elif defined(__psp2__) || defined(__WIIU__)
+        for (size_t i = 0; i < count; i++)
+        {
+            size_t sentBytes = SendData(buffers[i].Data, buffers[i].Length);
+            totalSent += sentBytes;
+            if (sentBytes != buffers[i].Length)
+            {
+                break;
+            }
+        }
+#else
+        std::vector<iovec> iovecs(std::min<size_t>(count, IOV_MAX));
+        for (size_t i = 0; i < iovecs.size(); i++)
+        {
+            iovecs[i].iov_base = (void *)buffers[i].Data;
+            iovecs[i].iov_len = buffers[i].Length;
+        }
+        msghdr msg = {};
+        msg.msg_iov = iovecs.data();
+        msg.msg_iovlen = iovecs.size();
+        ssize_t sentBytes = sendmsg(_socket, &msg, FLAG_NO_PIPE);
+        if (sentBytes != SOCKET_ERROR)
+        {
+            totalSent = (size_t)sentBytes;
+        }
+#endif
+        return totalSent;
+    }
+
     NETWORK_READPACKET ReceiveData(void * buffer, size_t size, size_t * sizeReceived) override
     {
         if (_status != SOCKET_STATUS_CONNECTED)
@@ -569,10 +620,6 @@ public:
 
     void Close() override
     {
-        if (_connectFuture.valid())
-        {
-            _connectFuture.wait();
-        }
         CloseSocket();
     }
 
@@ -581,6 +628,22 @@ public:
         return _hostName.empty() ? nullptr : _hostName.c_str();
     }
 
+    SOCKET GetSocket() const
+    {
+        return _socket;
+    }
+
+    static bool SetNonBlocking(SOCKET socket, bool on)
+    {
+#ifdef _WIN32
+        u_long nonBlocking = on;
+        return ioctlsocket(socket, FIONBIO, &nonBlocking) == 0;
+#else
+        sint32 flags = fcntl(socket, F_GETFL, 0);
+        return fcntl(socket, F_SETFL, on ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK)) == 0;
+#endif
+    }
+
 private:
     explicit TcpSocket(SOCKET socket)
     {
@@ -590,6 +653,14 @@ private:
 
     void CloseSocket()
     {
+        for (SOCKET attempt : _connectAttempts)
+        {
+            closesocket(attempt);
+        }
+        _connectAttempts.clear();
+        _connectAddresses.clear();
+        _resolveRequest = nullptr;
+
         if (_socket != INVALID_SOCKET)
         {
             closesocket(_socket);
@@ -598,6 +669,215 @@ private:
         _status = SOCKET_STATUS_CLOSED;
     }
 
+    void UpdateConnect()
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (_status == SOCKET_STATUS_RESOLVING)
+        {
+            if (!_resolveRequest->Completed)
+            {
+                if (now - _resolveStartTime >= RESOLVE_TIMEOUT)
+                {
+                    throw SocketException("Resolving address timed out.");
+                }
+                return;
+            }
+
+            auto request = std::move(_resolveRequest);
+            if (request->Addresses.empty())
+            {
+                throw SocketException("Unable to resolve address.");
+            }
+            _connectAddresses = InterleaveAddressFamilies(request->Addresses);
+            _nextConnectAddress = 0;
+            _connectStartTime = now;
+            _status = SOCKET_STATUS_CONNECTING;
+        }
+
+        if (PollConnectAttempts())
+        {
+            _status = SOCKET_STATUS_CONNECTED;
+            return;
+        }
+
+        // Race the next address if the current attempts are slow or have all failed
+        if (_connectAttempts.empty() || now - _lastAttemptTime >= CONNECT_ATTEMPT_DELAY)
+        {
+            do
+            {
+                if (_nextConnectAddress >= _connectAddresses.size())
+                {
+                    break;
+                }
+                StartConnectAttempt(_connectAddresses[_nextConnectAddress++]);
+                _lastAttemptTime = now;
+            }
+            while (_connectAttempts.empty());
+        }
+
+        if (_connectAttempts.empty())
+        {
+            throw SocketException("Failed to connect.");
+        }
+        if (now - _connectStartTime >= CONNECT_TIMEOUT)
+        {
+            throw SocketException("Connection timed out.");
+        }
+    }
+
+    void StartConnectAttempt(const ResolvedAddress &address)
+    {
+        SOCKET attempt = socket(address.Address.ss_family, SOCK_STREAM, IPPROTO_TCP);
+        if (attempt == INVALID_SOCKET)
+        {
+            log_verbose("Unable to create socket. %d", LAST_SOCKET_ERROR());
+            return;
+        }
+
+        SetTCPNoDelay(attempt, true);
+        if (!SetNonBlocking(attempt, true))
+        {
+            log_verbose("Failed to set non-blocking mode.");
+            closesocket(attempt);
+            return;
+        }
+
+        sint32 connectResult = connect(attempt, (const sockaddr *)&address.Address, address.Length);
+        if (connectResult == SOCKET_ERROR && LAST_SOCKET_ERROR() != EINPROGRESS && LAST_SOCKET_ERROR() != EWOULDBLOCK)
+        {
+            log_verbose("Connect attempt failed. %d", LAST_SOCKET_ERROR());
+            closesocket(attempt);
+            return;
+        }
+        _connectAttempts.push_back(attempt);
+    }
+
+    /**
+     * Checks the pending connection attempts without blocking. The first one to complete becomes
+     * the socket and the others are abandoned; failed attempts are dropped.
+     */
+    bool PollConnectAttempts()
+    {
+        if (_connectAttempts.empty())
+        {
+            return false;
+        }
+
+        fd_set writeFD;
+        fd_set exceptFD;
+        FD_ZERO(&writeFD);
+        FD_ZERO(&exceptFD);
+        SOCKET maxSocket = 0;
+        for (SOCKET attempt : _connectAttempts)
+        {
+#pragma warning(push)
+#pragma warning(disable : 4548) // expression before comma has no effect; expected expression with side-effect
+            FD_SET(attempt, &writeFD);
+            FD_SET(attempt, &exceptFD);
+#pragma warning(pop)
+            maxSocket = std::max(maxSocket, attempt);
+        }
+        timeval timeout;
+        timeout.tv_sec = 0;
+        timeout.tv_usec = 0;
+        if (select((sint32)(maxSocket + 1), nullptr, &writeFD, &exceptFD, &timeout) <= 0)
+        {
+            return false;
+        }
+
+        for (auto it = _connectAttempts.begin(); it != _connectAttempts.end();)
+        {
+            SOCKET attempt = *it;
+            if (!FD_ISSET(attempt, &writeFD) && !FD_ISSET(attempt, &exceptFD))
+            {
+                it++;
+                continue;
+            }
+
+            sint32 error = 0;
+            socklen_t len = sizeof(error);
+            if (getsockopt(attempt, SOL_SOCKET, SO_ERROR, (char *)&error, &len) == 0 && error == 0 &&
+                FD_ISSET(attempt, &writeFD))
+            {
+                _connectAttempts.erase(it);
+                for (SOCKET other : _connectAttempts)
+                {
+                    closesocket(other);
+                }
+                _connectAttempts.clear();
+                _connectAddresses.clear();
+                _socket = attempt;
+                return true;
+            }
+
+            log_verbose("Connect attempt failed: %d", error);
+            closesocket(attempt);
+            it = _connectAttempts.erase(it);
+        }
+        return false;
+    }
+
+    static std::vector<ResolvedAddress> InterleaveAddressFamilies(const std::vector<ResolvedAddress> &addresses)
+    {
+        std::vector<sint32> families;
+        for (const auto &address : addresses)
+        {
+            families.push_back(address.Address.ss_family);
+        }
+
+        std::vector<ResolvedAddress> result;
+        for (size_t index : ::InterleaveAddressFamilies(families))
+        {
+            result.push_back(addresses[index]);
+        }
+        return result;
+    }
+
+    /**
+     * Looks up every stream address for a host. With numericOnly set this never blocks and fails for
+     * anything but a literal address.
+     */
+    static bool ResolveAddresses(const char * address, uint16 port, bool numericOnly, std::vector<ResolvedAddress> * addresses)
+    {
+        std::string serviceName = std::to_string(port);
+
+        addrinfo hints = { 0 };
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = numericOnly ? AI_NUMERICHOST : 0;
+
+        addrinfo * result = nullptr;
+        int errorcode = getaddrinfo(address, serviceName.c_str(), &hints, &result);
+        if (errorcode != 0)
+        {
+            if (!numericOnly)
+            {
+                log_error("Resolving address failed: Code %d.", errorcode);
+#ifndef __psp2__
+                log_error("Resolution error message: %s.", gai_strerror(errorcode));
+#endif
+            }
+            return false;
+        }
+
+        for (addrinfo * info = result; info != nullptr; info = info->ai_next)
+        {
+            ResolvedAddress resolved = {};
+            memcpy(&resolved.Address, info->ai_addr, info->ai_addrlen);
+            resolved.Length = (sint32)info->ai_addrlen;
+            addresses->push_back(resolved);
+        }
+        freeaddrinfo(result);
+        return !addresses->empty();
+    }
+
+    static JobPool * GetResolverPool()
+    {
+        // Never destroyed, a lookup still blocked in getaddrinfo must not hold up shutdown
+        static JobPool * pool = new JobPool(RESOLVER_THREADS);
+        return pool;
+    }
+
     bool ResolveAddress(const char * address, uint16 port, sockaddr_storage * ss, sint32 * ss_len)
     {
         std::string serviceName = std::to_string(port);
@@ -632,28 +912,306 @@ private:
         }
     }
 
-    static bool SetNonBlocking(SOCKET socket, bool on)
+    static bool SetTCPNoDelay(SOCKET socket, bool enabled)
     {
-#ifdef _WIN32
-        u_long nonBlocking = on;
-        return ioctlsocket(socket, FIONBIO, &nonBlocking) == 0;
+        return setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, (const char*)&enabled, sizeof(enabled)) == 0;
+    }
+};
+
+#ifdef SOCKET_SET_USE_EPOLL
+
+class SocketSet final : public ISocketSet
+{
+private:
+    sint32 _epoll = -1;
+    sint32 _wakeEvent = -1;
+
+public:
+    SocketSet()
+    {
+        _epoll = epoll_create1(EPOLL_CLOEXEC);
+        _wakeEvent = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (_epoll == -1 || _wakeEvent == -1)
+        {
+            CloseHandles();
+            throw SocketException("Unable to create socket set.");
+        }
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.fd = _wakeEvent;
+        epoll_ctl(_epoll, EPOLL_CTL_ADD, _wakeEvent, &ev);
+    }
+
+    ~SocketSet() override
+    {
+        CloseHandles();
+    }
+
+    void Add(ITcpSocket * socket) override
+    {
+        epoll_event ev = {};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = static_cast<TcpSocket *>(socket)->GetSocket();
+        if (epoll_ctl(_epoll, EPOLL_CTL_ADD, ev.data.fd, &ev) != 0)
+        {
+            log_error("Unable to add socket to set. %d", LAST_SOCKET_ERROR());
+        }
+    }
+
+    void Remove(ITcpSocket * socket) override
+    {
+        epoll_event ev = {};
+        epoll_ctl(_epoll, EPOLL_CTL_DEL, static_cast<TcpSocket *>(socket)->GetSocket(), &ev);
+    }
+
+    void SetReading(ITcpSocket * socket, bool reading) override
+    {
+        // EPOLLIN is level-triggered, a socket with unread data would wake every wait until it is read
+        epoll_event ev = {};
+        ev.events = reading ? (EPOLLIN | EPOLLRDHUP) : 0;
+        ev.data.fd = static_cast<TcpSocket *>(socket)->GetSocket();
+        epoll_ctl(_epoll, EPOLL_CTL_MOD, ev.data.fd, &ev);
+    }
+
+    void Wait(uint32 timeoutMs) override
+    {
+        epoll_event events[64];
+        sint32 numEvents = epoll_wait(_epoll, events, (sint32)Util::CountOf(events), (sint32)timeoutMs);
+        for (sint32 i = 0; i < numEvents; i++)
+        {
+            if (events[i].data.fd == _wakeEvent)
+            {
+                uint64 value;
+                while (read(_wakeEvent, &value, sizeof(value)) > 0)
+                {
+                }
+            }
+        }
+    }
+
+    void Wake() override
+    {
+        uint64 value = 1;
+        if (write(_wakeEvent, &value, sizeof(value)) < 0)
+        {
+            // Counter is already non-zero, the waiting thread will wake up anyway
+        }
+    }
+
+private:
+    void CloseHandles()
+    {
+        if (_wakeEvent != -1)
+        {
+            close(_wakeEvent);
+            _wakeEvent = -1;
+        }
+        if (_epoll != -1)
+        {
+            close(_epoll);
+            _epoll = -1;
+        }
+    }
+};
+
 #else
-        sint32 flags = fcntl(socket, F_GETFL, 0);
-        return fcntl(socket, F_SETFL, on ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK)) == 0;
-#endif
+
+/**
+ * Waits with select. The sockets are added and removed by one thread while another waits on them, so
+ * the list is copied under a lock for each wait. Select cannot be interrupted portably, so Wake sends a
+ * datagram to a loopback socket that is waited on along with the others.
+ */
+class SocketSet final : public ISocketSet
+{
+private:
+    struct Entry
+    {
+        SOCKET  Socket;
+        bool    Reading;
+    };
+
+    std::vector<Entry>  _sockets;
+    std::mutex          _socketsMutex;
+    SOCKET              _wakeSocket = INVALID_SOCKET;
+
+public:
+    SocketSet()
+    {
+        if (!CreateWakeSocket())
+        {
+            log_warning("Unable to create wake socket, waits will poll. %d", LAST_SOCKET_ERROR());
+            if (_wakeSocket != INVALID_SOCKET)
+            {
+                closesocket(_wakeSocket);
+                _wakeSocket = INVALID_SOCKET;
+            }
+        }
     }
 
-    static bool SetTCPNoDelay(SOCKET socket, bool enabled)
+    ~SocketSet() override
     {
-        return setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, (const char*)&enabled, sizeof(enabled)) == 0;
+        if (_wakeSocket != INVALID_SOCKET)
+        {
+            closesocket(_wakeSocket);
+        }
+    }
+
+    void Add(ITcpSocket * socket) override
+    {
+        std::lock_guard<std::mutex> lock(_socketsMutex);
+        _sockets.push_back({ static_cast<TcpSocket *>(socket)->GetSocket(), true });
+    }
+
+    void Remove(ITcpSocket * socket) override
+    {
+        SOCKET s = static_cast<TcpSocket *>(socket)->GetSocket();
+        std::lock_guard<std::mutex> lock(_socketsMutex);
+        _sockets.erase(std::remove_if(_sockets.begin(), _sockets.end(), [s](const Entry &entry) -> bool
+        {
+            return entry.Socket == s;
+        }), _sockets.end());
+    }
+
+    void SetReading(ITcpSocket * socket, bool reading) override
+    {
+        SOCKET s = static_cast<TcpSocket *>(socket)->GetSocket();
+        std::lock_guard<std::mutex> lock(_socketsMutex);
+        for (auto &entry : _sockets)
+        {
+            if (entry.Socket == s)
+            {
+                entry.Reading = reading;
+            }
+        }
+    }
+
+    void Wait(uint32 timeoutMs) override
+    {
+        fd_set readFD;
+        FD_ZERO(&readFD);
+        SOCKET maxSocket = 0;
+        size_t numSockets = 0;
+        {
+            std::lock_guard<std::mutex> lock(_socketsMutex);
+            for (const auto &entry : _sockets)
+            {
+                if (entry.Reading)
+                {
+                    AddToSet(entry.Socket, &readFD, &maxSocket);
+                    numSockets++;
+                }
+            }
+        }
+        if (_wakeSocket != INVALID_SOCKET)
+        {
+            AddToSet(_wakeSocket, &readFD, &maxSocket);
+            numSockets++;
+        }
+        else
+        {
+            // Nothing can interrupt the wait, so keep it short
+            timeoutMs = std::min<uint32>(timeoutMs, 1);
+        }
+
+        if (numSockets == 0 || numSockets > FD_SETSIZE)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+            return;
+        }
+
+        timeval timeout;
+        timeout.tv_sec = timeoutMs / 1000;
+        timeout.tv_usec = (timeoutMs % 1000) * 1000;
+        if (select((sint32)(maxSocket + 1), &readFD, nullptr, nullptr, &timeout) > 0 &&
+            _wakeSocket != INVALID_SOCKET && FD_ISSET(_wakeSocket, &readFD))
+        {
+            char buffer[64];
+            while (recv(_wakeSocket, buffer, sizeof(buffer), 0) > 0)
+            {
+            }
+        }
+    }
+
+    void Wake() override
+    {
+        if (_wakeSocket != INVALID_SOCKET)
+        {
+            // If the socket buffer is full the waiting thread will wake up anyway
+            char value = 1;
+            send(_wakeSocket, &value, sizeof(value), 0);
+        }
+    }
+
+private:
+    /**
+     * Creates a UDP socket bound to the loopback address and connected to itself.
+     */
+    bool CreateWakeSocket()
+    {
+        _wakeSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (_wakeSocket == INVALID_SOCKET)
+        {
+            return false;
+        }
+
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = 0;
+        socklen_t addressLength = sizeof(address);
+        return bind(_wakeSocket, (const sockaddr *)&address, sizeof(address)) == 0 &&
+               getsockname(_wakeSocket, (sockaddr *)&address, &addressLength) == 0 &&
+               connect(_wakeSocket, (const sockaddr *)&address, sizeof(address)) == 0 &&
+               TcpSocket::SetNonBlocking(_wakeSocket, true);
+    }
+
+    static void AddToSet(SOCKET s, fd_set * set, SOCKET * maxSocket)
+    {
+#pragma warning(push)
+#pragma warning(disable : 4548) // expression before comma has no effect; expected expression with side-effect
+        FD_SET(s, set);
+#pragma warning(pop)
+        *maxSocket = std::max(*maxSocket, s);
     }
 };
 
+#endif
+
+std::vector<size_t> InterleaveAddressFamilies(const std::vector<sint32> &families)
+{
+    std::vector<size_t> preferred;
+    std::vector<size_t> others;
+    for (size_t i = 0; i < families.size(); i++)
+    {
+        if (families[i] == families[0])
+        {
+            preferred.push_back(i);
+        }
+        else
+        {
+            others.push_back(i);
+        }
+    }
+
+    std::vector<size_t> result;
+    for (size_t i = 0; i < std::max(preferred.size(), others.size()); i++)
+    {
+        if (i < preferred.size()) result.push_back(preferred[i]);
+        if (i < others.size()) result.push_back(others[i]);
+    }
+    return result;
+}
+
 ITcpSocket * CreateTcpSocket()
 {
     return new TcpSocket();
 }
 
+ISocketSet * CreateSocketSet()
+{
+    return new SocketSet();
+}
+
 bool InitialiseWSA()
 {
 #ifdef _WIN32
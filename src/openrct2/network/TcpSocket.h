@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <vector>
 #include "../common.h"
 
 enum SOCKET_STATUS
@@ -35,6 +36,15 @@ enum NETWORK_READPACKET
     NETWORK_READPACKET_DISCONNECTED
 };
 
+/**
+ * A buffer to be sent as part of a single scatter / gather write.
+ */
+struct SocketBuffer
+{
+    const void *    Data;
+    size_t          Length;
+};
+
 /**
  * Represents a TCP socket / connection or listener.
  */
@@ -55,13 +65,50 @@ public:
     virtual void ConnectAsync(const char * address, uint16 port) abstract;
 
     virtual size_t             SendData(const void * buffer, size_t size)                     abstract;
+    virtual size_t             SendData(const SocketBuffer * buffers, size_t count)           abstract;
     virtual NETWORK_READPACKET ReceiveData(void * buffer, size_t size, size_t * sizeReceived) abstract;
 
     virtual void Disconnect() abstract;
     virtual void Close() abstract;
 };
 
+/**
+ * A set of connected sockets that a thread can wait on until any of them has data to read.
+ */
+interface ISocketSet
+{
+public:
+    virtual ~ISocketSet() { }
+
+    virtual void Add(ITcpSocket * socket)    abstract;
+    virtual void Remove(ITcpSocket * socket) abstract;
+
+    /**
+     * Stops or resumes waking up for data on a socket in the set, e.g. while there is nowhere to put
+     * what would be read from it.
+     */
+    virtual void SetReading(ITcpSocket * socket, bool reading) abstract;
+
+    /**
+     * Waits until a socket in the set has data to read, Wake is called or the timeout passes.
+     */
+    virtual void Wait(uint32 timeoutMs) abstract;
+
+    /**
+     * Wakes up a thread blocked in Wait. Can be called from any thread.
+     */
+    virtual void Wake() abstract;
+};
+
+/**
+ * Orders addresses, given by their families, so that consecutive connection attempts alternate between
+ * families, starting with the family the resolver preferred (RFC 8305).
+ * @returns the indices of the addresses in the order to try them.
+ */
+std::vector<size_t> InterleaveAddressFamilies(const std::vector<sint32> &families);
+
 ITcpSocket * CreateTcpSocket();
+ISocketSet * CreateSocketSet();
 
 bool InitialiseWSA();
 void DisposeWSA();
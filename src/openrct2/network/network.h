@@ -34,8 +34,14 @@ enum {
 };
 
 #define NETWORK_DEFAULT_PORT 11753
+#define NETWORK_STATE_DIGEST_HISTORY_SIZE 1024
+// Ticks between two state digests sent by the server
+#define NETWORK_STATE_DIGEST_INTERVAL 8
+// Ticks between two snapshots of the park kept for a desync dump, bounds the commands recorded since
+#define NETWORK_DESYNC_SNAPSHOT_INTERVAL 24000
 #define MAX_SERVER_DESCRIPTION_LENGTH 256
 
+#include <vector>
 #include "../common.h"
 #include "../Game.h"
 #include "../localisation/StringIds.h"
@@ -60,20 +66,25 @@ struct LocationXYZ16;
 #include <map>
 #include <openssl/evp.h>
 #include "../actions/GameAction.h"
+#include "../Replay.h"
 #include "../core/Json.hpp"
 #include "../core/Nullable.hpp"
 #include "../core/MemoryStream.h"
 #include "NetworkConnection.h"
 #include "NetworkGroup.h"
+#include "NetworkIOThread.h"
 #include "NetworkKey.h"
 #include "NetworkPacket.h"
 #include "NetworkPlayer.h"
+#include "NetworkRelay.h"
 #include "NetworkServerAdvertiser.h"
+#include "NetworkStats.h"
 #include "NetworkUser.h"
 #include "TcpSocket.h"
 
 enum {
     NETWORK_TICK_FLAG_CHECKSUMS = 1 << 0,
+    NETWORK_TICK_FLAG_DIGEST = 1 << 1,
 };
 
 struct ObjectRepositoryItem;
@@ -85,6 +96,8 @@ namespace OpenRCT2
 
 class Network
 {
+    friend class NetworkRelay;
+
 public:
     Network();
     ~Network();
@@ -93,6 +106,7 @@ public:
     void Close();
     bool BeginClient(const char* host, uint16 port);
     bool BeginServer(uint16 port, const char* address);
+    bool BeginRelay(const char* host, uint16 port, uint16 relayPort, const char* relayAddress);
     sint32 GetMode();
     sint32 GetStatus();
     sint32 GetAuthStatus();
@@ -107,9 +121,12 @@ public:
     std::vector<std::unique_ptr<NetworkGroup>>::iterator GetGroupIteratorByID(uint8 id);
     NetworkGroup* GetGroupByID(uint8 id);
     static const char* FormatChat(NetworkPlayer* fromplayer, const char* text);
-    void SendPacketToClients(NetworkPacket& packet, bool front = false, bool gameCmd = false);
+    void SendPacketToClients(std::unique_ptr<NetworkPacket> packet, bool front = false, bool gameCmd = false);
     bool CheckSRAND(uint32 tick, uint32 srand0);
     void CheckDesynchronizaton();
+    void CheckStateDigest();
+    void WriteDesyncDump();
+    void SnapshotDesyncRecording();
     void KickPlayer(sint32 playerId);
     void SetPassword(const char* password);
     void ShutdownClient();
@@ -120,6 +137,10 @@ public:
     void SetDefaultGroup(uint8 id);
     void SaveGroups();
     void LoadGroups();
+    bool LoadMapData(const uint8 * data, size_t size);
+    bool SaveMapData(std::vector<uint8> &data) const;
+    json_t * GetStatsJson() const;
+    std::vector<std::string> GetStatsSummary() const;
 
     std::string BeginLog(const std::string &directory, const std::string &midName, const std::string &filenameFormat);
     void AppendLog(std::ostream &fs, const std::string &s);
@@ -239,12 +260,23 @@ private:
     std::vector<uint8> chunk_buffer;
     std::string _password;
     bool _desynchronised = false;
+    bool _desyncDumped = false;
+    ReplayRecording _desyncRecording;
+    uint32 _desyncRecordingTick = 0;
+    StateDigestHistory _stateDigests = StateDigestHistory(NETWORK_STATE_DIGEST_HISTORY_SIZE);
+    StateDigestHistory _serverStateDigests = StateDigestHistory(NETWORK_STATE_DIGEST_HISTORY_SIZE);
+    uint32 _immediateCommandTick = UINT32_MAX;
     INetworkServerAdvertiser * _advertiser = nullptr;
+    std::unique_ptr<NetworkIOThread> _ioThread;
+    std::unique_ptr<NetworkRelay> _relay;
+    std::unique_ptr<NetworkStatsEndpoint> _statsEndpoint;
+    uint32 _lastStatsLogTime = 0;
     uint32 server_connect_time = 0;
     uint8 default_group = 0;
     uint32 game_commands_processed_this_tick = 0;
     uint32 _commandId;
     uint32 _actionId;
+    NetworkCommandTickState _broadcastCommandTicks;
     std::string _chatLogPath;
     std::string _chatLogFilenameFormat = "%Y%m%d-%H%M%S.txt";
     std::string _serverLogPath;
@@ -253,6 +285,8 @@ private:
 
     void UpdateServer();
     void UpdateClient();
+    void UpdateStats();
+    std::vector<const NetworkConnection *> GetConnections() const;
 
 private:
     std::vector<void (Network::*)(NetworkConnection& connection, NetworkPacket& packet)> client_command_handlers;
@@ -281,6 +315,7 @@ private:
     void Client_Handle_TOKEN(NetworkConnection& connection, NetworkPacket& packet);
     void Server_Handle_TOKEN(NetworkConnection& connection, NetworkPacket& packet);
     void Client_Handle_OBJECTS(NetworkConnection& connection, NetworkPacket& packet);
+    void Client_Handle_BATCH(NetworkConnection& connection, NetworkPacket& packet);
     void Server_Handle_OBJECTS(NetworkConnection& connection, NetworkPacket& packet);
 
     uint8 * save_for_network(size_t &out_size, const std::vector<const ObjectRepositoryItem *> &objects) const;
@@ -296,6 +331,7 @@ void network_close();
 void network_shutdown_client();
 sint32 network_begin_client(const char *host, sint32 port);
 sint32 network_begin_server(sint32 port, const char* address);
+sint32 network_begin_relay(const char *host, sint32 port, sint32 relayPort, const char* relayAddress);
 
 sint32 network_get_mode();
 sint32 network_get_status();
@@ -307,6 +343,9 @@ void network_flush();
 
 sint32 network_get_authstatus();
 uint32 network_get_server_tick();
+bool network_load_map(const uint8 * data, size_t size);
+bool network_save_map(std::vector<uint8> &data);
+std::vector<std::string> network_get_stats_summary();
 uint8 network_get_current_player_id();
 sint32 network_get_num_players();
 const char* network_get_player_name(uint32 index);
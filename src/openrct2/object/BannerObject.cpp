@@ -63,7 +63,7 @@ void BannerObject::Load()
 {
     GetStringTable()->Sort();
     _legacyType.name = language_allocate_object_string(GetName());
-    _legacyType.image = gfx_object_allocate_images(GetImageTable()->GetImages(), GetImageTable()->GetCount());
+    _legacyType.image = GetImageTable()->AllocateImages();
 }
 
 void BannerObject::Unload()
@@ -16,12 +16,17 @@
 
 #include <algorithm>
 #include <stdexcept>
+#include "../core/FileStream.hpp"
 #include "../core/IStream.hpp"
 #include "../core/Memory.hpp"
+#include "../core/MemoryMappedFile.h"
 #include "../OpenRCT2.h"
+#include "../rct12/SawyerChunkReader.h"
 #include "ImageTable.h"
 #include "Object.h"
 
+ImageTable::ImageTable() = default;
+
 ImageTable::~ImageTable()
 {
     Memory::Free(_data);
@@ -29,6 +34,13 @@ ImageTable::~ImageTable()
     _dataSize = 0;
 }
 
+void ImageTable::SetSource(const std::string &path, bool uncompressed, uint64 chunkOffset)
+{
+    _sourcePath = path;
+    _sourceUncompressed = uncompressed;
+    _sourceChunkOffset = chunkOffset;
+}
+
 void ImageTable::Read(IReadObjectContext * context, IStream * stream)
 {
     if (gOpenRCT2NoGraphics)
@@ -49,22 +61,27 @@ void ImageTable::Read(IReadObjectContext * context, IStream * stream)
             imageDataSize = (uint32)remainingBytes;
         }
 
+        // Only tables that are complete in the file can be read again later, the rest are padded now
+        _lazy = !_sourcePath.empty() && remainingBytes == imageDataSize;
         _dataSize = imageDataSize;
-        _data = Memory::Reallocate(_data, _dataSize);
-        if (_data == nullptr)
+        if (!_lazy)
         {
-            context->LogError(OBJECT_ERROR_BAD_IMAGE_TABLE, "Image table too large.");
-            throw std::runtime_error("Image table too large.");
+            _data = Memory::Reallocate(_data, _dataSize);
+            if (_data == nullptr)
+            {
+                context->LogError(OBJECT_ERROR_BAD_IMAGE_TABLE, "Image table too large.");
+                throw std::runtime_error("Image table too large.");
+            }
         }
 
         // Read g1 element headers
-        uintptr_t imageDataBase = (uintptr_t)_data;
+        _entryOffsets.clear();
         for (uint32 i = 0; i < numImages; i++)
         {
             rct_g1_element g1Element;
 
-            uintptr_t imageDataOffset = (uintptr_t)stream->ReadValue<uint32>();
-            g1Element.offset = (uint8*)(imageDataBase + imageDataOffset);
+            _entryOffsets.push_back(stream->ReadValue<uint32>());
+            g1Element.offset = nullptr;
 
             g1Element.width = stream->ReadValue<sint16>();
             g1Element.height = stream->ReadValue<sint16>();
@@ -76,6 +93,15 @@ void ImageTable::Read(IReadObjectContext * context, IStream * stream)
             _entries.push_back(g1Element);
         }
 
+        if (_lazy)
+        {
+            // Image data is read from the file when first drawn
+            _sourceChunkLength = (size_t)stream->GetLength();
+            _sourceDataOffset = (size_t)stream->GetPosition();
+            stream->Seek(_dataSize, STREAM_SEEK_CURRENT);
+            return;
+        }
+
         // Read g1 element data
         size_t readBytes = (size_t)stream->TryRead(_data, _dataSize);
 
@@ -88,6 +114,8 @@ void ImageTable::Read(IReadObjectContext * context, IStream * stream)
 
             context->LogWarning(OBJECT_ERROR_BAD_IMAGE_TABLE, "Image table size shorter than expected.");
         }
+        SetDataPointers(_data);
+        _loaded = true;
 
         // TODO validate the image data to prevent crashes in-game
     }
@@ -97,3 +125,86 @@ void ImageTable::Read(IReadObjectContext * context, IStream * stream)
         throw;
     }
 }
+
+uint32 ImageTable::AllocateImages()
+{
+    if (_lazy)
+    {
+        return gfx_object_allocate_lazy_images(this);
+    }
+    return gfx_object_allocate_images(GetImages(), GetCount());
+}
+
+bool ImageTable::Load()
+{
+    if (_loaded)
+    {
+        return true;
+    }
+
+    try
+    {
+        if (_sourceUncompressed)
+        {
+            // Point straight into the mapped object file
+            _mappedFile = std::make_unique<MemoryMappedFile>(_sourcePath);
+            uint64 dataOffset = _sourceChunkOffset + _sourceDataOffset;
+            if (_sourceChunkOffset + _sourceChunkLength > _mappedFile->GetLength())
+            {
+                throw std::runtime_error("Object file has changed.");
+            }
+            SetDataPointers((const uint8 *)_mappedFile->GetData() + dataOffset);
+        }
+        else
+        {
+            auto fs = FileStream(_sourcePath, FILE_MODE_OPEN);
+            fs.SetPosition(_sourceChunkOffset - sizeof(sawyercoding_chunk_header));
+            auto chunkReader = SawyerChunkReader(&fs);
+
+            // Decode the whole chunk in place and point into it rather than copying out the image data
+            _data = Memory::Allocate<uint8>(_sourceChunkLength);
+            if (_data == nullptr)
+            {
+                throw std::runtime_error("Image table too large.");
+            }
+            if (chunkReader.ReadChunk(_data, _sourceChunkLength) != _sourceChunkLength)
+            {
+                throw std::runtime_error("Object file has changed.");
+            }
+            SetDataPointers((const uint8 *)_data + _sourceDataOffset);
+        }
+        _loaded = true;
+    }
+    catch (const std::exception &e)
+    {
+        log_error("Unable to load images from '%s': %s", _sourcePath.c_str(), e.what());
+        Unload();
+    }
+    return _loaded;
+}
+
+void ImageTable::Unload()
+{
+    if (!_lazy)
+    {
+        return;
+    }
+
+    _mappedFile = nullptr;
+    Memory::Free(_data);
+    _data = nullptr;
+    for (auto &entry : _entries)
+    {
+        entry.offset = nullptr;
+    }
+    _loaded = false;
+}
+
+void ImageTable::SetDataPointers(const void * data)
+{
+    uint8 * imageDataBase = (uint8 *)data;
+    for (size_t i = 0; i < _entries.size(); i++)
+    {
+        _entries[i].offset = imageDataBase + _entryOffsets[i];
+    }
+}
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <memory>
+#include <string>
 #include <vector>
 #include "../common.h"
 
@@ -23,6 +25,7 @@
 
 interface IReadObjectContext;
 interface IStream;
+class MemoryMappedFile;
 
 class ImageTable
 {
@@ -31,10 +34,45 @@ private:
     void *                      _data       = nullptr;
     size_t                      _dataSize   = 0;
 
+    // Where the image data can be read from again, if the table is loaded lazily
+    std::string                         _sourcePath;
+    bool                                _sourceUncompressed = false;
+    uint64                              _sourceChunkOffset  = 0;
+    size_t                              _sourceChunkLength  = 0;
+    size_t                              _sourceDataOffset   = 0;
+    std::vector<uint32>                 _entryOffsets;
+    std::unique_ptr<MemoryMappedFile>   _mappedFile;
+    bool                                _lazy       = false;
+    bool                                _loaded     = false;
+
 public:
+    ImageTable();
+    ImageTable(const ImageTable &) = delete;
+    ImageTable & operator=(const ImageTable &) = delete;
     ~ImageTable();
 
+    /**
+     * Sets the object file the table is read from, so that the image data can be left unread until
+     * it is first drawn.
+     * @param chunkOffset Position of the object's chunk data within the file.
+     */
+    void                    SetSource(const std::string &path, bool uncompressed, uint64 chunkOffset);
+
     void                    Read(IReadObjectContext * context, IStream * stream);
     const rct_g1_element *  GetImages() const { return _entries.data(); }
     uint32                  GetCount() const { return (uint32)_entries.size(); }
+
+    /**
+     * Allocates image ids for the table, registering it to be loaded on first use if its data has
+     * not been read.
+     */
+    uint32                  AllocateImages();
+
+    bool                    IsLoaded() const { return _loaded; }
+    size_t                  GetDataSize() const { return _dataSize; }
+    bool                    Load();
+    void                    Unload();
+
+private:
+    void                    SetDataPointers(const void * data);
 };
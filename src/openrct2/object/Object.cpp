@@ -95,6 +95,11 @@ rct_object_entry Object::CreateHeader(const char name[DAT_NAME_LENGTH + 1], uint
     return header;
 }
 
+void Object::SetImageSource(const std::string &path, bool uncompressed, uint64 chunkOffset)
+{
+    _imageTable.SetSource(path, uncompressed, chunkOffset);
+}
+
 void Object::SetSourceGame(const uint8 sourceGame)
 {
     // FIXME: Temporary disabled because it breaks exporting to vanilla.
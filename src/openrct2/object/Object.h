@@ -174,6 +174,7 @@ public:
     virtual void *              GetLegacyData() abstract;
 
     virtual void ReadLegacy(IReadObjectContext * context, IStream * stream) abstract;
+    void SetImageSource(const std::string &path, bool uncompressed, uint64 chunkOffset);
     virtual void Load() abstract;
     virtual void Unload() abstract;
 
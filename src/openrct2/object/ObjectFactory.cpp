@@ -122,6 +122,15 @@ namespace ObjectFactory
             auto chunk = chunkReader.ReadChunk();
             log_verbose("  size: %zu", chunk->GetLength());
 
+            // Let the image table read its data from the file once it is drawn
+            if (result != nullptr)
+            {
+                result->SetImageSource(
+                    path,
+                    chunk->GetEncoding() == SAWYER_ENCODING::NONE,
+                    sizeof(rct_object_entry) + sizeof(sawyercoding_chunk_header));
+            }
+
             auto chunkStream = MemoryStream(chunk->GetData(), chunk->GetLength());
             auto readContext = ReadObjectContext(objectName);
             ReadObjectLegacy(result, &readContext, &chunkStream);
@@ -20,6 +20,7 @@
 #include <memory>
 #include <unordered_set>
 #include "../core/Console.hpp"
+#include "../core/JobPool.hpp"
 #include "../core/Memory.hpp"
 #include "../localisation/StringIds.h"
 #include "FootpathItemObject.h"
@@ -498,36 +499,81 @@ private:
 
     std::pair<bool, std::vector<Object *>> LoadObjects(std::vector<const ObjectRepositoryItem *> &requiredObjects, size_t * outNewObjectsLoaded)
     {
-        size_t newObjectsLoaded = 0;
-        std::vector<Object *> loadedObjects;
-        loadedObjects.reserve(OBJECT_ENTRY_COUNT);
+        // Find the objects that are not loaded yet
+        std::vector<const ObjectRepositoryItem *> objectsToLoad;
+        std::unordered_set<const ObjectRepositoryItem *> objectsToLoadSet;
         for (auto ori : requiredObjects)
         {
-            Object * loadedObject = nullptr;
-            if (ori != nullptr)
+            if (ori != nullptr && ori->LoadedObject == nullptr && objectsToLoadSet.insert(ori).second)
             {
-                loadedObject = ori->LoadedObject;
-                if (loadedObject == nullptr)
-                {
-                    loadedObject = GetOrLoadObject(ori);
-                    if (loadedObject == nullptr)
-                    {
-                        ReportObjectLoadProblem(&ori->ObjectEntry);
-                        return std::make_pair(false, std::vector<Object *>());
-                    } else {
-                        newObjectsLoaded++;
-                    }
-                }
+                objectsToLoad.push_back(ori);
+            }
+        }
+
+        // Reading and parsing the object files is independent for each object, Load() is not
+        std::vector<Object *> newObjects = ReadObjects(objectsToLoad);
+
+        bool failed = false;
+        for (size_t i = 0; i < objectsToLoad.size(); i++)
+        {
+            if (newObjects[i] == nullptr)
+            {
+                ReportObjectLoadProblem(&objectsToLoad[i]->ObjectEntry);
+                failed = true;
+            }
+        }
+        if (failed)
+        {
+            for (auto object : newObjects)
+            {
+                delete object;
             }
-            loadedObjects.push_back(loadedObject);
+            return std::make_pair(false, std::vector<Object *>());
+        }
+
+        for (size_t i = 0; i < objectsToLoad.size(); i++)
+        {
+            newObjects[i]->Load();
+
+            // Connect the ori to the registered object
+            _objectRepository->RegisterLoadedObject(objectsToLoad[i], newObjects[i]);
+        }
+
+        std::vector<Object *> loadedObjects;
+        loadedObjects.reserve(OBJECT_ENTRY_COUNT);
+        for (auto ori : requiredObjects)
+        {
+            loadedObjects.push_back(ori != nullptr ? ori->LoadedObject : nullptr);
         }
         if (outNewObjectsLoaded != nullptr)
         {
-            *outNewObjectsLoaded = newObjectsLoaded;
+            *outNewObjectsLoaded = objectsToLoad.size();
         }
         return std::make_pair(true, loadedObjects);
     }
 
+    std::vector<Object *> ReadObjects(const std::vector<const ObjectRepositoryItem *> &objectsToLoad)
+    {
+        std::vector<Object *> objects(objectsToLoad.size());
+        if (objectsToLoad.size() == 1)
+        {
+            objects[0] = _objectRepository->LoadObject(objectsToLoad[0]);
+        }
+        else if (objectsToLoad.size() > 1)
+        {
+            JobPool jobPool;
+            for (size_t i = 0; i < objectsToLoad.size(); i++)
+            {
+                jobPool.AddTask([this, &objects, &objectsToLoad, i]() -> void
+                {
+                    objects[i] = _objectRepository->LoadObject(objectsToLoad[i]);
+                });
+            }
+            jobPool.Join();
+        }
+        return objects;
+    }
+
     Object * GetOrLoadObject(const ObjectRepositoryItem * ori)
     {
         Object * loadedObject = ori->LoadedObject;
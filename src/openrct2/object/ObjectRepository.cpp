@@ -14,7 +14,7 @@
  *****************************************************************************/
 #pragma endregion
 
-// #include <algorithm>
+#include <algorithm>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -75,7 +75,49 @@ using ObjectEntryMap = std::unordered_map<rct_object_entry, size_t, ObjectEntryH
 
 static void ReportMissingObject(const rct_object_entry * entry);
 
-class ObjectFileIndex final : public FileIndex<ObjectRepositoryItem>
+/**
+ * Gets the key of an object entry in the object index, its name packed into 64 bits.
+ */
+static uint64 GetObjectEntryKey(const rct_object_entry &entry)
+{
+    uint64 key = 0;
+    for (sint32 i = 0; i < 8; i++)
+    {
+        key |= (uint64)(uint8)entry.name[i] << (i * 8);
+    }
+    return key;
+}
+
+// Fixed size record of an object in the object index
+struct ObjectIndexRecord
+{
+    rct_object_entry ObjectEntry;
+    uint32 PathOffset;
+    uint32 NameOffset;
+    uint32 ThemeObjectsOffset;
+    uint16 NumThemeObjects;
+    uint8  RideFlags;
+    uint8  RideCategory[MAX_CATEGORIES_PER_RIDE];
+    uint8  RideType[MAX_RIDE_TYPES_PER_RIDE_ENTRY];
+    uint8  RideGroupIndex;
+};
+
+template<>
+inline constexpr ObjectIndexRecord bswap<ObjectIndexRecord>(const ObjectIndexRecord &nat) {
+    return ObjectIndexRecord{
+        .ObjectEntry = bswap(nat.ObjectEntry),
+        .PathOffset = bswap(nat.PathOffset),
+        .NameOffset = bswap(nat.NameOffset),
+        .ThemeObjectsOffset = bswap(nat.ThemeObjectsOffset),
+        .NumThemeObjects = bswap(nat.NumThemeObjects),
+        .RideFlags = nat.RideFlags,
+        .RideCategory = { nat.RideCategory[0], nat.RideCategory[1] },
+        .RideType = { nat.RideType[0], nat.RideType[1], nat.RideType[2] },
+        .RideGroupIndex = nat.RideGroupIndex,
+    };
+}
+
+class ObjectFileIndex final : public FileIndex<ObjectRepositoryItem, ObjectIndexRecord>
 {
 private:
     static constexpr uint32 MAGIC_NUMBER = 0x5844494F; // OIDX
@@ -120,68 +162,106 @@ public:
 
 
 protected:
-    void Serialise(IStream * stream, const ObjectRepositoryItem &item) const override
+    ObjectIndexRecord Serialise(const ObjectRepositoryItem &item, FileIndexPool * pool) const override
     {
-        stream->WriteValue(item.ObjectEntry);
-        stream->WriteString(item.Path);
-        stream->WriteString(item.Name);
+        ObjectIndexRecord record = { 0 };
+        record.ObjectEntry = item.ObjectEntry;
+        record.PathOffset = pool->AddString(item.Path);
+        record.NameOffset = pool->AddString(item.Name);
 
         switch (object_entry_get_type(&item.ObjectEntry)) {
         case OBJECT_TYPE_RIDE:
-            stream->WriteValue<uint8>(item.RideFlags);
-            for (sint32 i = 0; i < MAX_CATEGORIES_PER_RIDE; i++)
-            {
-                stream->WriteValue<uint8>(item.RideCategory[i]);
-            }
-            for (sint32 i = 0; i < MAX_RIDE_TYPES_PER_RIDE_ENTRY; i++)
-            {
-                stream->WriteValue<uint8>(item.RideType[i]);
-            }
-            stream->WriteValue<uint8>(item.RideGroupIndex);
+            record.RideFlags = item.RideFlags;
+            std::copy_n(item.RideCategory, MAX_CATEGORIES_PER_RIDE, record.RideCategory);
+            std::copy_n(item.RideType, MAX_RIDE_TYPES_PER_RIDE_ENTRY, record.RideType);
+            record.RideGroupIndex = item.RideGroupIndex;
             break;
         case OBJECT_TYPE_SCENERY_GROUP:
-            stream->WriteValue<uint16>(item.NumThemeObjects);
-            for (uint16 i = 0; i < item.NumThemeObjects; i++)
-            {
-                stream->WriteValue<rct_object_entry>(item.ThemeObjects[i]);
-            }
+            record.NumThemeObjects = item.NumThemeObjects;
+            record.ThemeObjectsOffset = pool->AddData(item.ThemeObjects, item.NumThemeObjects * sizeof(rct_object_entry));
             break;
         }
+        return record;
     }
 
-    ObjectRepositoryItem Deserialise(IStream * stream) const override
+    ObjectRepositoryItem Deserialise(const ObjectIndexRecord &record, const FileIndexData &data) const override
     {
         ObjectRepositoryItem item = { 0 };
 
-        item.ObjectEntry = stream->ReadValue<rct_object_entry>();
-        item.Path = stream->ReadString();
-        item.Name = stream->ReadString();
+        // Strings and theme objects are used in place, the repository keeps the index data alive
+        item.ObjectEntry = record.ObjectEntry;
+        item.Path = (utf8 *)data.GetString(record.PathOffset);
+        item.Name = (utf8 *)data.GetString(record.NameOffset);
 
         switch (object_entry_get_type(&item.ObjectEntry)) {
         case OBJECT_TYPE_RIDE:
-            item.RideFlags = stream->ReadValue<uint8>();
-            for (sint32 i = 0; i < 2; i++)
-            {
-                item.RideCategory[i] = stream->ReadValue<uint8>();
-            }
-            for (sint32 i = 0; i < MAX_RIDE_TYPES_PER_RIDE_ENTRY; i++)
-            {
-                item.RideType[i] = stream->ReadValue<uint8>();
-            }
-            item.RideGroupIndex = stream->ReadValue<uint8>();
+            item.RideFlags = record.RideFlags;
+            std::copy_n(record.RideCategory, MAX_CATEGORIES_PER_RIDE, item.RideCategory);
+            std::copy_n(record.RideType, MAX_RIDE_TYPES_PER_RIDE_ENTRY, item.RideType);
+            item.RideGroupIndex = record.RideGroupIndex;
             break;
         case OBJECT_TYPE_SCENERY_GROUP:
-            item.NumThemeObjects = stream->ReadValue<uint16>();
-            item.ThemeObjects = Memory::AllocateArray<rct_object_entry>(item.NumThemeObjects);
-            for (uint16 i = 0; i < item.NumThemeObjects; i++)
-            {
-                item.ThemeObjects[i] = stream->ReadValue<rct_object_entry>();
-            }
+            item.NumThemeObjects = record.NumThemeObjects;
+            item.ThemeObjects = (rct_object_entry *)data.GetData(record.ThemeObjectsOffset,
+                                                                 record.NumThemeObjects * sizeof(rct_object_entry));
             break;
         }
         return item;
     }
 
+    void FreeItem(ObjectRepositoryItem * item) const override
+    {
+        Memory::Free(item->Path);
+        Memory::Free(item->Name);
+        if (object_entry_get_type(&item->ObjectEntry) == OBJECT_TYPE_SCENERY_GROUP)
+        {
+            Memory::Free(item->ThemeObjects);
+        }
+    }
+
+    bool GetKey(const ObjectRepositoryItem &item, uint64 * key) const override
+    {
+        *key = GetObjectEntryKey(item.ObjectEntry);
+        return true;
+    }
+
+    /**
+     * Sorts the objects by name and leaves out any object whose entry was already found earlier in the scan.
+     */
+    size_t Arrange(const std::vector<const ObjectRepositoryItem *> &items, std::vector<size_t> * order) const override
+    {
+        ObjectEntryMap entries;
+        std::vector<size_t> conflicts;
+        order->clear();
+        for (size_t i = 0; i < items.size(); i++)
+        {
+            auto it = entries.find(items[i]->ObjectEntry);
+            if (it == entries.end())
+            {
+                entries[items[i]->ObjectEntry] = i;
+                order->push_back(i);
+            }
+            else
+            {
+                Console::Error::WriteLine("Object conflict: '%s'", items[it->second]->Path);
+                Console::Error::WriteLine("               : '%s'", items[i]->Path);
+                conflicts.push_back(i);
+            }
+        }
+        if (!conflicts.empty())
+        {
+            Console::Error::WriteLine("%zu object conflicts found.", conflicts.size());
+        }
+
+        std::stable_sort(order->begin(), order->end(), [&items](size_t a, size_t b) -> bool
+        {
+            return String::Compare(items[a]->Name, items[b]->Name) < 0;
+        });
+        size_t numItems = order->size();
+        order->insert(order->end(), conflicts.begin(), conflicts.end());
+        return numItems;
+    }
+
 private:
     bool IsTrackReadOnly(const std::string &path) const
     {
@@ -196,6 +276,7 @@ class ObjectRepository final : public IObjectRepository
     IPlatformEnvironment * const        _env = nullptr;
     ObjectFileIndex const               _fileIndex;
     std::vector<ObjectRepositoryItem>   _items;
+    std::shared_ptr<const FileIndexData> _indexData;
     ObjectEntryMap                      _itemMap;
 
 public:
@@ -214,16 +295,15 @@ public:
     void LoadOrConstruct() override
     {
         ClearItems();
-        auto items = _fileIndex.LoadOrBuild();
-        AddItems(items);
-        SortItems();
+        auto items = _fileIndex.LoadOrBuild(&_indexData);
+        AddIndexedItems(items);
     }
 
     void Construct() override
     {
-        auto items = _fileIndex.Rebuild();
-        AddItems(items);
-        SortItems();
+        ClearItems();
+        auto items = _fileIndex.Rebuild(&_indexData);
+        AddIndexedItems(items);
     }
 
     size_t GetNumObjects() const override
@@ -242,17 +322,21 @@ public:
         utf8 entryName[9] = { ' ' };
         String::Set(entryName, sizeof(entryName), name);
         std::copy_n(entryName, 8, entry.name);
-
-        auto kvp = _itemMap.find(entry);
-        if (kvp != _itemMap.end())
-        {
-            return &_items[kvp->second];
-        }
-        return nullptr;
+        return FindObject(&entry);
     }
 
     const ObjectRepositoryItem * FindObject(const rct_object_entry * objectEntry) const override final
     {
+        // Indexed objects are found with the hash table of the index, the map only holds objects added since
+        if (_indexData != nullptr)
+        {
+            uint32 index = _indexData->Find(GetObjectEntryKey(*objectEntry));
+            if (index != FileIndexData::NO_ITEM)
+            {
+                return &_items[index];
+            }
+        }
+
         auto kvp = _itemMap.find(*objectEntry);
         if (kvp != _itemMap.end())
         {
@@ -362,45 +446,20 @@ private:
         }
         _items.clear();
         _itemMap.clear();
+        _indexData = nullptr;
     }
 
-    void SortItems()
+    /**
+     * Adds the objects of the index, which are already sorted by name and free of conflicts.
+     * The ID of each object is the index of its record, which the index hash table refers to.
+     */
+    void AddIndexedItems(const std::vector<ObjectRepositoryItem> &items)
     {
-        std::sort(_items.begin(), _items.end(), [](const ObjectRepositoryItem &a,
-                                                   const ObjectRepositoryItem &b) -> bool
-        {
-            return String::Compare(a.Name, b.Name) < 0;
-        });
-
-        // Fix the IDs
+        _items = items;
         for (size_t i = 0; i < _items.size(); i++)
         {
             _items[i].Id = i;
         }
-
-        // Rebuild item map
-        _itemMap.clear();
-        for (size_t i = 0; i < _items.size(); i++)
-        {
-            rct_object_entry entry = _items[i].ObjectEntry;
-            _itemMap[entry] = i;
-        }
-    }
-
-    void AddItems(const std::vector<ObjectRepositoryItem> &items)
-    {
-        size_t numConflicts = 0;
-        for (auto item : items)
-        {
-            if (!AddItem(item))
-            {
-                numConflicts++;
-            }
-        }
-        if (numConflicts > 0)
-        {
-            Console::Error::WriteLine("%zu object conflicts found.", numConflicts);
-        }
     }
 
     bool AddItem(const ObjectRepositoryItem &item)
@@ -433,22 +492,37 @@ private:
         }
     }
 
-    static void FreeItem(ObjectRepositoryItem * item)
+    void FreeItem(ObjectRepositoryItem * item) const
     {
-        Memory::Free(item->Path);
-        Memory::Free(item->Name);
+        // Indexed objects use the strings and theme objects of the index data in place
+        if (!IsIndexData(item->Path))
+        {
+            Memory::Free(item->Path);
+        }
+        if (!IsIndexData(item->Name))
+        {
+            Memory::Free(item->Name);
+        }
         item->Path = nullptr;
         item->Name = nullptr;
 
         uint8 objectType = object_entry_get_type(&item->ObjectEntry);
         switch (objectType) {
         case OBJECT_TYPE_SCENERY_GROUP:
-            Memory::Free(item->ThemeObjects);
+            if (!IsIndexData(item->ThemeObjects))
+            {
+                Memory::Free(item->ThemeObjects);
+            }
             item->ThemeObjects = nullptr;
             break;
         }
     }
 
+    bool IsIndexData(const void * ptr) const
+    {
+        return _indexData != nullptr && _indexData->Contains(ptr);
+    }
+
     static void SaveObject(const utf8 * path,
                            const rct_object_entry * entry,
                            const void * data, size_t dataSize,
@@ -611,7 +685,7 @@ private:
         auto chunk = chunkReader.ReadChunk();
 
         // Write object data to stream
-        auto chunkWriter = SawyerChunkWriter(stream);
+        SawyerChunkWriter chunkWriter(stream);
         stream->WriteValue(*entry);
         chunkWriter.WriteChunk(chunk.get());
     }
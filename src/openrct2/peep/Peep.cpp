@@ -5458,6 +5458,7 @@ static void peep_update_mowing(rct_peep * peep)
         if ((tile_element->properties.surface.terrain & TILE_ELEMENT_SURFACE_TERRAIN_MASK) == (TERRAIN_GRASS << 5))
         {
             tile_element->properties.surface.grass_length = GRASS_LENGTH_MOWED;
+            map_update_tiles_wake(peep->next_x / 32, peep->next_y / 32);
             map_invalidate_tile_zoom0(peep->next_x, peep->next_y, tile_element->base_height * 8,
                                       tile_element->base_height * 8 + 16);
         }
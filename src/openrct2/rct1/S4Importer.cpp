@@ -15,6 +15,7 @@
 #pragma endregion
 
 #include <algorithm>
+#include <cstddef>
 #include <memory>
 #include <vector>
 #include "../core/Collections.hpp"
@@ -22,6 +23,7 @@
 #include "../core/FileStream.hpp"
 #include "../core/Guard.hpp"
 #include "../core/IStream.hpp"
+#include "../core/MemoryMappedFile.h"
 #include "../core/Memory.hpp"
 #include "../core/Path.hpp"
 #include "../core/String.hpp"
@@ -100,6 +102,87 @@ public:
     }
 };
 
+/**
+ * The parts of an S4 needed to list it in the scenario index.
+ */
+struct S4ScenarioMetadata
+{
+    uint16  ScenarioSlotIndex;
+    uint8   ObjectiveType;
+    uint8   ObjectiveYears;
+    money32 ObjectiveCurrency;
+    uint16  ObjectiveNumGuests;
+    char    Name[sizeof(rct1_s4::scenario_name)];
+};
+
+static void SetScenarioIndexEntry(const S4ScenarioMetadata &metadata, scenario_index_entry * dst)
+{
+    *dst = { 0 };
+
+    source_desc desc;
+    // If no entry is found, this is a custom scenario.
+    bool isOfficial = ScenarioSources::TryGetById(metadata.ScenarioSlotIndex, &desc);
+
+    dst->category = desc.category;
+    dst->source_game = desc.source;
+    dst->source_index = desc.index;
+    dst->sc_id = desc.id;
+
+    dst->objective_type = metadata.ObjectiveType;
+    dst->objective_arg_1 = metadata.ObjectiveYears;
+    dst->objective_arg_2 = metadata.ObjectiveCurrency;
+    dst->objective_arg_3 = metadata.ObjectiveNumGuests;
+
+    std::string name = std::string(metadata.Name, sizeof(metadata.Name));
+    std::string details;
+
+    // TryGetById won't set this property if the scenario is not recognised,
+    // but localisation needs it.
+    if (!isOfficial)
+    {
+        desc.title = name.c_str();
+    }
+
+    String::Set(dst->internal_name, sizeof(dst->internal_name), desc.title);
+
+    rct_string_id localisedStringIds[3];
+    if (language_get_localised_scenario_strings(desc.title, localisedStringIds))
+    {
+        if (localisedStringIds[0] != STR_NONE)
+        {
+            name = String::ToStd(language_get_string(localisedStringIds[0]));
+        }
+        if (localisedStringIds[2] != STR_NONE)
+        {
+            details = String::ToStd(language_get_string(localisedStringIds[2]));
+        }
+    }
+
+    String::Set(dst->name, sizeof(dst->name), name.c_str());
+    String::Set(dst->details, sizeof(dst->details), details.c_str());
+}
+
+/**
+ * Decodes the bytes [offset, offset + length) of an S4 without decoding the rest of the park.
+ */
+static bool DecodeS4Range(const uint8 * data, size_t dataSize, bool isEncrypted, size_t offset, size_t length, void * dst)
+{
+    // The SC4 cipher works on 32-bit words aligned to the start of the file, so widen the range to whole words.
+    size_t begin = offset & ~(size_t)3;
+    size_t end = (offset + length + 3) & ~(size_t)3;
+    std::vector<uint8> buffer(end - begin);
+    if (sawyercoding_decode_sv4_range(data, dataSize, buffer.data(), begin, buffer.size()) != buffer.size())
+    {
+        return false;
+    }
+    if (isEncrypted)
+    {
+        sawyercoding_decrypt_sc4(buffer.data(), begin, buffer.size());
+    }
+    std::memcpy(dst, buffer.data() + (offset - begin), length);
+    return true;
+}
+
 class S4Importer final : public IParkImporter
 {
 private:
@@ -249,54 +332,19 @@ public:
 
     bool GetDetails(scenario_index_entry * dst) override
     {
-        *dst = { 0 };
-
-        source_desc desc;
-        // If no entry is found, this is a custom scenario.
-        bool isOfficial = ScenarioSources::TryGetById(_s4.scenario_slot_index, &desc);
-
-        dst->category = desc.category;
-        dst->source_game = desc.source;
-        dst->source_index = desc.index;
-        dst->sc_id = desc.id;
-
-        dst->objective_type = _s4.scenario_objective_type;
-        dst->objective_arg_1 = _s4.scenario_objective_years;
+        S4ScenarioMetadata metadata;
+        metadata.ScenarioSlotIndex = _s4.scenario_slot_index;
+        metadata.ObjectiveType = _s4.scenario_objective_type;
+        metadata.ObjectiveYears = _s4.scenario_objective_years;
         // RCT1 used another way of calculating park value.
         if (_s4.scenario_objective_type == OBJECTIVE_PARK_VALUE_BY)
-            dst->objective_arg_2 = CorrectRCT1ParkValue(_s4.scenario_objective_currency);
+            metadata.ObjectiveCurrency = CorrectRCT1ParkValue(_s4.scenario_objective_currency);
         else
-            dst->objective_arg_2 = _s4.scenario_objective_currency;
-        dst->objective_arg_3 = _s4.scenario_objective_num_guests;
-
-        std::string name = std::string(_s4.scenario_name, sizeof(_s4.scenario_name));
-        std::string details;
-
-        // TryGetById won't set this property if the scenario is not recognised,
-        // but localisation needs it.
-        if (!isOfficial)
-        {
-            desc.title = name.c_str();
-        }
-
-        String::Set(dst->internal_name, sizeof(dst->internal_name), desc.title);
-
-        rct_string_id localisedStringIds[3];
-        if (language_get_localised_scenario_strings(desc.title, localisedStringIds))
-        {
-            if (localisedStringIds[0] != STR_NONE)
-            {
-                name = String::ToStd(language_get_string(localisedStringIds[0]));
-            }
-            if (localisedStringIds[2] != STR_NONE)
-            {
-                details = String::ToStd(language_get_string(localisedStringIds[2]));
-            }
-        }
-
-        String::Set(dst->name, sizeof(dst->name), name.c_str());
-        String::Set(dst->details, sizeof(dst->details), details.c_str());
+            metadata.ObjectiveCurrency = _s4.scenario_objective_currency;
+        metadata.ObjectiveNumGuests = _s4.scenario_objective_num_guests;
+        std::memcpy(metadata.Name, _s4.scenario_name, sizeof(metadata.Name));
 
+        SetScenarioIndexEntry(metadata, dst);
         return true;
     }
 
@@ -1774,13 +1822,12 @@ private:
     void ImportMapAnimations()
     {
         // This is sketchy, ideally we should try to re-create them
-        rct_map_animation * s4Animations = _s4.map_animations;
-        for (size_t i = 0; i < RCT1_MAX_ANIMATED_OBJECTS; i++)
+        map_animation_clear_all();
+        for (size_t i = 0; i < _s4.num_map_animations && i < RCT1_MAX_ANIMATED_OBJECTS; i++)
         {
-            gAnimatedObjects[i] = s4Animations[i];
-            gAnimatedObjects[i].baseZ /= 2;
+            const rct_map_animation * aobj = &_s4.map_animations[i];
+            map_animation_create(aobj->type, aobj->x, aobj->y, aobj->baseZ / 2);
         }
-        gNumMapAnimations = _s4.num_map_animations;
     }
 
     void ImportFinance()
@@ -2830,6 +2877,59 @@ private:
     }
 };
 
+bool ParkImporter::ReadS4ScenarioDetails(const std::string &path, scenario_index_entry * dst)
+{
+    MemoryMappedFile file(path);
+    auto data = (const uint8 *)file.GetData();
+    size_t dataSize = file.GetLength();
+    if (dataSize <= 4)
+    {
+        return false;
+    }
+
+    // Only the index fields are decoded, but the whole file still has to decode to a complete park
+    // so a truncated or corrupt file is not listed as a playable scenario.
+    if (sawyercoding_get_decoded_length_sv4(data, dataSize) != sizeof(rct1_s4))
+    {
+        return false;
+    }
+
+    sint32 fileType = sawyercoding_detect_file_type(data, dataSize);
+    bool isEncrypted = (fileType & FILE_VERSION_MASK) != FILE_VERSION_RCT1;
+
+    // The objective and the name are each stored contiguously, so two small ranges cover everything the index needs.
+    const size_t objectiveOffset = offsetof(rct1_s4, scenario_objective_type);
+    const size_t objectiveLength = offsetof(rct1_s4, scenario_objective_num_guests) + sizeof(uint16) - objectiveOffset;
+    const size_t nameOffset = offsetof(rct1_s4, scenario_name);
+    const size_t nameLength = offsetof(rct1_s4, scenario_slot_index) + sizeof(uint16) - nameOffset;
+
+    uint8 objective[objectiveLength];
+    uint8 name[nameLength];
+    if (!DecodeS4Range(data, dataSize, isEncrypted, objectiveOffset, objectiveLength, objective) ||
+        !DecodeS4Range(data, dataSize, isEncrypted, nameOffset, nameLength, name))
+    {
+        return false;
+    }
+
+    S4ScenarioMetadata metadata;
+    std::memcpy(&metadata.ObjectiveType, objective + offsetof(rct1_s4, scenario_objective_type) - objectiveOffset, sizeof(uint8));
+    if (metadata.ObjectiveType == OBJECTIVE_PARK_VALUE_BY)
+    {
+        // RCT1 used another way of calculating park value, converting the objective needs the whole park
+        auto s4Importer = std::make_unique<S4Importer>();
+        s4Importer->LoadScenario(path.c_str(), true);
+        return s4Importer->GetDetails(dst);
+    }
+    std::memcpy(&metadata.ObjectiveYears, objective + offsetof(rct1_s4, scenario_objective_years) - objectiveOffset, sizeof(uint8));
+    std::memcpy(&metadata.ObjectiveCurrency, objective + offsetof(rct1_s4, scenario_objective_currency) - objectiveOffset, sizeof(money32));
+    std::memcpy(&metadata.ObjectiveNumGuests, objective + offsetof(rct1_s4, scenario_objective_num_guests) - objectiveOffset, sizeof(uint16));
+    std::memcpy(metadata.Name, name + offsetof(rct1_s4, scenario_name) - nameOffset, sizeof(metadata.Name));
+    std::memcpy(&metadata.ScenarioSlotIndex, name + offsetof(rct1_s4, scenario_slot_index) - nameOffset, sizeof(uint16));
+
+    SetScenarioIndexEntry(metadata, dst);
+    return true;
+}
+
 IParkImporter * ParkImporter::CreateS4()
 {
     return new S4Importer();
@@ -61,40 +61,54 @@ std::shared_ptr<SawyerChunk> SawyerChunkReader::ReadChunk()
     uint64 originalPosition = _stream->GetPosition();
     try
     {
-        auto header = _stream->ReadValue<sawyercoding_chunk_header>();
-        switch (header.encoding) {
-        case CHUNK_ENCODING_NONE:
-        case CHUNK_ENCODING_RLE:
-        case CHUNK_ENCODING_RLECOMPRESSED:
-        case CHUNK_ENCODING_ROTATE:
-        {
-            std::unique_ptr<uint8[]> compressedData(new uint8[header.length]);
-            if (_stream->TryRead(compressedData.get(), header.length) != header.length)
-            {
-                throw SawyerChunkException(EXCEPTION_MSG_CORRUPT_CHUNK_SIZE);
-            }
-
-            // Allow 16MiB for chunk data
-            size_t bufferSize = MAX_UNCOMPRESSED_CHUNK_SIZE;
-            uint8 * buffer = Memory::Allocate<uint8>(bufferSize);
-            if (buffer == nullptr)
-            {
-                throw std::runtime_error("Unable to allocate buffer.");
-            }
+        auto header = ReadChunkData();
+        size_t uncompressedLength = PrepareChunk(header);
+        Guard::Assert(uncompressedLength != 0, "Encountered zero-sized chunk!");
 
-            size_t uncompressedLength = DecodeChunk(buffer, bufferSize, compressedData.get(), header);
-            Guard::Assert(uncompressedLength != 0, "Encountered zero-sized chunk!");
-            buffer = Memory::Reallocate(buffer, uncompressedLength);
-            if (buffer == nullptr)
-            {
-                throw std::runtime_error("Unable to reallocate buffer.");
-            }
+        uint8 * buffer = Memory::Allocate<uint8>(std::max<size_t>(1, uncompressedLength));
+        if (buffer == nullptr)
+        {
+            throw std::runtime_error("Unable to allocate buffer.");
+        }
+        try
+        {
+            DecodeChunk(buffer, uncompressedLength, header);
+        }
+        catch (const std::exception &)
+        {
+            Memory::Free(buffer);
+            throw;
+        }
+        return std::make_shared<SawyerChunk>((SAWYER_ENCODING)header.encoding, buffer, uncompressedLength);
+    }
+    catch (const std::exception &)
+    {
+        // Rewind stream back to original position
+        _stream->SetPosition(originalPosition);
+        throw;
+    }
+}
 
-            return std::make_shared<SawyerChunk>((SAWYER_ENCODING)header.encoding, buffer, uncompressedLength);
+size_t SawyerChunkReader::ReadChunk(void * dst, size_t length)
+{
+    uint64 originalPosition = _stream->GetPosition();
+    try
+    {
+        auto header = ReadChunkData();
+        size_t chunkLength = PrepareChunk(header);
+        if (chunkLength <= length)
+        {
+            DecodeChunk(dst, chunkLength, header);
+            std::fill_n((uint8 *)dst + chunkLength, length - chunkLength, 0);
         }
-        default:
-            throw SawyerChunkException(EXCEPTION_MSG_INVALID_CHUNK_ENCODING);
+        else
+        {
+            // Only the start of the chunk is wanted, but it can only be decoded as a whole
+            _decodedBuffer.resize(chunkLength);
+            DecodeChunk(_decodedBuffer.data(), chunkLength, header);
+            std::copy_n(_decodedBuffer.data(), length, (uint8 *)dst);
         }
+        return chunkLength;
     }
     catch (const std::exception &)
     {
@@ -104,29 +118,73 @@ std::shared_ptr<SawyerChunk> SawyerChunkReader::ReadChunk()
     }
 }
 
-void SawyerChunkReader::ReadChunk(void * dst, size_t length)
+/**
+ * Reads the header of the next chunk and its encoded data into the compressed buffer.
+ */
+sawyercoding_chunk_header SawyerChunkReader::ReadChunkData()
 {
-    auto chunk = ReadChunk();
-    auto chunkData = (const uint8 *)chunk->GetData();
-    auto chunkLength = chunk->GetLength();
-    if (chunkLength > length)
+    auto header = _stream->ReadValue<sawyercoding_chunk_header>();
+    switch (header.encoding)
     {
-        std::copy_n(chunkData, length, (uint8 *)dst);
+    case CHUNK_ENCODING_NONE:
+    case CHUNK_ENCODING_RLE:
+    case CHUNK_ENCODING_RLECOMPRESSED:
+    case CHUNK_ENCODING_ROTATE:
+        break;
+    default:
+        throw SawyerChunkException(EXCEPTION_MSG_INVALID_CHUNK_ENCODING);
     }
-    else
+
+    _compressedBuffer.resize(header.length);
+    if (_stream->TryRead(_compressedBuffer.data(), header.length) != header.length)
+    {
+        throw SawyerChunkException(EXCEPTION_MSG_CORRUPT_CHUNK_SIZE);
+    }
+    return header;
+}
+
+/**
+ * Works out the decoded length of the chunk in the compressed buffer. For RLE compressed chunks this also decodes
+ * the RLE stage into the intermediate buffer, ready for DecodeChunk.
+ */
+size_t SawyerChunkReader::PrepareChunk(const sawyercoding_chunk_header &header)
+{
+    size_t resultLength;
+    switch (header.encoding)
+    {
+    case CHUNK_ENCODING_NONE:
+    case CHUNK_ENCODING_ROTATE:
+        resultLength = header.length;
+        break;
+    case CHUNK_ENCODING_RLE:
+        resultLength = GetRLEDecodedLength(_compressedBuffer.data(), header.length);
+        break;
+    case CHUNK_ENCODING_RLECOMPRESSED:
     {
-        std::copy_n(chunkData, chunkLength, (uint8 *)dst);
-        auto remainingLength = length - chunkLength;
-        if (remainingLength > 0)
+        size_t immLength = GetRLEDecodedLength(_compressedBuffer.data(), header.length);
+        if (immLength > MAX_UNCOMPRESSED_CHUNK_SIZE)
         {
-            auto offset = (uint8 *)dst + chunkLength;
-            std::fill_n(offset, remainingLength, 0);
+            throw SawyerChunkException(EXCEPTION_MSG_CORRUPT_CHUNK_SIZE);
         }
+        _intermediateBuffer.resize(immLength);
+        DecodeChunkRLE(_intermediateBuffer.data(), immLength, _compressedBuffer.data(), header.length);
+        resultLength = GetRepeatDecodedLength(_intermediateBuffer.data(), immLength);
+        break;
     }
+    default:
+        throw SawyerChunkException(EXCEPTION_MSG_INVALID_CHUNK_ENCODING);
+    }
+
+    if (resultLength > MAX_UNCOMPRESSED_CHUNK_SIZE)
+    {
+        throw SawyerChunkException(EXCEPTION_MSG_CORRUPT_CHUNK_SIZE);
+    }
+    return resultLength;
 }
 
-size_t SawyerChunkReader::DecodeChunk(void * dst, size_t dstCapacity, const void * src, const sawyercoding_chunk_header &header)
+size_t SawyerChunkReader::DecodeChunk(void * dst, size_t dstCapacity, const sawyercoding_chunk_header &header)
 {
+    const uint8 * src = _compressedBuffer.data();
     size_t resultLength;
     switch (header.encoding)
     {
@@ -135,14 +193,14 @@ size_t SawyerChunkReader::DecodeChunk(void * dst, size_t dstCapacity, const void
         {
             throw SawyerChunkException(EXCEPTION_MSG_DESTINATION_TOO_SMALL);
         }
-        std::copy_n((const uint8 *)src, header.length, (uint8 *)dst);
+        std::copy_n(src, header.length, (uint8 *)dst);
         resultLength = header.length;
         break;
     case CHUNK_ENCODING_RLE:
         resultLength = DecodeChunkRLE(dst, dstCapacity, src, header.length);
         break;
     case CHUNK_ENCODING_RLECOMPRESSED:
-        resultLength = DecodeChunkRLERepeat(dst, dstCapacity, src, header.length);
+        resultLength = DecodeChunkRepeat(dst, dstCapacity, _intermediateBuffer.data(), _intermediateBuffer.size());
         break;
     case CHUNK_ENCODING_ROTATE:
         resultLength = DecodeChunkRotate(dst, dstCapacity, src, header.length);
@@ -153,12 +211,44 @@ size_t SawyerChunkReader::DecodeChunk(void * dst, size_t dstCapacity, const void
     return resultLength;
 }
 
-size_t SawyerChunkReader::DecodeChunkRLERepeat(void * dst, size_t dstCapacity, const void * src, size_t srcLength)
+size_t SawyerChunkReader::GetRLEDecodedLength(const void * src, size_t srcLength)
+{
+    auto src8 = static_cast<const uint8 *>(src);
+    size_t length = 0;
+    for (size_t i = 0; i < srcLength; i++)
+    {
+        uint8 rleCodeByte = src8[i];
+        if (rleCodeByte & 128)
+        {
+            i++;
+            length += 257 - rleCodeByte;
+        }
+        else
+        {
+            length += rleCodeByte + 1;
+            i += rleCodeByte + 1;
+        }
+    }
+    return length;
+}
+
+size_t SawyerChunkReader::GetRepeatDecodedLength(const void * src, size_t srcLength)
 {
-    auto immBufferLength = MAX_UNCOMPRESSED_CHUNK_SIZE;
-    auto immBuffer = std::make_unique<uint8[]>(immBufferLength);
-    auto immLength = DecodeChunkRLE(immBuffer.get(), immBufferLength, src, srcLength);
-    return DecodeChunkRepeat(dst, dstCapacity, immBuffer.get(), immLength);
+    auto src8 = static_cast<const uint8 *>(src);
+    size_t length = 0;
+    for (size_t i = 0; i < srcLength; i++)
+    {
+        if (src8[i] == 0xFF)
+        {
+            i++;
+            length++;
+        }
+        else
+        {
+            length += (src8[i] & 7) + 1;
+        }
+    }
+    return length;
 }
 
 size_t SawyerChunkReader::DecodeChunkRLE(void * dst, size_t dstCapacity, const void * src, size_t srcLength)
@@ -214,6 +304,14 @@ size_t SawyerChunkReader::DecodeChunkRepeat(void * dst, size_t dstCapacity, cons
     {
         if (src8[i] == 0xFF)
         {
+            if (i + 1 >= srcLength)
+            {
+                throw SawyerChunkException(EXCEPTION_MSG_CORRUPT_RLE);
+            }
+            if (dst8 + 1 > dstEnd)
+            {
+                throw SawyerChunkException(EXCEPTION_MSG_DESTINATION_TOO_SMALL);
+            }
             *dst8++ = src8[++i];
         }
         else
@@ -221,7 +319,12 @@ size_t SawyerChunkReader::DecodeChunkRepeat(void * dst, size_t dstCapacity, cons
             size_t count = (src8[i] & 7) + 1;
             const uint8 * copySrc = dst8 + (sint32)(src8[i] >> 3) - 32;
 
-            if (dst8 + count >= dstEnd || copySrc + count >= dstEnd)
+            if (copySrc < static_cast<uint8 *>(dst))
+            {
+                throw SawyerChunkException(EXCEPTION_MSG_CORRUPT_RLE);
+            }
+            // A copy may end exactly at the end of the destination
+            if (dst8 + count > dstEnd)
             {
                 throw SawyerChunkException(EXCEPTION_MSG_DESTINATION_TOO_SMALL);
             }
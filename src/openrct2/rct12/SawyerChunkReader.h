@@ -17,6 +17,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include "../common.h"
 #include "../util/SawyerCoding.h"
 #include "SawyerChunk.h"
@@ -32,6 +33,11 @@ class SawyerChunkReader final
 private:
     IStream * const _stream = nullptr;
 
+    // Scratch space kept between chunks so that reading many chunks does not allocate for each one
+    std::vector<uint8> _compressedBuffer;
+    std::vector<uint8> _intermediateBuffer;
+    std::vector<uint8> _decodedBuffer;
+
 public:
     explicit SawyerChunkReader(IStream * stream);
 
@@ -42,19 +48,21 @@ public:
     void SkipChunk();
 
     /**
-     * Reads the next chunk from the stream.
+     * Reads the next chunk from the stream into a buffer of exactly the
+     * chunk's decoded size.
      */
     std::shared_ptr<SawyerChunk> ReadChunk();
 
     /**
-     * Reads the next chunk from the stream and copies it directly to the
+     * Reads the next chunk from the stream and decodes it directly into the
      * destination buffer. If the chunk is larger than length, only length
      * is copied. If the chunk is smaller than length, the remaining space
      * is padded with zero.
      * @param dst The destination buffer.
      * @param length The size of the destination buffer.
+     * @returns The decoded length of the chunk.
      */
-    void ReadChunk(void * dst, size_t length);
+    size_t ReadChunk(void * dst, size_t length);
 
     /**
      * Reads the next chunk from the stream into a buffer returned as the
@@ -70,8 +78,12 @@ public:
     }
 
 private:
-    static size_t DecodeChunk(void * dst, size_t dstCapacity, const void * src, const sawyercoding_chunk_header &header);
-    static size_t DecodeChunkRLERepeat(void * dst, size_t dstCapacity, const void * src, size_t srcLength);
+    sawyercoding_chunk_header ReadChunkData();
+    size_t PrepareChunk(const sawyercoding_chunk_header &header);
+    size_t DecodeChunk(void * dst, size_t dstCapacity, const sawyercoding_chunk_header &header);
+
+    static size_t GetRLEDecodedLength(const void * src, size_t srcLength);
+    static size_t GetRepeatDecodedLength(const void * src, size_t srcLength);
     static size_t DecodeChunkRLE(void * dst, size_t dstCapacity, const void * src, size_t srcLength);
     static size_t DecodeChunkRepeat(void * dst, size_t dstCapacity, const void * src, size_t srcLength);
     static size_t DecodeChunkRotate(void * dst, size_t dstCapacity, const void * src, size_t srcLength);
@@ -14,7 +14,9 @@
  *****************************************************************************/
 #pragma endregion
 
+#include <algorithm>
 #include "../core/IStream.hpp"
+#include "../core/JobPool.hpp"
 #include "../core/Math.hpp"
 #include "SawyerChunkWriter.h"
 
@@ -23,9 +25,25 @@
 // Maximum buffer size to store compressed data, maximum of 16 MiB
 constexpr size_t MAX_COMPRESSED_CHUNK_SIZE = 16 * 1024 * 1024;
 
-SawyerChunkWriter::SawyerChunkWriter(IStream * stream)
+// Total source length a parallel writer holds before it flushes by itself, bounding the memory used by encoded chunks
+constexpr size_t MAX_PENDING_CHUNK_LENGTH = 32 * 1024 * 1024;
+
+SawyerChunkWriter::SawyerChunkWriter(IStream * stream, bool parallel)
     : _stream(stream)
 {
+    if (parallel)
+    {
+        _jobPool = std::make_unique<JobPool>();
+    }
+}
+
+SawyerChunkWriter::~SawyerChunkWriter()
+{
+    // Make sure no worker is still reading a source buffer or writing to a pending chunk
+    if (_jobPool != nullptr)
+    {
+        _jobPool->Join();
+    }
 }
 
 void SawyerChunkWriter::WriteChunk(const SawyerChunk * chunk)
@@ -35,12 +53,52 @@ void SawyerChunkWriter::WriteChunk(const SawyerChunk * chunk)
 
 void SawyerChunkWriter::WriteChunk(const void * src, size_t length, SAWYER_ENCODING encoding)
 {
-    sawyercoding_chunk_header header;
-    header.encoding = (uint8)encoding;
-    header.length = (uint32)length;
+    auto chunk = std::make_unique<PendingChunk>();
+    chunk->Source = src;
+    chunk->Length = length;
+    chunk->Encoding = encoding;
+    if (_jobPool == nullptr)
+    {
+        EncodeChunk(chunk.get());
+        _stream->Write(chunk->Data.data(), chunk->Data.size());
+        return;
+    }
+
+    if (_pendingLength + length > MAX_PENDING_CHUNK_LENGTH)
+    {
+        Flush();
+    }
+    auto pendingChunk = chunk.get();
+    _jobPool->AddTask([pendingChunk]() -> void { EncodeChunk(pendingChunk); });
+    _pendingChunks.push_back(std::move(chunk));
+    _pendingLength += length;
+}
 
-    auto data = std::make_unique<uint8[]>(MAX_COMPRESSED_CHUNK_SIZE);
-    size_t dataLength = sawyercoding_write_chunk_buffer(data.get(), (const uint8 *)src, header);
+void SawyerChunkWriter::Flush()
+{
+    if (_jobPool == nullptr)
+    {
+        return;
+    }
+
+    _jobPool->Join();
+    for (const auto &chunk : _pendingChunks)
+    {
+        _stream->Write(chunk->Data.data(), chunk->Data.size());
+    }
+    _pendingChunks.clear();
+    _pendingLength = 0;
+}
+
+void SawyerChunkWriter::EncodeChunk(PendingChunk * chunk)
+{
+    sawyercoding_chunk_header header;
+    header.encoding = (uint8)chunk->Encoding;
+    header.length = (uint32)chunk->Length;
 
-    _stream->Write(data.get(), dataLength);
+    // Repeat encoding can double the length, and RLE adds up to one byte in every 125 on top of that
+    size_t maxLength = sizeof(header) + chunk->Length * 3 + 16;
+    chunk->Data.resize(std::min(maxLength, MAX_COMPRESSED_CHUNK_SIZE));
+    size_t dataLength = sawyercoding_write_chunk_buffer(chunk->Data.data(), (const uint8 *)chunk->Source, header);
+    chunk->Data.resize(dataLength);
 }
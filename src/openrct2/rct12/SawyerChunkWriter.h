@@ -17,22 +17,40 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include "../common.h"
 #include "SawyerChunk.h"
 
 interface IStream;
+class JobPool;
 
 /**
  * Writes sawyer encoding chunks to a data stream. This can be used to write
  * SC6 and SV6 files.
+ *
+ * A parallel writer encodes chunks on a pool of worker threads and only writes
+ * them to the stream, in the order they were given, when Flush is called. The
+ * source buffers must remain valid until then.
  */
 class SawyerChunkWriter final
 {
 private:
-    IStream * const _stream = nullptr;
+    struct PendingChunk
+    {
+        const void *        Source;
+        size_t              Length;
+        SAWYER_ENCODING     Encoding;
+        std::vector<uint8>  Data;
+    };
+
+    IStream * const                             _stream = nullptr;
+    std::unique_ptr<JobPool>                    _jobPool;
+    std::vector<std::unique_ptr<PendingChunk>>  _pendingChunks;
+    size_t                                      _pendingLength = 0;
 
 public:
-    explicit SawyerChunkWriter(IStream * stream);
+    explicit SawyerChunkWriter(IStream * stream, bool parallel = false);
+    ~SawyerChunkWriter();
 
     /**
      * Writes a chunk to the stream.
@@ -54,4 +72,14 @@ public:
     {
         WriteChunk(src, sizeof(T), encoding);
     }
+
+    /**
+     * Waits for all chunks given to a parallel writer to be encoded and writes
+     * them to the stream. This must be called before writing anything else to
+     * the stream directly.
+     */
+    void Flush();
+
+private:
+    static void EncodeChunk(PendingChunk * chunk);
 };
@@ -18,6 +18,8 @@
 #include <cstring>
 #include "../core/FileStream.hpp"
 #include "../core/IStream.hpp"
+#include "../core/MemoryStream.h"
+#include "../core/Path.hpp"
 #include "../core/String.hpp"
 #include "../core/Util.hpp"
 #include "../management/Award.h"
@@ -82,7 +84,40 @@ void S6Exporter::SaveScenario(IStream * stream)
     Save(stream, true);
 }
 
-void S6Exporter::Save(IStream * stream, bool isScenario)
+void S6Exporter::SaveParkFile(const utf8 * path, bool isScenario, PARK_FILE_COMPRESSION compression)
+{
+    auto fs = FileStream(path, FILE_MODE_WRITE);
+    SaveParkFile(&fs, isScenario, compression);
+}
+
+void S6Exporter::SaveParkFile(IStream * stream, bool isScenario, PARK_FILE_COMPRESSION compression)
+{
+    SetHeader(isScenario);
+
+    auto writer = ParkFileWriter();
+    writer.AddSection(PARK_FILE_SECTION_HEADER, &_s6.header, sizeof(_s6.header));
+    if (isScenario)
+    {
+        writer.AddSection(PARK_FILE_SECTION_INFO, &_s6.info, sizeof(_s6.info));
+    }
+
+    auto packedObjects = MemoryStream();
+    if (_s6.header.num_packed_objects > 0)
+    {
+        IObjectRepository * objRepo = GetObjectRepository();
+        objRepo->WritePackedObjects(&packedObjects, ExportObjectsList);
+        writer.AddSection(PARK_FILE_SECTION_PACKED_OBJECTS, packedObjects.GetData(), (size_t)packedObjects.GetLength());
+    }
+
+    // The same data as the SV6 chunks, but the last section always covers everything up to the end of the park
+    writer.AddSection(PARK_FILE_SECTION_OBJECTS, _s6.objects, sizeof(_s6.objects));
+    writer.AddSection(PARK_FILE_SECTION_DATE, &_s6.elapsed_months, 16);
+    writer.AddSection(PARK_FILE_SECTION_TILE_ELEMENTS, &_s6.tile_elements, sizeof(_s6.tile_elements));
+    writer.AddSection(PARK_FILE_SECTION_PARK, &_s6.next_free_tile_element_pointer_index, 0x2E8570);
+    writer.Write(stream, compression);
+}
+
+void S6Exporter::SetHeader(bool isScenario)
 {
     _s6.header.type               = isScenario ? S6_TYPE_SCENARIO : S6_TYPE_SAVEDGAME;
     _s6.header.classic_flag       = 0;
@@ -90,8 +125,14 @@ void S6Exporter::Save(IStream * stream, bool isScenario)
     _s6.header.version            = S6_RCT2_VERSION;
     _s6.header.magic_number       = S6_MAGIC_NUMBER;
     _s6.game_version_number       = 201028;
+}
 
-    auto chunkWriter = SawyerChunkWriter(stream);
+void S6Exporter::Save(IStream * stream, bool isScenario)
+{
+    SetHeader(isScenario);
+
+    // The chunks are encoded in parallel, the larger ones take most of the time spent saving
+    SawyerChunkWriter chunkWriter(stream, true);
 
     // 0: Write header chunk
     chunkWriter.WriteChunk(&_s6.header, SAWYER_ENCODING::ROTATE);
@@ -105,6 +146,7 @@ void S6Exporter::Save(IStream * stream, bool isScenario)
     // 2: Write packed objects
     if (_s6.header.num_packed_objects > 0)
     {
+        chunkWriter.Flush();
         IObjectRepository * objRepo = GetObjectRepository();
         objRepo->WritePackedObjects(stream, ExportObjectsList);
     }
@@ -135,6 +177,7 @@ void S6Exporter::Save(IStream * stream, bool isScenario)
         // 6: Everything else...
         chunkWriter.WriteChunk(&_s6.next_free_tile_element_pointer_index, 0x2E8570, SAWYER_ENCODING::RLECOMPRESSED);
     }
+    chunkWriter.Flush();
 
     // Determine number of bytes written
     size_t fileSize = stream->GetLength();
@@ -356,8 +399,7 @@ void S6Exporter::Export()
     _s6.saved_view_y        = gSavedViewY;
     _s6.saved_view_zoom     = gSavedViewZoom;
     _s6.saved_view_rotation = gSavedViewRotation;
-    memcpy(_s6.map_animations, gAnimatedObjects, sizeof(_s6.map_animations));
-    _s6.num_map_animations = gNumMapAnimations;
+    _s6.num_map_animations = (uint16)map_animation_export(_s6.map_animations, Util::CountOf(_s6.map_animations));
     // pad_0138B582
 
     _s6.ride_ratings_calc_data = gRideRatingsCalcData;
@@ -777,7 +819,12 @@ sint32 scenario_save(const utf8 * path, sint32 flags)
         }
         s6exporter->RemoveTracklessRides = true;
         s6exporter->Export();
-        if (flags & S6_SAVE_FLAG_SCENARIO)
+        if (String::Equals(Path::GetExtension(path), ".park", true))
+        {
+            auto compression = (flags & S6_SAVE_FLAG_AUTOMATIC) ? PARK_FILE_COMPRESSION::FAST : PARK_FILE_COMPRESSION::SMALL;
+            s6exporter->SaveParkFile(path, (flags & S6_SAVE_FLAG_SCENARIO) != 0, compression);
+        }
+        else if (flags & S6_SAVE_FLAG_SCENARIO)
         {
             s6exporter->SaveScenario(path);
         }
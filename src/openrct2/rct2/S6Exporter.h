@@ -19,6 +19,7 @@
 #include <string>
 #include <vector>
 #include "../common.h"
+#include "../ParkFile.h"
 #include "../object/ObjectList.h"
 #include "../scenario/Scenario.h"
 
@@ -40,6 +41,12 @@ public:
     void SaveGame(IStream * stream);
     void SaveScenario(const utf8 * path);
     void SaveScenario(IStream * stream);
+
+    /**
+     * Saves the park in the native park container rather than as an SV6 / SC6.
+     */
+    void SaveParkFile(const utf8 * path, bool isScenario, PARK_FILE_COMPRESSION compression);
+    void SaveParkFile(IStream * stream, bool isScenario, PARK_FILE_COMPRESSION compression);
     void Export();
     void ExportRides();
     void ExportRide(rct2_ride * dst, const Ride * src);
@@ -48,6 +55,7 @@ private:
     rct_s6_data _s6;
 
     void Save(IStream * stream, bool isScenario);
+    void SetHeader(bool isScenario);
     static uint32 GetLoanHash(money32 initialCash, money32 bankLoan, uint32 maxBankLoan);
     void ExportResearchedRideTypes();
     void ExportResearchedRideEntries();
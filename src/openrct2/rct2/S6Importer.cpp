@@ -15,9 +15,12 @@
 #pragma endregion
 
 #include <algorithm>
+#include <cstring>
+#include <vector>
 #include "../core/Console.hpp"
 #include "../core/FileStream.hpp"
 #include "../core/IStream.hpp"
+#include "../core/MemoryStream.h"
 #include "../core/Path.hpp"
 #include "../core/String.hpp"
 #include "../management/Award.h"
@@ -40,6 +43,7 @@
 #include "../management/NewsItem.h"
 #include "../management/Research.h"
 #include "../OpenRCT2.h"
+#include "../ParkFile.h"
 #include "../peep/Staff.h"
 #include "../ride/Ride.h"
 #include "../ride/RideRatings.h"
@@ -86,8 +90,10 @@ public:
         {
             return LoadScenario(path);
         }
-        else if (String::Equals(extension, ".sv6", true))
+        else if (String::Equals(extension, ".sv6", true) ||
+                 String::Equals(extension, ".park", true))
         {
+            // Park files are loaded as whatever their header says they are
             return LoadSavedGame(path);
         }
         else
@@ -117,6 +123,11 @@ public:
                                   bool skipObjectCheck = false,
                                   const utf8 * path = String::Empty) override
     {
+        if (ParkFile::IsParkFile(stream))
+        {
+            return LoadFromParkFile(stream, path);
+        }
+
         if (isScenario && !gConfigGeneral.allow_loading_with_incorrect_checksum && !SawyerEncoding::ValidateChecksum(stream))
         {
             throw IOException("Invalid checksum.");
@@ -126,21 +137,11 @@ public:
         chunkReader.ReadChunk(&_s6.header, sizeof(_s6.header));
 
         log_verbose("saved game classic_flag = 0x%02x\n", _s6.header.classic_flag);
+        CheckParkType(isScenario);
         if (isScenario)
         {
-            if (_s6.header.type != S6_TYPE_SCENARIO)
-            {
-                throw std::runtime_error("Park is not a scenario.");
-            }
             chunkReader.ReadChunk(&_s6.info, sizeof(_s6.info));
         }
-        else
-        {
-            if (_s6.header.type != S6_TYPE_SAVEDGAME)
-            {
-                throw std::runtime_error("Park is not a saved game.");
-            }
-        }
 
         if (_s6.header.classic_flag == 0xf)
         {
@@ -154,37 +155,13 @@ public:
             _objectRepository->ExportPackedObject(stream);
         }
 
-        if (isScenario)
-        {
-            chunkReader.ReadChunk(&_s6.objects, sizeof(_s6.objects));
-            chunkReader.ReadChunk(&_s6.elapsed_months, 16);
-            chunkReader.ReadChunk(&_s6.tile_elements, sizeof(_s6.tile_elements));
-            chunkReader.ReadChunk(&_s6.next_free_tile_element_pointer_index, 2560076);
-            chunkReader.ReadChunk(&_s6.guests_in_park, 4);
-            chunkReader.ReadChunk(&_s6.last_guests_in_park, 8);
-            chunkReader.ReadChunk(&_s6.park_rating, 2);
-            chunkReader.ReadChunk(&_s6.active_research_types, 1082);
-            chunkReader.ReadChunk(&_s6.current_expenditure, 16);
-            chunkReader.ReadChunk(&_s6.park_value, 4);
-            chunkReader.ReadChunk(&_s6.completed_company_value, 483816);
-        }
-        else
-        {
-            chunkReader.ReadChunk(&_s6.objects, sizeof(_s6.objects));
-            chunkReader.ReadChunk(&_s6.elapsed_months, 16);
-            chunkReader.ReadChunk(&_s6.tile_elements, sizeof(_s6.tile_elements));
-            chunkReader.ReadChunk(&_s6.next_free_tile_element_pointer_index, 3048816);
-        }
-
-        auto missingObjects = _objectManager->GetInvalidObjects(_s6.objects);
+        chunkReader.ReadChunk(&_s6.objects, sizeof(_s6.objects));
 
-        if (!missingObjects.empty())
-        {
-            return ParkLoadResult::CreateMissingObjects(missingObjects);
-        }
+        // Each chunk is decoded as it is read, into _s6 rather than the game state, so the current park survives
+        // if objects turn out to be missing or a later chunk is corrupt.
+        ReadParkChunks(chunkReader, isScenario);
 
-        _s6Path = path;
-        return ParkLoadResult::CreateOK();
+        return CheckObjects(path);
     }
 
     bool GetDetails(scenario_index_entry * dst) override
@@ -206,12 +183,13 @@ public:
         gScenarioSrand0    = _s6.scenario_srand_0;
         gScenarioSrand1    = _s6.scenario_srand_1;
 
-        memcpy(gTileElements, _s6.tile_elements, sizeof(_s6.tile_elements));
+        static_assert(sizeof(gTileElements) >= sizeof(_s6.tile_elements), "Tile element chunk must fit in gTileElements");
+        std::memcpy(gTileElements, _s6.tile_elements, sizeof(_s6.tile_elements));
 
         gNextFreeTileElementPointerIndex = _s6.next_free_tile_element_pointer_index;
         for (sint32 i = 0; i < RCT2_MAX_SPRITES; i++)
         {
-            memcpy(get_sprite(i), &_s6.sprites[i], sizeof(rct_sprite));
+            std::memcpy(get_sprite(i), &_s6.sprites[i], sizeof(rct_sprite));
         }
 
         for (sint32 i = 0; i < NUM_SPRITE_LISTS; i++)
@@ -386,11 +364,12 @@ public:
         gSavedViewZoom     = _s6.saved_view_zoom;
         gSavedViewRotation = _s6.saved_view_rotation;
 
-        for (size_t i = 0; i < RCT2_MAX_ANIMATED_OBJECTS; i++)
+        map_animation_clear_all();
+        for (size_t i = 0; i < _s6.num_map_animations && i < RCT2_MAX_ANIMATED_OBJECTS; i++)
         {
-            gAnimatedObjects[i] = _s6.map_animations[i];
+            const rct_map_animation * aobj = &_s6.map_animations[i];
+            map_animation_create(aobj->type, aobj->x, aobj->y, aobj->baseZ);
         }
-        gNumMapAnimations = _s6.num_map_animations;
         // pad_0138B582
 
         gRideRatingsCalcData = _s6.ride_ratings_calc_data;
@@ -769,6 +748,116 @@ public:
         }
     }
 
+    /**
+     * Loads a park from the native container written by S6Exporter::SaveParkFile, leaving the stream positioned
+     * after it.
+     */
+    ParkLoadResult LoadFromParkFile(IStream * stream, const utf8 * path)
+    {
+        uint64 start = stream->GetPosition();
+        auto reader = ParkFileReader(stream);
+        reader.ReadSection(PARK_FILE_SECTION_HEADER, &_s6.header, sizeof(_s6.header));
+
+        // Scenarios and saved games share the park file extension, so the header decides which this is
+        log_verbose("saved game classic_flag = 0x%02x\n", _s6.header.classic_flag);
+        bool isScenario = _s6.header.type == S6_TYPE_SCENARIO;
+        CheckParkType(isScenario);
+        if (isScenario)
+        {
+            reader.ReadSection(PARK_FILE_SECTION_INFO, &_s6.info, sizeof(_s6.info));
+        }
+
+        if (_s6.header.classic_flag == 0xf)
+        {
+            return ParkLoadResult::CreateUnsupportedRCTCflag(_s6.header.classic_flag);
+        }
+
+        // The packed objects section is only written when there are objects to pack
+        if (_s6.header.num_packed_objects > 0)
+        {
+            auto packedObjects = reader.ReadSection(PARK_FILE_SECTION_PACKED_OBJECTS);
+            auto packedObjectsStream = MemoryStream(packedObjects.data(), packedObjects.size());
+            for (uint16 i = 0; i < _s6.header.num_packed_objects; i++)
+            {
+                _objectRepository->ExportPackedObject(&packedObjectsStream);
+            }
+        }
+
+        reader.ReadSection(PARK_FILE_SECTION_OBJECTS, &_s6.objects, sizeof(_s6.objects));
+        ReadParkFileSections(reader);
+        stream->SetPosition(start + reader.GetLength());
+
+        return CheckObjects(path);
+    }
+
+    void CheckParkType(bool isScenario)
+    {
+        if (isScenario)
+        {
+            if (_s6.header.type != S6_TYPE_SCENARIO)
+            {
+                throw std::runtime_error("Park is not a scenario.");
+            }
+        }
+        else
+        {
+            if (_s6.header.type != S6_TYPE_SAVEDGAME)
+            {
+                throw std::runtime_error("Park is not a saved game.");
+            }
+        }
+    }
+
+    ParkLoadResult CheckObjects(const utf8 * path)
+    {
+        auto missingObjects = _objectManager->GetInvalidObjects(_s6.objects);
+
+        if (!missingObjects.empty())
+        {
+            return ParkLoadResult::CreateMissingObjects(missingObjects);
+        }
+
+        _s6Path = path;
+        return ParkLoadResult::CreateOK();
+    }
+
+    /**
+     * Decodes the chunks after the object list into _s6. Scenarios split the part of the park after the tile elements
+     * over several smaller chunks.
+     */
+    void ReadParkChunks(SawyerChunkReader &chunkReader, bool isScenario)
+    {
+        chunkReader.ReadChunk(&_s6.elapsed_months, 16);
+        chunkReader.ReadChunk(&_s6.tile_elements, sizeof(_s6.tile_elements));
+        if (isScenario)
+        {
+            chunkReader.ReadChunk(&_s6.next_free_tile_element_pointer_index, 2560076);
+            chunkReader.ReadChunk(&_s6.guests_in_park, 4);
+            chunkReader.ReadChunk(&_s6.last_guests_in_park, 8);
+            chunkReader.ReadChunk(&_s6.park_rating, 2);
+            chunkReader.ReadChunk(&_s6.active_research_types, 1082);
+            chunkReader.ReadChunk(&_s6.current_expenditure, 16);
+            chunkReader.ReadChunk(&_s6.park_value, 4);
+            chunkReader.ReadChunk(&_s6.completed_company_value, 483816);
+        }
+        else
+        {
+            chunkReader.ReadChunk(&_s6.next_free_tile_element_pointer_index, 3048816);
+        }
+    }
+
+    /**
+     * Decodes the sections of a park file into _s6. Every section is checked against its checksum as it is read.
+     */
+    void ReadParkFileSections(ParkFileReader &reader)
+    {
+        reader.ReadSection(PARK_FILE_SECTION_DATE, &_s6.elapsed_months, 16);
+        reader.ReadSection(PARK_FILE_SECTION_TILE_ELEMENTS, &_s6.tile_elements, sizeof(_s6.tile_elements));
+
+        // The park section always holds the whole of the saved game chunk, scenario or not
+        reader.ReadSection(PARK_FILE_SECTION_PARK, &_s6.next_free_tile_element_pointer_index, 3048816);
+    }
+
     void ImportResearchList()
     {
         memcpy(gResearchItems, _s6.research_items, sizeof(_s6.research_items));
@@ -824,9 +913,11 @@ public:
     void ImportNumRiders(Ride * dst, const uint8 rideIndex)
     {
         // The number of riders might have overflown or underflown. Re-calculate the value.
+        // The sprites have already been imported by the time the rides are.
         uint16 numRiders = 0;
-        for (const rct_sprite &sprite : _s6.sprites)
+        for (sint32 i = 0; i < RCT2_MAX_SPRITES; i++)
         {
+            const rct_sprite &sprite = *get_sprite(i);
             if (sprite.unknown.sprite_identifier == SPRITE_IDENTIFIER_PEEP)
             {
                 if (sprite.peep.current_ride == rideIndex &&
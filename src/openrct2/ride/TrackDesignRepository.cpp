@@ -57,7 +57,28 @@ std::string GetNameFromTrackPath(const std::string &path)
     return name;
 }
 
-class TrackDesignFileIndex final : public FileIndex<TrackRepositoryItem>
+// Fixed size record of a track design in the track design index
+struct TrackIndexRecord
+{
+    uint32 NameOffset;
+    uint32 PathOffset;
+    uint32 ObjectEntryOffset;
+    uint32 Flags;
+    uint8  RideType;
+};
+
+template<>
+inline constexpr TrackIndexRecord bswap<TrackIndexRecord>(const TrackIndexRecord &nat) {
+    return TrackIndexRecord{
+        .NameOffset = bswap(nat.NameOffset),
+        .PathOffset = bswap(nat.PathOffset),
+        .ObjectEntryOffset = bswap(nat.ObjectEntryOffset),
+        .Flags = bswap(nat.Flags),
+        .RideType = nat.RideType,
+    };
+}
+
+class TrackDesignFileIndex final : public FileIndex<TrackRepositoryItem, TrackIndexRecord>
 {
 private:
     static constexpr uint32 MAGIC_NUMBER = 0x58444954; // TIDX
@@ -104,23 +125,25 @@ public:
     }
 
 protected:
-    void Serialise(IStream * stream, const TrackRepositoryItem &item) const override
+    TrackIndexRecord Serialise(const TrackRepositoryItem &item, FileIndexPool * pool) const override
     {
-        stream->WriteString(item.Name);
-        stream->WriteString(item.Path);
-        stream->WriteValue(item.RideType);
-        stream->WriteString(item.ObjectEntry);
-        stream->WriteValue(item.Flags);
+        TrackIndexRecord record = { 0 };
+        record.NameOffset = pool->AddString(item.Name);
+        record.PathOffset = pool->AddString(item.Path);
+        record.ObjectEntryOffset = pool->AddString(item.ObjectEntry);
+        record.Flags = item.Flags;
+        record.RideType = item.RideType;
+        return record;
     }
 
-    TrackRepositoryItem Deserialise(IStream * stream) const override
+    TrackRepositoryItem Deserialise(const TrackIndexRecord &record, const FileIndexData &data) const override
     {
         TrackRepositoryItem item;
-        item.Name = stream->ReadStdString();
-        item.Path = stream->ReadStdString();
-        item.RideType = stream->ReadValue<uint8>();
-        item.ObjectEntry = stream->ReadStdString();
-        item.Flags = stream->ReadValue<uint32>();
+        item.Name = data.GetString(record.NameOffset);
+        item.Path = data.GetString(record.PathOffset);
+        item.RideType = record.RideType;
+        item.ObjectEntry = data.GetString(record.ObjectEntryOffset);
+        item.Flags = record.Flags;
         return item;
     }
 
@@ -14,6 +14,8 @@
  *****************************************************************************/
 #pragma endregion
 
+#include <algorithm>
+#include <vector>
 #include "../Context.h"
 #include "../Editor.h"
 #include "../OpenRCT2.h"
@@ -85,6 +87,7 @@ static sint32 vehicle_update_scream_sound(rct_vehicle * vehicle);
 
 static void vehicle_kill_all_passengers(rct_vehicle * vehicle);
 static bool vehicle_can_depart_synchronised(rct_vehicle * vehicle);
+static rct_ride_entry * vehicle_get_ride_entry(const rct_vehicle * vehicle);
 
 #define NO_SCREAM 254
 #define VEHICLE_INVALID_ID -1
@@ -108,6 +111,14 @@ uint8         _vehicleF64E2C;
 rct_vehicle * _vehicleFrontVehicle;
 LocationXYZ16 unk_F64E20;
 
+// Ride objects can not be loaded or unloaded while the vehicles are updated, so the entries are
+// looked up once per tick instead of once per car and per call.
+static bool             _vehicleRideEntryCacheActive = false;
+static bool             _vehicleRideEntryCached[MAX_RIDE_OBJECTS];
+static rct_ride_entry * _vehicleRideEntryCache[MAX_RIDE_OBJECTS];
+
+static std::vector<uint16> _vehicleUpdateOrder;
+
 // clang-format off
 static constexpr const uint8 byte_9A3A14[] = { SOUND_SCREAM_8, SOUND_SCREAM_1 };
 static constexpr const uint8 byte_9A3A16[] = { SOUND_SCREAM_1, SOUND_SCREAM_6 };
@@ -958,7 +969,7 @@ static void vehicle_update_sound_params(rct_vehicle * vehicle)
 
     sint32 frequency = std::abs(vehicle->velocity);
 
-    rct_ride_entry * ride_type = get_ride_entry(vehicle->ride_subtype);
+    rct_ride_entry * ride_type = vehicle_get_ride_entry(vehicle);
     if (ride_type != nullptr)
     {
         if (ride_type->vehicles[vehicle->vehicle_type].double_sound_frequency & 1)
@@ -1345,14 +1356,51 @@ void vehicle_update_all()
     if ((gScreenFlags & SCREEN_FLAGS_TRACK_DESIGNER) && gS6Info.editor_step != EDITOR_STEP_ROLLERCOASTER_DESIGNER)
         return;
 
-    sprite_index = gSpriteListHead[SPRITE_LIST_TRAIN];
-    while (sprite_index != SPRITE_INDEX_NULL)
+    // Update the trains grouped by ride so each ride and its track stay in cache. The trains of a
+    // ride keep their list order as they interact through stations and block sections.
+    uint16 rideOffsets[MAX_RIDES + 2] = {};
+    for (sprite_index = gSpriteListHead[SPRITE_LIST_TRAIN]; sprite_index != SPRITE_INDEX_NULL; sprite_index = vehicle->next)
     {
-        vehicle      = GET_VEHICLE(sprite_index);
-        sprite_index = vehicle->next;
+        vehicle = GET_VEHICLE(sprite_index);
+        rideOffsets[Math::Min<sint32>(vehicle->ride, MAX_RIDES) + 1]++;
+    }
+    for (sint32 i = 1; i < MAX_RIDES + 2; i++)
+    {
+        rideOffsets[i] += rideOffsets[i - 1];
+    }
+    _vehicleUpdateOrder.resize(rideOffsets[MAX_RIDES + 1]);
+    for (sprite_index = gSpriteListHead[SPRITE_LIST_TRAIN]; sprite_index != SPRITE_INDEX_NULL; sprite_index = vehicle->next)
+    {
+        vehicle = GET_VEHICLE(sprite_index);
+        _vehicleUpdateOrder[rideOffsets[Math::Min<sint32>(vehicle->ride, MAX_RIDES)]++] = sprite_index;
+    }
 
-        vehicle_update(vehicle);
+    std::fill(std::begin(_vehicleRideEntryCached), std::end(_vehicleRideEntryCached), false);
+    _vehicleRideEntryCacheActive = true;
+    for (uint16 trainIndex : _vehicleUpdateOrder)
+    {
+        vehicle = GET_VEHICLE(trainIndex);
+        if (vehicle->linked_list_type_offset == SPRITE_LIST_TRAIN * 2)
+        {
+            vehicle_update(vehicle);
+        }
+    }
+    _vehicleRideEntryCacheActive = false;
+}
+
+static rct_ride_entry * vehicle_get_ride_entry(const rct_vehicle * vehicle)
+{
+    uint8 subtype = vehicle->ride_subtype;
+    if (!_vehicleRideEntryCacheActive || subtype >= MAX_RIDE_OBJECTS)
+    {
+        return get_ride_entry(subtype);
+    }
+    if (!_vehicleRideEntryCached[subtype])
+    {
+        _vehicleRideEntryCache[subtype]  = get_ride_entry(subtype);
+        _vehicleRideEntryCached[subtype] = true;
     }
+    return _vehicleRideEntryCache[subtype];
 }
 
 /**
@@ -1426,7 +1474,7 @@ static bool vehicle_open_restraints(rct_vehicle * vehicle)
         vehicle->swing_sprite       = 0;
 
         Ride *           ride      = get_ride(vehicle->ride);
-        rct_ride_entry * rideEntry = get_ride_entry(vehicle->ride_subtype);
+        rct_ride_entry * rideEntry = vehicle_get_ride_entry(vehicle);
         if (rideEntry == nullptr)
         {
             continue;
@@ -1931,7 +1979,7 @@ static void vehicle_update(rct_vehicle * vehicle)
         return;
     }
 
-    rideEntry = get_ride_entry(vehicle->ride_subtype);
+    rideEntry = vehicle_get_ride_entry(vehicle);
 
     rct_ride_entry_vehicle * vehicleEntry = &rideEntry->vehicles[vehicle->vehicle_type];
 
@@ -2080,7 +2128,7 @@ static void vehicle_update_moving_to_end_of_station(rct_vehicle * vehicle)
         break;
     default:
     {
-        rct_ride_entry * rideEntry = get_ride_entry(vehicle->ride_subtype);
+        rct_ride_entry * rideEntry = vehicle_get_ride_entry(vehicle);
         if (rideEntry == nullptr)
         {
             return;
@@ -2437,7 +2485,7 @@ static void vehicle_update_waiting_for_passengers(rct_vehicle * vehicle)
 static void vehicle_update_dodgems_mode(rct_vehicle * vehicle)
 {
     Ride *           ride      = get_ride(vehicle->ride);
-    rct_ride_entry * rideEntry = get_ride_entry(vehicle->ride_subtype);
+    rct_ride_entry * rideEntry = vehicle_get_ride_entry(vehicle);
     if (rideEntry == nullptr)
     {
         return;
@@ -3204,7 +3252,7 @@ static void vehicle_update_departing_boat_hire(rct_vehicle * vehicle)
 static void vehicle_update_departing(rct_vehicle * vehicle)
 {
     Ride *           ride      = get_ride(vehicle->ride);
-    rct_ride_entry * rideEntry = get_ride_entry(vehicle->ride_subtype);
+    rct_ride_entry * rideEntry = vehicle_get_ride_entry(vehicle);
     if (rideEntry == nullptr)
     {
         return;
@@ -3890,7 +3938,7 @@ static void vehicle_update_arriving(rct_vehicle * vehicle)
         unkF64E35 = 0;
     }
 
-    rct_ride_entry *         rideEntry    = get_ride_entry(vehicle->ride_subtype);
+    rct_ride_entry *         rideEntry    = vehicle_get_ride_entry(vehicle);
     rct_ride_entry_vehicle * vehicleEntry = &rideEntry->vehicles[vehicle->vehicle_type];
 
     if (vehicle->sub_state == 0)
@@ -4622,7 +4670,7 @@ static void vehicle_update_boat_location(rct_vehicle * vehicle)
     uint8 curDirection  = ((vehicle->sprite_direction + 19) >> 3) & 3;
     uint8 randDirection = scenario_rand() & 3;
 
-    rct_ride_entry * rideEntry = get_ride_entry(vehicle->ride_subtype);
+    rct_ride_entry * rideEntry = vehicle_get_ride_entry(vehicle);
     if (!(rideEntry->flags & RIDE_ENTRY_FLAG_7) || vehicle->lost_time_out > 1920)
     {
         if (scenario_rand() & 1)
@@ -4708,7 +4756,7 @@ static bool vehicle_is_boat_on_water(rct_vehicle * vehicle, sint32 x, sint32 y)
 static void vehicle_update_swinging(rct_vehicle * vehicle)
 {
     Ride *           ride      = get_ride(vehicle->ride);
-    rct_ride_entry * rideEntry = get_ride_entry(vehicle->ride_subtype);
+    rct_ride_entry * rideEntry = vehicle_get_ride_entry(vehicle);
 
     // SubState for this ride means swinging state
     // 0 == first swing
@@ -4901,7 +4949,7 @@ static void vehicle_update_rotating(rct_vehicle * vehicle)
         return;
 
     Ride *           ride      = get_ride(vehicle->ride);
-    rct_ride_entry * rideEntry = get_ride_entry(vehicle->ride_subtype);
+    rct_ride_entry * rideEntry = vehicle_get_ride_entry(vehicle);
     if (rideEntry == nullptr)
     {
         return;
@@ -5501,7 +5549,7 @@ static void vehicle_update_sound(rct_vehicle * vehicle)
     uint16 soundIdVolume;
 
     ride      = get_ride(vehicle->ride);
-    rideEntry = get_ride_entry(vehicle->ride_subtype);
+    rideEntry = vehicle_get_ride_entry(vehicle);
 
     if (rideEntry == nullptr)
     {
@@ -5610,7 +5658,7 @@ static sint32 vehicle_update_scream_sound(rct_vehicle * vehicle)
     rct_ride_entry * rideEntry;
     rct_vehicle *    vehicle2;
 
-    rideEntry = get_ride_entry(vehicle->ride_subtype);
+    rideEntry = vehicle_get_ride_entry(vehicle);
 
     rct_ride_entry_vehicle * vehicleEntry = &rideEntry->vehicles[vehicle->vehicle_type];
 
@@ -6428,7 +6476,7 @@ static sint32 vehicle_update_motion_dodgems(rct_vehicle * vehicle)
     edx >>= 5;
     eax += edx;
     eax /= vehicle->mass;
-    rct_ride_entry *         rideEntry    = get_ride_entry(vehicle->ride_subtype);
+    rct_ride_entry *         rideEntry    = vehicle_get_ride_entry(vehicle);
     rct_ride_entry_vehicle * vehicleEntry = &rideEntry->vehicles[vehicle->vehicle_type];
 
     if (!(vehicleEntry->flags & VEHICLE_ENTRY_FLAG_POWERED))
@@ -7593,7 +7641,7 @@ static void vehicle_update_play_water_splash_sound()
  */
 static void vehicle_update_handle_water_splash(rct_vehicle * vehicle)
 {
-    rct_ride_entry * rideEntry = get_ride_entry(vehicle->ride_subtype);
+    rct_ride_entry * rideEntry = vehicle_get_ride_entry(vehicle);
     sint32           trackType = vehicle->track_type >> 2;
 
     if (!(rideEntry->flags & RIDE_ENTRY_FLAG_PLAY_SPLASH_SOUND))
@@ -8739,7 +8787,7 @@ static sint32 vehicle_update_track_motion_mini_golf(rct_vehicle * vehicle, sint3
     registers regs = { 0 };
 
     Ride *                   ride         = get_ride(vehicle->ride);
-    rct_ride_entry *         rideEntry    = get_ride_entry(vehicle->ride_subtype);
+    rct_ride_entry *         rideEntry    = vehicle_get_ride_entry(vehicle);
     rct_ride_entry_vehicle * vehicleEntry = vehicle_get_vehicle_entry(vehicle);
 
     rct_tile_element * tileElement = nullptr;
@@ -9602,7 +9650,7 @@ sint32 vehicle_update_track_motion(rct_vehicle * vehicle, sint32 * outStation)
     registers regs = { 0 };
 
     Ride *                   ride = get_ride(vehicle->ride);
-    rct_ride_entry *         rideEntry = get_ride_entry(vehicle->ride_subtype);
+    rct_ride_entry *         rideEntry = vehicle_get_ride_entry(vehicle);
     rct_ride_entry_vehicle * vehicleEntry = vehicle_get_vehicle_entry(vehicle);
 
     if (vehicleEntry == nullptr)
@@ -9856,7 +9904,7 @@ sint32 vehicle_update_track_motion(rct_vehicle * vehicle, sint32 * outStation)
 
 rct_ride_entry_vehicle * vehicle_get_vehicle_entry(rct_vehicle * vehicle)
 {
-    rct_ride_entry * rideEntry = get_ride_entry(vehicle->ride_subtype);
+    rct_ride_entry * rideEntry = vehicle_get_ride_entry(vehicle);
     if (rideEntry == nullptr)
     {
         return nullptr;
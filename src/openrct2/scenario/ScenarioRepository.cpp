@@ -119,11 +119,48 @@ static void scenario_highscore_free(scenario_highscore_entry * highscore)
     SafeDelete(highscore);
 }
 
-class ScenarioFileIndex final : public FileIndex<scenario_index_entry>
+// Fixed size record of a scenario in the scenario index
+struct ScenarioIndexRecord
+{
+    uint64  Timestamp;
+    uint32  PathOffset;
+    uint32  InternalNameOffset;
+    uint32  NameOffset;
+    uint32  DetailsOffset;
+    sint32  ObjectiveArg2;
+    sint16  SourceIndex;
+    uint16  ScId;
+    sint16  ObjectiveArg3;
+    uint8   Category;
+    uint8   SourceGame;
+    uint8   ObjectiveType;
+    uint8   ObjectiveArg1;
+};
+
+template<>
+inline constexpr ScenarioIndexRecord bswap<ScenarioIndexRecord>(const ScenarioIndexRecord &nat) {
+    return ScenarioIndexRecord{
+        .Timestamp = bswap(nat.Timestamp),
+        .PathOffset = bswap(nat.PathOffset),
+        .InternalNameOffset = bswap(nat.InternalNameOffset),
+        .NameOffset = bswap(nat.NameOffset),
+        .DetailsOffset = bswap(nat.DetailsOffset),
+        .ObjectiveArg2 = bswap(nat.ObjectiveArg2),
+        .SourceIndex = bswap(nat.SourceIndex),
+        .ScId = bswap(nat.ScId),
+        .ObjectiveArg3 = bswap(nat.ObjectiveArg3),
+        .Category = nat.Category,
+        .SourceGame = nat.SourceGame,
+        .ObjectiveType = nat.ObjectiveType,
+        .ObjectiveArg1 = nat.ObjectiveArg1,
+    };
+}
+
+class ScenarioFileIndex final : public FileIndex<scenario_index_entry, ScenarioIndexRecord>
 {
 private:
     static constexpr uint32 MAGIC_NUMBER = 0x58444953; // SIDX
-    static constexpr uint16 VERSION = 3;
+    static constexpr uint16 VERSION = 5;
     static constexpr auto PATTERN = "*.sc4;*.sc6";
     
 public:
@@ -155,47 +192,49 @@ protected:
         }
     }
 
-    void Serialise(IStream * stream, const scenario_index_entry &item) const override
+    ScenarioIndexRecord Serialise(const scenario_index_entry &item, FileIndexPool * pool) const override
     {
-        stream->Write(item.path, sizeof(item.path));
-        stream->WriteValue(item.timestamp);
-
-        stream->WriteValue(item.category);
-        stream->WriteValue(item.source_game);
-        stream->WriteValue(item.source_index);
-        stream->WriteValue(item.sc_id);
-
-        stream->WriteValue(item.objective_type);
-        stream->WriteValue(item.objective_arg_1);
-        stream->WriteValue(item.objective_arg_2);
-        stream->WriteValue(item.objective_arg_3);
-
-        stream->Write(item.internal_name, sizeof(item.internal_name));
-        stream->Write(item.name, sizeof(item.name));
-        stream->Write(item.details, sizeof(item.details));
+        ScenarioIndexRecord record = { 0 };
+        record.Timestamp = item.timestamp;
+        record.PathOffset = pool->AddString(item.path);
+
+        record.Category = item.category;
+        record.SourceGame = item.source_game;
+        record.SourceIndex = item.source_index;
+        record.ScId = item.sc_id;
+
+        record.ObjectiveType = item.objective_type;
+        record.ObjectiveArg1 = item.objective_arg_1;
+        record.ObjectiveArg2 = item.objective_arg_2;
+        record.ObjectiveArg3 = item.objective_arg_3;
+
+        record.InternalNameOffset = pool->AddString(item.internal_name);
+        record.NameOffset = pool->AddString(item.name);
+        record.DetailsOffset = pool->AddString(item.details);
+        return record;
     }
 
-    scenario_index_entry Deserialise(IStream * stream) const override
+    scenario_index_entry Deserialise(const ScenarioIndexRecord &record, const FileIndexData &data) const override
     {
         scenario_index_entry item;
 
-        stream->Read(item.path, sizeof(item.path));
-        item.timestamp = stream->ReadValue<uint64>();
+        String::Set(item.path, sizeof(item.path), data.GetString(record.PathOffset));
+        item.timestamp = record.Timestamp;
 
-        item.category = stream->ReadValue<uint8>();
-        item.source_game = stream->ReadValue<uint8>();
-        item.source_index = stream->ReadValue<sint16>();
-        item.sc_id = stream->ReadValue<uint16>();
+        item.category = record.Category;
+        item.source_game = record.SourceGame;
+        item.source_index = record.SourceIndex;
+        item.sc_id = record.ScId;
 
-        item.objective_type = stream->ReadValue<uint8>();
-        item.objective_arg_1 = stream->ReadValue<uint8>();
-        item.objective_arg_2 = stream->ReadValue<sint32>();
-        item.objective_arg_3 = stream->ReadValue<sint16>();
+        item.objective_type = record.ObjectiveType;
+        item.objective_arg_1 = record.ObjectiveArg1;
+        item.objective_arg_2 = record.ObjectiveArg2;
+        item.objective_arg_3 = record.ObjectiveArg3;
         item.highscore = nullptr;
 
-        stream->Read(item.internal_name, sizeof(item.internal_name));
-        stream->Read(item.name, sizeof(item.name));
-        stream->Read(item.details, sizeof(item.details));
+        String::Set(item.internal_name, sizeof(item.internal_name), data.GetString(record.InternalNameOffset));
+        String::Set(item.name, sizeof(item.name), data.GetString(record.NameOffset));
+        String::Set(item.details, sizeof(item.details), data.GetString(record.DetailsOffset));
 
         return item;
     }
@@ -216,9 +255,7 @@ private:
                 bool result = false;
                 try
                 {
-                    auto s4Importer = std::unique_ptr<IParkImporter>(ParkImporter::CreateS4());
-                    s4Importer->LoadScenario(path.c_str(), true);
-                    if (s4Importer->GetDetails(entry))
+                    if (ParkImporter::ReadS4ScenarioDetails(path, entry))
                     {
                         String::Set(entry->path, sizeof(entry->path), path.c_str());
                         entry->timestamp = timestamp;
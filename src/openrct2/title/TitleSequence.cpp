@@ -374,7 +374,7 @@ static std::vector<utf8 *> GetSaves(const utf8 * directory)
 
     utf8 pattern[MAX_PATH];
     String::Set(pattern, sizeof(pattern), directory);
-    Path::Append(pattern, sizeof(pattern), "*.sc6;*.sv6");
+    Path::Append(pattern, sizeof(pattern), "*.sc6;*.sv6;*.park");
 
     IFileScanner * scanner = Path::ScanDirectory(pattern, true);
     while (scanner->Next())
@@ -394,7 +394,8 @@ static std::vector<utf8 *> GetSaves(IZipArchive * zip)
         const utf8 * name = zip->GetFileName(i);
         const utf8 * ext = Path::GetExtension(name);
         if (String::Equals(ext, ".sv6", true) ||
-            String::Equals(ext, ".sc6", true))
+            String::Equals(ext, ".sc6", true) ||
+            String::Equals(ext, ".park", true))
         {
             saves.push_back(String::Duplicate(name));
         }
@@ -22,6 +22,8 @@
 
 static size_t decode_chunk_rle(const uint8* src_buffer, uint8* dst_buffer, size_t length);
 static size_t decode_chunk_rle_with_size(const uint8* src_buffer, uint8* dst_buffer, size_t length, size_t dstSize);
+static size_t decode_chunk_rle_range(const uint8* src_buffer, size_t length, uint8* dst_buffer, size_t offset, size_t dstSize);
+static size_t get_decoded_length_rle(const uint8* src_buffer, size_t length);
 
 static size_t encode_chunk_rle(const uint8 *src_buffer, uint8 *dst_buffer, size_t length);
 static size_t encode_chunk_repeat(const uint8 *src_buffer, uint8 *dst_buffer, size_t length);
@@ -109,17 +111,50 @@ size_t sawyercoding_decode_sc4(const uint8 *src, uint8 *dst, size_t length, size
     size_t decodedLength = decode_chunk_rle_with_size(src, dst, length - 4, bufferLength);
 
     // Decode
-    for (size_t i = 0x60018; i <= Math::Min(decodedLength - 1, (size_t)0x1F8353); i++)
-        dst[i] = dst[i] ^ 0x9C;
+    sawyercoding_decrypt_sc4(dst, 0, decodedLength);
 
-    for (size_t i = 0x60018; i <= Math::Min(decodedLength - 1, (size_t)0x1F8350); i += 4) {
-        dst[i + 1] = ror8(dst[i + 1], 3);
+    return decodedLength;
+}
 
-        uint32 *code = (uint32*)&dst[i];
+size_t sawyercoding_decode_sv4_range(const uint8 *src, size_t length, uint8 *dst, size_t offset, size_t bufferLength)
+{
+    // (0 to length - 4): RLE chunk
+    // (length - 4 to length): checksum
+    if (length < 4)
+        return 0;
+    return decode_chunk_rle_range(src, length - 4, dst, offset, bufferLength);
+}
+
+size_t sawyercoding_get_decoded_length_sv4(const uint8 *src, size_t length)
+{
+    // (0 to length - 4): RLE chunk
+    // (length - 4 to length): checksum
+    if (length < 4)
+        return 0;
+    return get_decoded_length_rle(src, length - 4);
+}
+
+/**
+ * Decrypts the bytes [offset, offset + length) of a decoded SC4 held in data. The cipher works on
+ * whole 32-bit words, so only words lying entirely inside the range are decrypted.
+ */
+void sawyercoding_decrypt_sc4(uint8 *data, size_t offset, size_t length)
+{
+    const size_t encryptedStart = 0x60018;
+    const size_t end = offset + length;
+
+    for (size_t i = Math::Max(offset, encryptedStart); i < end && i <= 0x1F8353; i++)
+        data[i - offset] = data[i - offset] ^ 0x9C;
+
+    size_t firstWord = Math::Max(offset, encryptedStart);
+    firstWord += (4 - ((firstWord - encryptedStart) & 3)) & 3;
+    for (size_t i = firstWord; i + 4 <= end && i <= 0x1F8350; i += 4) {
+        uint8 *word = &data[i - offset];
+        word[1] = ror8(word[1], 3);
+
+        uint32 *code = (uint32*)word;
         *code = rol32(*code, 9);
     }
-
-    return decodedLength;
 }
 
 size_t sawyercoding_encode_sv4(const uint8 *src, uint8 *dst, size_t length)
@@ -245,6 +280,75 @@ static size_t decode_chunk_rle_with_size(const uint8* src_buffer, uint8* dst_buf
     return dst - dst_buffer;
 }
 
+/**
+ * Decodes only the bytes [offset, offset + dstSize) of an RLE chunk into dst_buffer. Runs before
+ * the range are skipped without being written out and decoding stops once the range is filled.
+ * Returns the number of bytes written, which is less than dstSize if the chunk is too short.
+ */
+static size_t decode_chunk_rle_range(const uint8* src_buffer, size_t length, uint8* dst_buffer, size_t offset, size_t dstSize)
+{
+    const size_t end = offset + dstSize;
+    size_t position = 0;
+    size_t written = 0;
+
+    for (size_t i = 0; i < length && position < end; i++) {
+        uint8 rleCodeByte = src_buffer[i];
+        const uint8 *literal = nullptr;
+        uint8 value = 0;
+        size_t count;
+        if (rleCodeByte & 128) {
+            i++;
+            if (i >= length)
+                break;
+            count = 257 - rleCodeByte;
+            value = src_buffer[i];
+        } else {
+            count = rleCodeByte + 1;
+            if (i + count >= length)
+                break;
+            literal = src_buffer + i + 1;
+            i += count;
+        }
+
+        if (position + count > offset) {
+            size_t from = Math::Max(position, offset);
+            size_t to = Math::Min(position + count, end);
+            if (literal != nullptr) {
+                memcpy(dst_buffer + (from - offset), literal + (from - position), to - from);
+            } else {
+                memset(dst_buffer + (from - offset), value, to - from);
+            }
+            written += to - from;
+        }
+        position += count;
+    }
+
+    return written;
+}
+
+/**
+ * Returns the length an RLE chunk decodes to without decoding it, or 0 if the chunk is truncated.
+ */
+static size_t get_decoded_length_rle(const uint8* src_buffer, size_t length)
+{
+    size_t position = 0;
+    for (size_t i = 0; i < length; i++) {
+        uint8 rleCodeByte = src_buffer[i];
+        if (rleCodeByte & 128) {
+            i++;
+            if (i >= length)
+                return 0;
+            position += 257 - rleCodeByte;
+        } else {
+            if (i + rleCodeByte + 1 >= length)
+                return 0;
+            position += rleCodeByte + 1;
+            i += rleCodeByte + 1;
+        }
+    }
+    return position;
+}
+
 #pragma endregion
 
 #pragma region Encoding
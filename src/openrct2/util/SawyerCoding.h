@@ -61,6 +61,9 @@ uint32 sawyercoding_calculate_checksum(const uint8* buffer, size_t length);
 size_t sawyercoding_write_chunk_buffer(uint8 *dst_file, const uint8 *src_buffer, sawyercoding_chunk_header chunkHeader);
 size_t sawyercoding_decode_sv4(const uint8 *src, uint8 *dst, size_t length, size_t bufferLength);
 size_t sawyercoding_decode_sc4(const uint8 *src, uint8 *dst, size_t length, size_t bufferLength);
+size_t sawyercoding_decode_sv4_range(const uint8 *src, size_t length, uint8 *dst, size_t offset, size_t bufferLength);
+size_t sawyercoding_get_decoded_length_sv4(const uint8 *src, size_t length);
+void sawyercoding_decrypt_sc4(uint8 *data, size_t offset, size_t length);
 size_t sawyercoding_encode_sv4(const uint8 *src, uint8 *dst, size_t length);
 size_t sawyercoding_decode_td6(const uint8 *src, uint8 *dst, size_t length);
 size_t sawyercoding_encode_td6(const uint8 *src, uint8 *dst, size_t length);
@@ -350,6 +350,7 @@ static money32 footpath_element_update(sint32 x, sint32 y, rct_tile_element *til
 
         footpath_element_set_path_scenery(tileElement, pathItemType);
         tileElement->flags &= ~TILE_ELEMENT_FLAG_BROKEN;
+        map_update_tiles_wake(x / 32, y / 32);
         if (pathItemType != 0) {
             rct_scenery_entry* scenery_entry = get_footpath_item_entry(pathItemType - 1);
             if (scenery_entry->path_bit.flags & PATH_BIT_FLAG_IS_BIN) {
@@ -374,6 +375,7 @@ static money32 footpath_element_update(sint32 x, sint32 y, rct_tile_element *til
         tileElement->type = (tileElement->type & 0xFE) | (type >> 7);
         footpath_element_set_path_scenery(tileElement, pathItemType);
         tileElement->flags &= ~TILE_ELEMENT_FLAG_BROKEN;
+        map_update_tiles_wake(x / 32, y / 32);
 
         loc_6A6620(flags, x, y, tileElement);
     }
@@ -14,6 +14,8 @@
  *****************************************************************************/
 #pragma endregion
 
+#include <algorithm>
+#include <vector>
 #include "../audio/audio.h"
 #include "../Cheats.h"
 #include "../config/Config.h"
@@ -121,6 +123,7 @@ LocationXYZ16 gCommandPosition;
 bool gMapLandRightsUpdateSuccess;
 
 static void map_update_grass_length(sint32 x, sint32 y, rct_tile_element *tileElement);
+static void map_update_tiles_reset_schedule();
 static void map_set_grass_length(sint32 x, sint32 y, rct_tile_element *tileElement, sint32 length);
 static void clear_elements_at(sint32 x, sint32 y);
 static void translate_3d_to_2d(sint32 rotation, sint32 *x, sint32 *y);
@@ -398,7 +401,7 @@ rct_tile_element* map_get_banner_element_at(sint32 x, sint32 y, sint32 z, uint8
  */
 void map_init(sint32 size)
 {
-    gNumMapAnimations = 0;
+    map_animation_clear_all();
     gNextFreeTileElementPointerIndex = 0;
 
     for (sint32 i = 0; i < MAX_TILE_TILE_ELEMENT_POINTERS; i++) {
@@ -511,6 +514,7 @@ void map_update_tile_pointers()
     }
 
     gNextFreeTileElement = tileElement;
+    map_update_tiles_reset_schedule();
 }
 
 /**
@@ -3036,12 +3040,7 @@ void map_invalidate_selection_rect()
     bottom += 32;
     top -= 32 + 2080;
 
-    for (sint32 i = 0; i < MAX_VIEWPORT_COUNT; i++) {
-        rct_viewport *viewport = &g_viewport_list[i];
-        if (viewport->width != 0) {
-            viewport_invalidate(viewport, left, top, right, bottom);
-        }
-    }
+    viewports_invalidate(left, top, right, bottom);
 }
 
 /**
@@ -3165,6 +3164,7 @@ rct_tile_element *tile_element_insert(sint32 x, sint32 y, sint32 z, sint32 flags
     }
 
     gNextFreeTileElement = newTileElement;
+    map_update_tiles_wake(x, y);
     return insertedElement;
 }
 
@@ -3384,6 +3384,147 @@ sint32 map_can_construct_at(sint32 x, sint32 y, sint32 zLow, sint32 zHigh, uint8
     return gCheatsDisableClearanceChecks || map_can_construct_with_clear_at(x, y, zLow, zHigh, nullptr, bl, 0, nullptr, CREATE_CROSSING_MODE_NONE);
 }
 
+// Loop positions of map_update_tiles whose tile may have something to grow, age or animate, one
+// bit per position. A tile is dropped once its turn finds nothing to do and woken again when
+// something that could give it work changes, so each tick only visits the tiles that matter while
+// keeping the visiting order, and with it the order of scenario_rand calls, of a full walk.
+static std::vector<uint32> _tileUpdateSchedule;
+static sint32 _tileUpdateScheduleBits;
+static sint32 _tileUpdateScheduleMapSize;
+static bool _tileUpdateScheduleValid = false;
+
+/**
+ * Returns the number of bits per axis walked by map_update_tiles: the smallest power of two square
+ * that covers the map, but never less than the 256x256 area RCT2 walks so the visiting order of
+ * legacy parks is unchanged.
+ */
+static sint32 map_update_tiles_get_num_bits()
+{
+    sint32 numBits = 8;
+    while ((1 << numBits) < gMapSize && (1 << numBits) < MAXIMUM_MAP_SIZE_TECHNICAL) {
+        numBits++;
+    }
+    return numBits;
+}
+
+static uint32 map_update_tiles_get_position(sint32 x, sint32 y, sint32 numBits)
+{
+    uint32 position = 0;
+    for (sint32 i = 0; i < numBits; i++) {
+        sint32 bit = numBits - 1 - i;
+        position |= (uint32)((x >> bit) & 1) << (i * 2);
+        position |= (uint32)((y >> bit) & 1) << (i * 2 + 1);
+    }
+    return position;
+}
+
+/**
+ * Checks whether a turn of map_update_tiles on the tile would leave it unchanged: the grass is
+ * outside the park and already cleared, and there is no scenery to age or fountain to start.
+ */
+static bool map_update_tiles_is_tile_idle(sint32 x, sint32 y)
+{
+    rct_tile_element * tileElement = map_get_first_element_at(x, y);
+    if (tileElement == nullptr)
+        return true;
+
+    do {
+        switch (tile_element_get_type(tileElement)) {
+        case TILE_ELEMENT_TYPE_SURFACE:
+            if (tileElement->properties.surface.ownership & OWNERSHIP_OWNED)
+                return false;
+            if ((tileElement->properties.surface.grass_length & 7) != GRASS_LENGTH_CLEAR_0)
+                return false;
+            break;
+        case TILE_ELEMENT_TYPE_SMALL_SCENERY:
+            return false;
+        case TILE_ELEMENT_TYPE_PATH:
+            if (footpath_element_has_path_scenery(tileElement))
+                return false;
+            break;
+        }
+    } while (!tile_element_is_last_for_tile(tileElement++));
+    return true;
+}
+
+static void map_update_tiles_rebuild_schedule()
+{
+    sint32 numBits = map_update_tiles_get_num_bits();
+    _tileUpdateSchedule.assign(std::max<size_t>(1, ((size_t)1 << (numBits * 2)) / 32), 0);
+    _tileUpdateScheduleBits = numBits;
+    _tileUpdateScheduleMapSize = gMapSize;
+    _tileUpdateScheduleValid = true;
+
+    for (sint32 y = 0; y < gMapSize; y++) {
+        for (sint32 x = 0; x < gMapSize; x++) {
+            if (!map_update_tiles_is_tile_idle(x, y)) {
+                uint32 position = map_update_tiles_get_position(x, y, numBits);
+                _tileUpdateSchedule[position >> 5] |= 1u << (position & 31);
+            }
+        }
+    }
+}
+
+/**
+ * Drops the schedule so it is rebuilt from the tiles on the next update. Used whenever the map is
+ * replaced or changed in bulk.
+ */
+static void map_update_tiles_reset_schedule()
+{
+    _tileUpdateScheduleValid = false;
+}
+
+void map_update_tiles_wake(sint32 x, sint32 y)
+{
+    if (!_tileUpdateScheduleValid)
+        return;
+    if (x < 0 || y < 0 || x >= _tileUpdateScheduleMapSize || y >= _tileUpdateScheduleMapSize)
+        return;
+
+    uint32 position = map_update_tiles_get_position(x, y, _tileUpdateScheduleBits);
+    _tileUpdateSchedule[position >> 5] |= 1u << (position & 31);
+}
+
+/**
+ * Returns the first scheduled position in [from, to), or to if there is none. The schedule is read
+ * as it is walked, so tiles woken by an earlier tile of the same tick still get their turn.
+ */
+static uint32 map_update_tiles_find_scheduled(uint32 from, uint32 to)
+{
+    while (from < to) {
+        uint32 word = _tileUpdateSchedule[from >> 5] >> (from & 31);
+        if (word != 0) {
+            uint32 position = from + bitscanforward((sint32)word);
+            return std::min(position, to);
+        }
+        from = (from | 31) + 1;
+    }
+    return to;
+}
+
+static void map_update_tile(uint32 position)
+{
+    sint32 x = 0;
+    sint32 y = 0;
+    uint32 interleaved_xy = position;
+    for (sint32 i = 0; i < _tileUpdateScheduleBits; i++) {
+        x = (x << 1) | (interleaved_xy & 1);
+        interleaved_xy >>= 1;
+        y = (y << 1) | (interleaved_xy & 1);
+        interleaved_xy >>= 1;
+    }
+
+    rct_tile_element *tileElement = map_get_surface_element_at(x, y);
+    if (tileElement != nullptr) {
+        map_update_grass_length(x * 32, y * 32, tileElement);
+        scenery_update_tile(x * 32, y * 32);
+    }
+
+    if (map_update_tiles_is_tile_idle(x, y)) {
+        _tileUpdateSchedule[position >> 5] &= ~(1u << (position & 31));
+    }
+}
+
 /**
  * Updates grass length, scenery age and jumping fountains.
  *
@@ -3392,31 +3533,41 @@ sint32 map_can_construct_at(sint32 x, sint32 y, sint32 zLow, sint32 zHigh, uint8
 void map_update_tiles()
 {
     sint32 ignoreScreenFlags = SCREEN_FLAGS_SCENARIO_EDITOR | SCREEN_FLAGS_TRACK_DESIGNER | SCREEN_FLAGS_TRACK_MANAGER;
-    if (gScreenFlags & ignoreScreenFlags)
+    if (gScreenFlags & ignoreScreenFlags) {
+        // The editors change the map freely, so start from the tiles again once they are left
+        map_update_tiles_reset_schedule();
         return;
+    }
 
-    // Update 43 more tiles
-    for (sint32 j = 0; j < 43; j++) {
-        sint32 x = 0;
-        sint32 y = 0;
-
-        uint16 interleaved_xy = gGrassSceneryTileLoopPosition;
-        for (sint32 i = 0; i < 8; i++) {
-            x = (x << 1) | (interleaved_xy & 1);
-            interleaved_xy >>= 1;
-            y = (y << 1) | (interleaved_xy & 1);
-            interleaved_xy >>= 1;
-        }
+    if (!_tileUpdateScheduleValid ||
+        _tileUpdateScheduleMapSize != gMapSize ||
+        _tileUpdateScheduleBits != map_update_tiles_get_num_bits()) {
+        map_update_tiles_rebuild_schedule();
+    }
 
-        rct_tile_element *tileElement = map_get_surface_element_at(x, y);
-        if (tileElement != nullptr) {
-            map_update_grass_length(x * 32, y * 32, tileElement);
-            scenery_update_tile(x * 32, y * 32);
-        }
+    sint32 numBits = _tileUpdateScheduleBits;
+    uint32 numPositionsTotal = 1u << (numBits * 2);
 
-        gGrassSceneryTileLoopPosition++;
-        gGrassSceneryTileLoopPosition &= 0xFFFF;
+    // RCT2 steps through 43 positions per tick. Scale that with the area being walked so every
+    // tile still gets its turn at the same rate on bigger maps.
+    uint32 numPositions = 43u << ((numBits - 8) * 2);
+
+    uint32 position = gGrassSceneryTileLoopPosition & (numPositionsTotal - 1);
+    uint32 end = position + numPositions;
+
+    // Walk the scheduled positions in loop order, wrapping around at the end of the area
+    uint32 first = position;
+    uint32 last = std::min(end, numPositionsTotal);
+    for (uint32 p = map_update_tiles_find_scheduled(first, last); p < last; p = map_update_tiles_find_scheduled(p + 1, last)) {
+        map_update_tile(p);
     }
+    if (end > numPositionsTotal) {
+        last = end - numPositionsTotal;
+        for (uint32 p = map_update_tiles_find_scheduled(0, last); p < last; p = map_update_tiles_find_scheduled(p + 1, last)) {
+            map_update_tile(p);
+        }
+    }
+    gGrassSceneryTileLoopPosition = end & (numPositionsTotal - 1);
 }
 
 /**
@@ -4084,12 +4235,7 @@ static void map_invalidate_tile_under_zoom(sint32 x, sint32 y, sint32 z0, sint32
     x2 = x + 32;
     y2 = y + 32 - z0;
 
-    for (sint32 i = 0; i < MAX_VIEWPORT_COUNT; i++) {
-        rct_viewport *viewport = &g_viewport_list[i];
-        if (viewport->width != 0 && (maxZoom == -1 || viewport->zoom <= maxZoom)) {
-            viewport_invalidate(viewport, x1, y1, x2, y2);
-        }
-    }
+    viewports_invalidate(x1, y1, x2, y2, maxZoom);
 }
 
 /**
@@ -4150,14 +4296,7 @@ void map_invalidate_region(const LocationXY16& mins, const LocationXY16& maxs)
     bottom += 32;
     top -= 32 + 2080;
 
-    for (sint32 i = 0; i < MAX_VIEWPORT_COUNT; i++)
-    {
-        rct_viewport *viewport = &g_viewport_list[i];
-        if (viewport->width != 0)
-        {
-            viewport_invalidate(viewport, left, top, right, bottom);
-        }
-    }
+    viewports_invalidate(left, top, right, bottom);
 }
 
 sint32 map_get_tile_side(sint32 mapX, sint32 mapY)
@@ -518,6 +518,7 @@ void tile_element_iterator_restart_for_tile(tile_element_iterator *it);
 
 void wall_remove_intersecting_walls(sint32 x, sint32 y, sint32 z0, sint32 z1, sint32 direction);
 void map_update_tiles();
+void map_update_tiles_wake(sint32 x, sint32 y);
 sint32 map_get_highest_z(sint32 tileX, sint32 tileY);
 
 sint32 tile_element_get_banner_index(rct_tile_element *tileElement);
@@ -14,7 +14,11 @@
  *****************************************************************************/
 #pragma endregion
 
+#include <unordered_set>
+#include <vector>
+#include "../core/Math.hpp"
 #include "../Game.h"
+#include "../OpenRCT2.h"
 #include "../ride/Ride.h"
 #include "../ride/RideData.h"
 #include "../ride/Track.h"
@@ -28,10 +32,21 @@
 
 using map_animation_invalidate_event_handler = bool (*)(sint32 x, sint32 y, sint32 baseZ);
 
-static bool map_animation_invalidate(rct_map_animation *obj);
+static bool map_animation_invalidate(const rct_map_animation &aobj);
+static bool map_animation_can_be_culled(sint32 type);
+static void map_animation_remove_at(sint32 type, size_t index);
+static bool map_animation_get_visible_area(sint32 * left, sint32 * top, sint32 * right, sint32 * bottom);
+static bool map_animation_is_in_area(const rct_map_animation &aobj, sint32 rotation, sint32 left, sint32 top, sint32 right, sint32 bottom);
+static void map_animation_purge_culled();
 
-uint16 gNumMapAnimations;
-rct_map_animation gAnimatedObjects[MAX_ANIMATED_OBJECTS];
+// Animations of the same type are kept together so each handler runs over one dense batch
+static std::vector<rct_map_animation> _mapAnimations[MAP_ANIMATION_TYPE_COUNT];
+static std::unordered_set<uint64> _mapAnimationKeys;
+
+static uint64 map_animation_get_key(sint32 type, sint32 x, sint32 y, sint32 z)
+{
+    return ((uint64)(uint8)type << 40) | ((uint64)(uint8)z << 32) | ((uint64)(uint16)x << 16) | (uint16)y;
+}
 
 /**
  *
@@ -44,31 +59,35 @@ rct_map_animation gAnimatedObjects[MAX_ANIMATED_OBJECTS];
  */
 void map_animation_create(sint32 type, sint32 x, sint32 y, sint32 z)
 {
-    rct_map_animation *aobj = &gAnimatedObjects[0];
-    sint32 numAnimatedObjects = gNumMapAnimations;
-    if (numAnimatedObjects >= MAX_ANIMATED_OBJECTS) {
-        log_error("Exceeded the maximum number of animations");
+    if (type < 0 || type >= MAP_ANIMATION_TYPE_COUNT) {
+        log_error("Invalid animation type %d", type);
         return;
     }
-    for (sint32 i = 0; i < numAnimatedObjects; i++, aobj++) {
-        if (aobj->x != x)
-            continue;
-        if (aobj->y != y)
-            continue;
-        if (aobj->baseZ != z)
-            continue;
-        if (aobj->type != type)
-            continue;
+
+    uint64 key = map_animation_get_key(type, x, y, z);
+    if (_mapAnimationKeys.find(key) != _mapAnimationKeys.end()) {
         // Animation already exists
         return;
     }
 
+    if (_mapAnimationKeys.size() >= MAX_ANIMATED_OBJECTS) {
+        // Animations outside of the viewports may not have been checked for removal yet, do that now
+        // so the limit only depends on the state of the map.
+        map_animation_purge_culled();
+        if (_mapAnimationKeys.size() >= MAX_ANIMATED_OBJECTS) {
+            log_error("Exceeded the maximum number of animations");
+            return;
+        }
+    }
+
     // Create new animation
-    gNumMapAnimations++;
-    aobj->type = type;
-    aobj->x = x;
-    aobj->y = y;
-    aobj->baseZ = z;
+    rct_map_animation aobj;
+    aobj.type = type;
+    aobj.x = x;
+    aobj.y = y;
+    aobj.baseZ = z;
+    _mapAnimations[type].push_back(aobj);
+    _mapAnimationKeys.insert(key);
 }
 
 /**
@@ -77,20 +96,120 @@ void map_animation_create(sint32 type, sint32 x, sint32 y, sint32 z)
  */
 void map_animation_invalidate_all()
 {
-    rct_map_animation *aobj = &gAnimatedObjects[0];
-    sint32 numAnimatedObjects = gNumMapAnimations;
-    while (numAnimatedObjects > 0) {
-        if (map_animation_invalidate(aobj)) {
-            // Remove animated object
-            gNumMapAnimations--;
-            numAnimatedObjects--;
-            if (numAnimatedObjects > 0)
-                memmove(aobj, aobj + 1, numAnimatedObjects * sizeof(rct_map_animation));
+    sint32 left, top, right, bottom;
+    bool anyVisible = map_animation_get_visible_area(&left, &top, &right, &bottom);
+    sint32 rotation = get_current_rotation();
+
+    for (sint32 type = 0; type < MAP_ANIMATION_TYPE_COUNT; type++) {
+        bool canBeCulled = map_animation_can_be_culled(type);
+
+        std::vector<rct_map_animation> &animations = _mapAnimations[type];
+        size_t i = 0;
+        while (i < animations.size()) {
+            rct_map_animation aobj = animations[i];
+            if (canBeCulled && (!anyVisible || !map_animation_is_in_area(aobj, rotation, left, top, right, bottom))) {
+                i++;
+                continue;
+            }
+
+            if (map_animation_invalidate(aobj)) {
+                map_animation_remove_at(type, i);
+            } else {
+                i++;
+            }
+        }
+    }
+}
+
+void map_animation_clear_all()
+{
+    for (auto &animations : _mapAnimations) {
+        animations.clear();
+    }
+    _mapAnimationKeys.clear();
+}
+
+uint16 map_animation_get_count()
+{
+    return (uint16)_mapAnimationKeys.size();
+}
+
+/**
+ * Copies the animations to dst, grouped by type.
+ * @returns the number of animations written.
+ */
+size_t map_animation_export(rct_map_animation * dst, size_t capacity)
+{
+    size_t count = 0;
+    for (const auto &animations : _mapAnimations) {
+        for (const auto &aobj : animations) {
+            if (count >= capacity) {
+                return count;
+            }
+            dst[count++] = aobj;
+        }
+    }
+    return count;
+}
+
+/**
+ * Swaps the last animation of the same type into the given slot.
+ */
+static void map_animation_remove_at(sint32 type, size_t index)
+{
+    std::vector<rct_map_animation> &animations = _mapAnimations[type];
+    const rct_map_animation &aobj = animations[index];
+    _mapAnimationKeys.erase(map_animation_get_key(aobj.type, aobj.x, aobj.y, aobj.baseZ));
+
+    animations[index] = animations.back();
+    animations.pop_back();
+}
+
+/**
+ * Gets the bounding box in screen space of all the viewports that animations are drawn in.
+ * @returns false if there are none.
+ */
+static bool map_animation_get_visible_area(sint32 * left, sint32 * top, sint32 * right, sint32 * bottom)
+{
+    if (gOpenRCT2Headless) {
+        return false;
+    }
+
+    bool anyVisible = false;
+    for (sint32 i = 0; i < MAX_VIEWPORT_COUNT; i++) {
+        const rct_viewport *viewport = &g_viewport_list[i];
+        // All handlers invalidate with map_invalidate_tile_zoom1
+        if (viewport->width == 0 || viewport->zoom > 1) {
+            continue;
+        }
+
+        sint32 viewRight = viewport->view_x + viewport->view_width;
+        sint32 viewBottom = viewport->view_y + viewport->view_height;
+        if (!anyVisible) {
+            *left = viewport->view_x;
+            *top = viewport->view_y;
+            *right = viewRight;
+            *bottom = viewBottom;
+            anyVisible = true;
         } else {
-            numAnimatedObjects--;
-            aobj++;
+            *left = Math::Min<sint32>(*left, viewport->view_x);
+            *top = Math::Min<sint32>(*top, viewport->view_y);
+            *right = Math::Max(*right, viewRight);
+            *bottom = Math::Max(*bottom, viewBottom);
         }
     }
+    return anyVisible;
+}
+
+static bool map_animation_is_in_area(const rct_map_animation &aobj, sint32 rotation, sint32 left, sint32 top, sint32 right, sint32 bottom)
+{
+    LocationXYZ16 position = { (sint16)(aobj.x + 16), (sint16)(aobj.y + 16), 0 };
+    LocationXY16 screen = coordinate_3d_to_2d(&position, rotation);
+
+    // The largest area a handler invalidates is 64 units above the element
+    sint32 z = aobj.baseZ * 8;
+    return screen.x + 32 > left && screen.x - 32 < right &&
+           screen.y + 32 - z > top && screen.y - 32 - (z + 64) < bottom;
 }
 
 /**
@@ -545,12 +664,63 @@ static constexpr const map_animation_invalidate_event_handler _animatedObjectEve
     map_animation_invalidate_wall
 };
 
+/**
+ * Whether the handler only invalidates the screen, so it can be skipped while the animation is
+ * not inside any viewport. Small scenery (clocks), on-ride photos and doors also update peeps or
+ * tile elements, so they have to run every tick for the game to stay in sync.
+ */
+static constexpr const bool _animationCanBeCulled[MAP_ANIMATION_TYPE_COUNT] = {
+    true,   // MAP_ANIMATION_TYPE_RIDE_ENTRANCE
+    true,   // MAP_ANIMATION_TYPE_QUEUE_BANNER
+    false,  // MAP_ANIMATION_TYPE_SMALL_SCENERY
+    true,   // MAP_ANIMATION_TYPE_PARK_ENTRANCE
+    true,   // MAP_ANIMATION_TYPE_TRACK_WATERFALL
+    true,   // MAP_ANIMATION_TYPE_TRACK_RAPIDS
+    false,  // MAP_ANIMATION_TYPE_TRACK_ONRIDEPHOTO
+    true,   // MAP_ANIMATION_TYPE_TRACK_WHIRLPOOL
+    true,   // MAP_ANIMATION_TYPE_TRACK_SPINNINGTUNNEL
+    false,  // MAP_ANIMATION_TYPE_REMOVE
+    true,   // MAP_ANIMATION_TYPE_BANNER
+    true,   // MAP_ANIMATION_TYPE_LARGE_SCENERY
+    false,  // MAP_ANIMATION_TYPE_WALL_DOOR
+    true,   // MAP_ANIMATION_TYPE_WALL
+};
+
 /**
  * @returns true if the animation should be removed.
  */
-static bool map_animation_invalidate(rct_map_animation *obj)
+static bool map_animation_invalidate(const rct_map_animation &aobj)
+{
+    assert(aobj.type < MAP_ANIMATION_TYPE_COUNT);
+
+    return _animatedObjectEventHandlers[aobj.type](aobj.x, aobj.y, aobj.baseZ);
+}
+
+static bool map_animation_can_be_culled(sint32 type)
+{
+    return _animationCanBeCulled[type];
+}
+
+/**
+ * Runs the handlers of the animations that may have been skipped for not being visible,
+ * removing the ones that no longer exist.
+ */
+static void map_animation_purge_culled()
 {
-    assert(obj->type < MAP_ANIMATION_TYPE_COUNT);
-    
-    return _animatedObjectEventHandlers[obj->type](obj->x, obj->y, obj->baseZ);
+    for (sint32 type = 0; type < MAP_ANIMATION_TYPE_COUNT; type++) {
+        if (!map_animation_can_be_culled(type)) {
+            continue;
+        }
+
+        std::vector<rct_map_animation> &animations = _mapAnimations[type];
+        size_t i = 0;
+        while (i < animations.size()) {
+            rct_map_animation aobj = animations[i];
+            if (map_animation_invalidate(aobj)) {
+                map_animation_remove_at(type, i);
+            } else {
+                i++;
+            }
+        }
+    }
 }
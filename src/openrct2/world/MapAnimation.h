@@ -53,10 +53,10 @@ enum {
 
 #define MAX_ANIMATED_OBJECTS 2000
 
-extern uint16 gNumMapAnimations;
-extern rct_map_animation gAnimatedObjects[MAX_ANIMATED_OBJECTS];
-
 void map_animation_create(sint32 type, sint32 x, sint32 y, sint32 z);
 void map_animation_invalidate_all();
+void map_animation_clear_all();
+uint16 map_animation_get_count();
+size_t map_animation_export(rct_map_animation * dst, size_t capacity);
 
 #endif
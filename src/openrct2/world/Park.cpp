@@ -764,6 +764,9 @@ void update_park_fences(sint32 x, sint32 y)
 
 void update_park_fences_around_tile(sint32 x, sint32 y)
 {
+    // The ownership of the tile changed, so its grass may need updating again
+    map_update_tiles_wake(x >> 5, y >> 5);
+
     update_park_fences(x, y);
     update_park_fences(x + 32, y);
     update_park_fences(x - 32, y);
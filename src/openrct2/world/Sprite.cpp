@@ -14,7 +14,9 @@
  *****************************************************************************/
 #pragma endregion
 
+#include <algorithm>
 #include <cmath>
+#include <iterator>
 #include "../audio/audio.h"
 #include "../Cheats.h"
 #include "../core/Guard.hpp"
@@ -84,18 +86,13 @@ static void invalidate_sprite_max_zoom(rct_sprite *sprite, sint32 maxZoom)
 {
     if (sprite->unknown.sprite_left == LOCATION_NULL) return;
 
-    for (sint32 i = 0; i < MAX_VIEWPORT_COUNT; i++) {
-        rct_viewport *viewport = &g_viewport_list[i];
-        if (viewport->width != 0 && viewport->zoom <= maxZoom) {
-            viewport_invalidate(
-                viewport,
-                sprite->unknown.sprite_left,
-                sprite->unknown.sprite_top,
-                sprite->unknown.sprite_right,
-                sprite->unknown.sprite_bottom
-            );
-        }
-    }
+    viewports_invalidate(
+        sprite->unknown.sprite_left,
+        sprite->unknown.sprite_top,
+        sprite->unknown.sprite_right,
+        sprite->unknown.sprite_bottom,
+        maxZoom
+    );
 }
 
 /**
@@ -761,13 +758,13 @@ static void store_sprite_locations(LocationXYZ16 * sprite_locations)
     }
 }
 
-void sprite_position_tween_store_a()
-{
-    store_sprite_locations(_spritelocations1);
-}
-
-void sprite_position_tween_store_b()
+/**
+ * Keeps the positions after the previous tick as the ones to tween from and stores the current
+ * positions as the ones to tween to. Called after every tick while tweening.
+ */
+void sprite_position_tween_advance()
 {
+    std::copy(std::begin(_spritelocations2), std::end(_spritelocations2), _spritelocations1);
     store_sprite_locations(_spritelocations2);
 }
 
@@ -780,6 +777,12 @@ void sprite_position_tween_all(float alpha)
         if (sprite_should_tween(sprite)) {
             LocationXYZ16 posA = _spritelocations1[i];
             LocationXYZ16 posB = _spritelocations2[i];
+            if (sprite->unknown.x != posB.x || sprite->unknown.y != posB.y || sprite->unknown.z != posB.z) {
+                // Moved since the last tick, e.g. by a command while paused, so stop tweening it and keep
+                // the restore from putting it back
+                _spritelocations1[i] = _spritelocations2[i] = { sprite->unknown.x, sprite->unknown.y, sprite->unknown.z };
+                continue;
+            }
             if (posA.x == posB.x && posA.y == posB.y && posA.z == posB.z) {
                 continue;
             }
@@ -405,8 +405,7 @@ void litter_remove_at(sint32 x, sint32 y, sint32 z);
 void sprite_misc_explosion_cloud_create(sint32 x, sint32 y, sint32 z);
 void sprite_misc_explosion_flare_create(sint32 x, sint32 y, sint32 z);
 uint16 sprite_get_first_in_quadrant(sint32 x, sint32 y);
-void sprite_position_tween_store_a();
-void sprite_position_tween_store_b();
+void sprite_position_tween_advance();
 void sprite_position_tween_all(float nudge);
 void sprite_position_tween_restore();
 void sprite_position_tween_reset();
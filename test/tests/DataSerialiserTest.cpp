@@ -0,0 +1,111 @@
+#include <limits>
+#include <gtest/gtest.h>
+#include <openrct2/core/DataSerialiser.h>
+
+template<typename T>
+static size_t GetEncodedLength(T value)
+{
+    MemoryStream ms;
+    DataSerializerTraits<T>::encode(&ms, value);
+    return (size_t)ms.GetLength();
+}
+
+template<typename T>
+static void TestRoundTrip(const std::vector<T> &values)
+{
+    DataSerialiser saver(true);
+    for (auto value : values)
+    {
+        saver << value;
+    }
+
+    MemoryStream &ms = saver.GetStream();
+    ms.SetPosition(0);
+    DataSerialiser loader(false, ms);
+    for (auto expected : values)
+    {
+        T value = 0;
+        loader << value;
+        ASSERT_EQ(value, expected);
+    }
+    ASSERT_EQ(ms.GetPosition(), ms.GetLength());
+}
+
+TEST(DataSerialiserTest, varint_uint16_round_trip)
+{
+    TestRoundTrip<uint16>({ 0, 1, 127, 128, 255, 16383, 16384, 0x7FFF, 0xFFFF });
+}
+
+TEST(DataSerialiserTest, varint_sint16_round_trip)
+{
+    TestRoundTrip<sint16>({ 0, 1, -1, 63, -64, 64, -65, 8191, -8192, std::numeric_limits<sint16>::min(),
+                            std::numeric_limits<sint16>::max() });
+}
+
+TEST(DataSerialiserTest, varint_uint32_round_trip)
+{
+    TestRoundTrip<uint32>({ 0, 1, 127, 128, 0x3FFF, 0x4000, 0x1FFFFF, 0x200000, 0xFFFFFFF, 0x10000000, 0xFFFFFFFF });
+}
+
+TEST(DataSerialiserTest, varint_sint32_round_trip)
+{
+    TestRoundTrip<sint32>({ 0, 1, -1, 63, -64, 64, -65, 1000000, -1000000, std::numeric_limits<sint32>::min(),
+                            std::numeric_limits<sint32>::max() });
+}
+
+TEST(DataSerialiserTest, varint_lengths)
+{
+    ASSERT_EQ(GetEncodedLength<uint16>(0), 1u);
+    ASSERT_EQ(GetEncodedLength<uint16>(127), 1u);
+    ASSERT_EQ(GetEncodedLength<uint16>(128), 2u);
+    ASSERT_EQ(GetEncodedLength<uint16>(0xFFFF), 3u);
+
+    // Small negative numbers are zigzagged so they stay short
+    ASSERT_EQ(GetEncodedLength<sint16>(-1), 1u);
+    ASSERT_EQ(GetEncodedLength<sint16>(-64), 1u);
+    ASSERT_EQ(GetEncodedLength<sint16>(-65), 2u);
+
+    ASSERT_EQ(GetEncodedLength<uint32>(0x0FFFFFFF), 4u);
+    ASSERT_EQ(GetEncodedLength<uint32>(0xFFFFFFFF), 5u);
+    ASSERT_EQ(GetEncodedLength<sint32>(-1), 1u);
+    ASSERT_EQ(GetEncodedLength<sint32>(std::numeric_limits<sint32>::min()), 5u);
+}
+
+TEST(DataSerialiserTest, varint_mixed_with_fixed_width)
+{
+    uint8 a = 0xAB;
+    uint32 b = 300;
+    std::string c = "test";
+    sint16 d = -2;
+    DataSerialiser saver(true);
+    saver << a << b << c << d;
+
+    MemoryStream &ms = saver.GetStream();
+    ms.SetPosition(0);
+    uint8 a2 = 0;
+    uint32 b2 = 0;
+    std::string c2;
+    sint16 d2 = 0;
+    DataSerialiser loader(false, ms);
+    loader << a2 << b2 << c2 << d2;
+    ASSERT_EQ(a2, a);
+    ASSERT_EQ(b2, b);
+    ASSERT_EQ(c2, c);
+    ASSERT_EQ(d2, d);
+}
+
+TEST(DataSerialiserTest, varint_too_long_throws)
+{
+    const uint8 data[] = { 0x80, 0x80, 0x80, 0x80, 0x80, 0x01 };
+    MemoryStream ms(data, sizeof(data));
+    uint32 value;
+    ASSERT_THROW(DataSerializerTraits<uint32>::decode(&ms, value), IOException);
+}
+
+TEST(DataSerialiserTest, varint_truncated_throws)
+{
+    const uint8 data[] = { 0xFF, 0xFF };
+    MemoryStream ms(data, sizeof(data));
+    uint32 value;
+    ASSERT_THROW(DataSerializerTraits<uint32>::decode(&ms, value), IOException);
+}
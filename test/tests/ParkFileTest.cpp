@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include <openrct2/core/MemoryStream.h>
+#include <openrct2/ParkFile.h>
+
+class ParkFileTest : public testing::Test
+{
+protected:
+    std::vector<uint8> _repeating;
+    std::vector<uint8> _random;
+
+    void SetUp() override
+    {
+        _repeating.resize(64 * 1024);
+        for (size_t i = 0; i < _repeating.size(); i++)
+        {
+            _repeating[i] = (uint8)(i % 7);
+        }
+
+        // Does not compress, so it is stored as it is
+        _random.resize(4096);
+        uint32 seed = 0x12345678;
+        for (auto &b : _random)
+        {
+            seed = seed * 1103515245 + 12345;
+            b = (uint8)(seed >> 24);
+        }
+    }
+
+    void WritePark(MemoryStream * ms, PARK_FILE_COMPRESSION compression)
+    {
+        ParkFileWriter writer;
+        writer.AddSection(PARK_FILE_SECTION_HEADER, _random.data(), _random.size());
+        writer.AddSection(PARK_FILE_SECTION_TILE_ELEMENTS, _repeating.data(), _repeating.size());
+        writer.AddSection(PARK_FILE_SECTION_DATE, nullptr, 0);
+        writer.Write(ms, compression);
+    }
+
+    void TestRoundTrip(PARK_FILE_COMPRESSION compression)
+    {
+        MemoryStream ms;
+        WritePark(&ms, compression);
+
+        ms.SetPosition(0);
+        ASSERT_TRUE(ParkFile::IsParkFile(&ms));
+        ASSERT_EQ(ms.GetPosition(), 0u);
+
+        // Sections are read back in a different order to the one they were written in
+        ParkFileReader reader(&ms);
+        ASSERT_EQ(reader.GetLength(), ms.GetLength());
+        ASSERT_TRUE(reader.HasSection(PARK_FILE_SECTION_DATE));
+        ASSERT_FALSE(reader.HasSection(PARK_FILE_SECTION_PARK));
+        ASSERT_EQ(reader.ReadSection(PARK_FILE_SECTION_DATE).size(), 0u);
+        ASSERT_EQ(reader.ReadSection(PARK_FILE_SECTION_TILE_ELEMENTS), _repeating);
+        ASSERT_EQ(reader.ReadSection(PARK_FILE_SECTION_HEADER), _random);
+    }
+};
+
+TEST_F(ParkFileTest, round_trip_none)
+{
+    TestRoundTrip(PARK_FILE_COMPRESSION::NONE);
+}
+
+TEST_F(ParkFileTest, round_trip_fast)
+{
+    TestRoundTrip(PARK_FILE_COMPRESSION::FAST);
+}
+
+TEST_F(ParkFileTest, round_trip_small)
+{
+    TestRoundTrip(PARK_FILE_COMPRESSION::SMALL);
+}
+
+TEST_F(ParkFileTest, compression_reduces_size)
+{
+    MemoryStream uncompressed;
+    WritePark(&uncompressed, PARK_FILE_COMPRESSION::NONE);
+    MemoryStream compressed;
+    WritePark(&compressed, PARK_FILE_COMPRESSION::FAST);
+    ASSERT_LT(compressed.GetLength(), uncompressed.GetLength());
+}
+
+TEST_F(ParkFileTest, read_section_into_buffer)
+{
+    MemoryStream ms;
+    WritePark(&ms, PARK_FILE_COMPRESSION::FAST);
+    ms.SetPosition(0);
+    ParkFileReader reader(&ms);
+
+    // A larger buffer is padded with zero
+    std::vector<uint8> larger(_repeating.size() + 16, 0xFF);
+    ASSERT_EQ(reader.ReadSection(PARK_FILE_SECTION_TILE_ELEMENTS, larger.data(), larger.size()), _repeating.size());
+    ASSERT_TRUE(std::equal(_repeating.begin(), _repeating.end(), larger.begin()));
+    for (size_t i = _repeating.size(); i < larger.size(); i++)
+    {
+        ASSERT_EQ(larger[i], 0);
+    }
+
+    // A smaller buffer only gets the start of the section
+    std::vector<uint8> smaller(100);
+    ASSERT_EQ(reader.ReadSection(PARK_FILE_SECTION_TILE_ELEMENTS, smaller.data(), smaller.size()), _repeating.size());
+    ASSERT_TRUE(std::equal(smaller.begin(), smaller.end(), _repeating.begin()));
+}
+
+TEST_F(ParkFileTest, read_at_stream_offset)
+{
+    MemoryStream ms;
+    ms.WriteValue<uint32>(0xDEADBEEF);
+    WritePark(&ms, PARK_FILE_COMPRESSION::SMALL);
+    uint64 parkLength = ms.GetLength() - sizeof(uint32);
+
+    ms.SetPosition(sizeof(uint32));
+    ParkFileReader reader(&ms);
+    ASSERT_EQ(reader.GetLength(), parkLength);
+    ASSERT_EQ(reader.ReadSection(PARK_FILE_SECTION_HEADER), _random);
+}
+
+TEST_F(ParkFileTest, missing_section_throws)
+{
+    MemoryStream ms;
+    WritePark(&ms, PARK_FILE_COMPRESSION::FAST);
+    ms.SetPosition(0);
+    ParkFileReader reader(&ms);
+    ASSERT_THROW(reader.ReadSection(PARK_FILE_SECTION_PARK), IOException);
+}
+
+TEST_F(ParkFileTest, corrupt_section_throws)
+{
+    for (auto compression : { PARK_FILE_COMPRESSION::NONE, PARK_FILE_COMPRESSION::FAST })
+    {
+        MemoryStream ms;
+        WritePark(&ms, compression);
+
+        // Flip a byte near the end of the file, inside the tile elements section
+        auto data = (uint8 *)ms.GetData();
+        data[ms.GetLength() - 10] ^= 0xFF;
+
+        ms.SetPosition(0);
+        ParkFileReader reader(&ms);
+        ASSERT_EQ(reader.ReadSection(PARK_FILE_SECTION_HEADER), _random);
+        ASSERT_THROW(reader.ReadSection(PARK_FILE_SECTION_TILE_ELEMENTS), IOException);
+    }
+}
+
+TEST_F(ParkFileTest, truncated_file_throws)
+{
+    MemoryStream ms;
+    WritePark(&ms, PARK_FILE_COMPRESSION::FAST);
+    MemoryStream truncated(ms.GetData(), (size_t)ms.GetLength() - 1);
+    ASSERT_THROW(ParkFileReader reader(&truncated), IOException);
+}
+
+TEST_F(ParkFileTest, not_a_park_file)
+{
+    MemoryStream ms;
+    ms.Write(_random.data(), _random.size());
+    ms.SetPosition(0);
+    ASSERT_FALSE(ParkFile::IsParkFile(&ms));
+    ASSERT_THROW(ParkFileReader reader(&ms), IOException);
+
+    MemoryStream empty;
+    ASSERT_FALSE(ParkFile::IsParkFile(&empty));
+}
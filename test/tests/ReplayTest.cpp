@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include "openrct2/core/IStream.hpp"
+#include "openrct2/core/MemoryStream.h"
+#include "openrct2/Replay.h"
+
+class ReplayTest : public testing::Test
+{
+protected:
+    static ReplayRecording CreateRecording()
+    {
+        ReplayRecording recording;
+        recording.Park = { 0x50, 0x41, 0x52, 0x4B, 0x00, 0xFF };
+
+        const uint32 args[] = { 1, 2, 3, 4, 5, 6, 7 };
+        recording.AddGameCommand(100, args, 2, false);
+
+        ReplayCommand action;
+        action.Tick = 101;
+        action.PlayerId = 3;
+        action.IsAction = true;
+        action.InUpdate = true;
+        action.ActionType = 5;
+        action.ActionData = { 9, 8, 7 };
+        recording.Commands.push_back(action);
+
+        StateDigest digest;
+        digest.Tick = 400;
+        for (sint32 i = 0; i < STATE_DIGEST_COUNT; i++)
+        {
+            digest.Hashes[i] = 0x1000 + i;
+        }
+        recording.Digests.push_back(digest);
+        return recording;
+    }
+};
+
+TEST_F(ReplayTest, save_load_roundtrip)
+{
+    ReplayRecording recording = CreateRecording();
+    MemoryStream ms;
+    recording.Save(&ms);
+
+    ms.SetPosition(0);
+    ReplayRecording loaded;
+    loaded.Load(&ms);
+    ASSERT_EQ(ms.GetPosition(), ms.GetLength());
+
+    ASSERT_EQ(loaded.Park, recording.Park);
+    ASSERT_EQ(loaded.Commands.size(), 2u);
+
+    const ReplayCommand &command = loaded.Commands[0];
+    ASSERT_EQ(command.Tick, 100u);
+    ASSERT_EQ(command.PlayerId, 2);
+    ASSERT_FALSE(command.IsAction);
+    ASSERT_FALSE(command.InUpdate);
+    for (size_t i = 0; i < 7; i++)
+    {
+        ASSERT_EQ(command.Args[i], i + 1);
+    }
+
+    const ReplayCommand &action = loaded.Commands[1];
+    ASSERT_EQ(action.Tick, 101u);
+    ASSERT_EQ(action.PlayerId, 3);
+    ASSERT_TRUE(action.IsAction);
+    ASSERT_TRUE(action.InUpdate);
+    ASSERT_EQ(action.ActionType, 5u);
+    ASSERT_EQ(action.ActionData, recording.Commands[1].ActionData);
+
+    ASSERT_EQ(loaded.Digests.size(), 1u);
+    ASSERT_EQ(loaded.Digests[0].Tick, 400u);
+    ASSERT_EQ(loaded.Digests[0].FindMismatch(recording.Digests[0]), STATE_DIGEST_COUNT);
+}
+
+TEST_F(ReplayTest, load_replaces_previous_recording)
+{
+    ReplayRecording empty;
+    MemoryStream ms;
+    empty.Save(&ms);
+
+    ms.SetPosition(0);
+    ReplayRecording loaded = CreateRecording();
+    loaded.Load(&ms);
+    ASSERT_TRUE(loaded.Park.empty());
+    ASSERT_TRUE(loaded.Commands.empty());
+    ASSERT_TRUE(loaded.Digests.empty());
+}
+
+TEST_F(ReplayTest, load_rejects_other_files)
+{
+    const uint8 data[] = { 'N', 'O', 'P', 'E', 1, 0, 0, 0 };
+    MemoryStream ms(data, sizeof(data));
+    ReplayRecording loaded;
+    ASSERT_THROW(loaded.Load(&ms), IOException);
+}
+
+TEST_F(ReplayTest, load_rejects_truncated_park)
+{
+    ReplayRecording recording = CreateRecording();
+    MemoryStream ms;
+    recording.Save(&ms);
+
+    // Cut the file off inside the park data
+    MemoryStream truncated(ms.GetData(), 14);
+    ReplayRecording loaded;
+    ASSERT_THROW(loaded.Load(&truncated), IOException);
+}
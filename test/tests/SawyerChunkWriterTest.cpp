@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include <openrct2/core/MemoryStream.h>
+#include <openrct2/rct12/SawyerChunkReader.h>
+#include <openrct2/rct12/SawyerChunkWriter.h>
+
+class SawyerChunkWriterTest : public testing::Test
+{
+protected:
+    std::vector<std::vector<uint8>> _chunks;
+
+    void SetUp() override
+    {
+        // Chunks of runs, noise and a mix of both, so every encoding has something to do
+        uint32 seed = 0xC0FFEE;
+        for (size_t i = 0; i < 8; i++)
+        {
+            std::vector<uint8> chunk(1000 + i * 3000);
+            for (size_t j = 0; j < chunk.size(); j++)
+            {
+                seed = seed * 1103515245 + 12345;
+                bool isRun = (i % 2 == 0) || ((j / 64) % 2 == 0);
+                chunk[j] = isRun ? (uint8)(j / 200) : (uint8)(seed >> 24);
+            }
+            _chunks.push_back(chunk);
+        }
+    }
+
+    void WriteChunks(MemoryStream * ms, SAWYER_ENCODING encoding, bool parallel)
+    {
+        SawyerChunkWriter writer(ms, parallel);
+        for (const auto &chunk : _chunks)
+        {
+            writer.WriteChunk(chunk.data(), chunk.size(), encoding);
+        }
+        writer.Flush();
+    }
+
+    void TestRoundTrip(SAWYER_ENCODING encoding)
+    {
+        MemoryStream serial;
+        WriteChunks(&serial, encoding, false);
+        MemoryStream parallel;
+        WriteChunks(&parallel, encoding, true);
+
+        // Encoding in parallel must not change the output
+        ASSERT_EQ(parallel.GetLength(), serial.GetLength());
+        ASSERT_EQ(memcmp(parallel.GetData(), serial.GetData(), (size_t)serial.GetLength()), 0);
+
+        parallel.SetPosition(0);
+        SawyerChunkReader reader(&parallel);
+        for (const auto &expected : _chunks)
+        {
+            auto chunk = reader.ReadChunk();
+            ASSERT_EQ(chunk->GetEncoding(), encoding);
+            ASSERT_EQ(chunk->GetLength(), expected.size());
+            ASSERT_EQ(memcmp(chunk->GetData(), expected.data(), expected.size()), 0);
+        }
+        ASSERT_EQ(parallel.GetPosition(), parallel.GetLength());
+    }
+};
+
+TEST_F(SawyerChunkWriterTest, round_trip_none)
+{
+    TestRoundTrip(SAWYER_ENCODING::NONE);
+}
+
+TEST_F(SawyerChunkWriterTest, round_trip_rle)
+{
+    TestRoundTrip(SAWYER_ENCODING::RLE);
+}
+
+TEST_F(SawyerChunkWriterTest, round_trip_rlecompressed)
+{
+    TestRoundTrip(SAWYER_ENCODING::RLECOMPRESSED);
+}
+
+TEST_F(SawyerChunkWriterTest, round_trip_rotate)
+{
+    TestRoundTrip(SAWYER_ENCODING::ROTATE);
+}
+
+TEST_F(SawyerChunkWriterTest, parallel_writes_nothing_until_flush)
+{
+    MemoryStream ms;
+    SawyerChunkWriter writer(&ms, true);
+    writer.WriteChunk(_chunks[0].data(), _chunks[0].size(), SAWYER_ENCODING::RLECOMPRESSED);
+    ASSERT_EQ(ms.GetLength(), 0u);
+
+    // Data written to the stream after a flush follows the chunks
+    writer.Flush();
+    uint64 chunkLength = ms.GetLength();
+    ASSERT_GT(chunkLength, 0u);
+    ms.WriteValue<uint32>(0x12345678);
+
+    ms.SetPosition(0);
+    SawyerChunkReader reader(&ms);
+    auto chunk = reader.ReadChunk();
+    ASSERT_EQ(chunk->GetLength(), _chunks[0].size());
+    ASSERT_EQ(ms.GetPosition(), chunkLength);
+    ASSERT_EQ(ms.ReadValue<uint32>(), 0x12345678u);
+}
+
+TEST_F(SawyerChunkWriterTest, read_into_buffer)
+{
+    MemoryStream ms;
+    WriteChunks(&ms, SAWYER_ENCODING::RLE, true);
+
+    ms.SetPosition(0);
+    SawyerChunkReader reader(&ms);
+    std::vector<uint8> buffer(_chunks[0].size());
+    ASSERT_EQ(reader.ReadChunk(buffer.data(), buffer.size()), _chunks[0].size());
+    ASSERT_EQ(buffer, _chunks[0]);
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include "openrct2/StateDigest.h"
+
+static StateDigest CreateDigest(uint32 tick)
+{
+    StateDigest digest;
+    digest.Tick = tick;
+    for (sint32 i = 0; i < STATE_DIGEST_COUNT; i++)
+    {
+        digest.Hashes[i] = 0x1000 + i;
+    }
+    return digest;
+}
+
+TEST(StateDigestTest, find_mismatch_equal)
+{
+    StateDigest a = CreateDigest(10);
+    StateDigest b = CreateDigest(10);
+    ASSERT_EQ(a.FindMismatch(b), STATE_DIGEST_COUNT);
+}
+
+TEST(StateDigestTest, find_mismatch_ignores_tick)
+{
+    StateDigest a = CreateDigest(10);
+    StateDigest b = CreateDigest(20);
+    ASSERT_EQ(a.FindMismatch(b), STATE_DIGEST_COUNT);
+}
+
+TEST(StateDigestTest, find_mismatch_single)
+{
+    for (sint32 i = 0; i < STATE_DIGEST_COUNT; i++)
+    {
+        StateDigest a = CreateDigest(10);
+        StateDigest b = CreateDigest(10);
+        b.Hashes[i]++;
+        ASSERT_EQ(a.FindMismatch(b), i);
+        ASSERT_EQ(b.FindMismatch(a), i);
+    }
+}
+
+TEST(StateDigestTest, find_mismatch_returns_first)
+{
+    StateDigest a = CreateDigest(10);
+    StateDigest b = CreateDigest(10);
+    b.Hashes[STATE_DIGEST_TILE_ELEMENTS] = 0;
+    b.Hashes[STATE_DIGEST_SPRITES] = 0;
+    b.Hashes[STATE_DIGEST_FINANCES] = 0;
+    ASSERT_EQ(a.FindMismatch(b), STATE_DIGEST_SPRITES);
+}
+
+TEST(StateDigestTest, history_find)
+{
+    StateDigestHistory history(4);
+    history.Add(CreateDigest(8));
+    history.Add(CreateDigest(16));
+    history.Add(CreateDigest(24));
+    ASSERT_EQ(history.GetCount(), 3U);
+    ASSERT_NE(history.Find(16), nullptr);
+    ASSERT_EQ(history.Find(16)->Tick, 16U);
+    ASSERT_EQ(history.Find(12), nullptr);
+    ASSERT_EQ(history.Find(32), nullptr);
+}
+
+TEST(StateDigestTest, history_capacity)
+{
+    StateDigestHistory history(2);
+    history.Add(CreateDigest(1));
+    history.Add(CreateDigest(2));
+    history.Add(CreateDigest(3));
+    ASSERT_EQ(history.GetCount(), 2U);
+    ASSERT_EQ(history.Find(1), nullptr);
+    ASSERT_EQ(history[0].Tick, 2U);
+}
+
+TEST(StateDigestTest, history_restarts_when_tick_goes_back)
+{
+    StateDigestHistory history(4);
+    history.Add(CreateDigest(100));
+    history.Add(CreateDigest(200));
+    history.Add(CreateDigest(50));
+    ASSERT_EQ(history.GetCount(), 1U);
+    ASSERT_EQ(history[0].Tick, 50U);
+}
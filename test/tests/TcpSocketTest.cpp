@@ -0,0 +1,37 @@
+#include <gtest/gtest.h>
+#include "openrct2/network/TcpSocket.h"
+
+constexpr sint32 FAMILY_A = 10;
+constexpr sint32 FAMILY_B = 2;
+
+TEST(TcpSocketTest, interleave_empty)
+{
+    ASSERT_TRUE(InterleaveAddressFamilies({}).empty());
+}
+
+TEST(TcpSocketTest, interleave_single_family)
+{
+    std::vector<size_t> expected = { 0, 1, 2 };
+    ASSERT_EQ(InterleaveAddressFamilies({ FAMILY_A, FAMILY_A, FAMILY_A }), expected);
+}
+
+TEST(TcpSocketTest, interleave_alternates)
+{
+    std::vector<size_t> expected = { 0, 2, 1, 3 };
+    ASSERT_EQ(InterleaveAddressFamilies({ FAMILY_A, FAMILY_A, FAMILY_B, FAMILY_B }), expected);
+}
+
+TEST(TcpSocketTest, interleave_starts_with_first_family)
+{
+    std::vector<size_t> expected = { 0, 1, 3, 2 };
+    ASSERT_EQ(InterleaveAddressFamilies({ FAMILY_B, FAMILY_A, FAMILY_A, FAMILY_B }), expected);
+}
+
+TEST(TcpSocketTest, interleave_uneven)
+{
+    std::vector<size_t> expected = { 0, 1, 2, 3, 4 };
+    ASSERT_EQ(InterleaveAddressFamilies({ FAMILY_A, FAMILY_B, FAMILY_A, FAMILY_A, FAMILY_A }), expected);
+
+    expected = { 0, 1, 3, 2, 4 };
+    ASSERT_EQ(InterleaveAddressFamilies({ FAMILY_A, FAMILY_B, FAMILY_B, FAMILY_A, FAMILY_B }), expected);
+}
@@ -97,6 +97,18 @@ TEST_F(SawyerCodingTest, decode_chunk_rotate)
     test_decode(rotatedata, sizeof(rotatedata));
 }
 
+TEST_F(SawyerCodingTest, decoded_length_sv4)
+{
+    uint8 * encodedDataBuffer = new uint8[BUFFER_SIZE];
+    size_t  encodedDataSize   = sawyercoding_encode_sv4(randomdata, encodedDataBuffer, sizeof(randomdata));
+    ASSERT_EQ(sawyercoding_get_decoded_length_sv4(encodedDataBuffer, encodedDataSize), sizeof(randomdata));
+
+    // Truncated data must not report the full length
+    ASSERT_NE(sawyercoding_get_decoded_length_sv4(encodedDataBuffer, encodedDataSize - 8), sizeof(randomdata));
+    ASSERT_EQ(sawyercoding_get_decoded_length_sv4(encodedDataBuffer, 3), 0u);
+    delete[] encodedDataBuffer;
+}
+
 // 1024 bytes of random data
 // use `dd if=/dev/urandom bs=1024 count=1 | xxd -i` to get your own
 const uint8 SawyerCodingTest::randomdata[] = {